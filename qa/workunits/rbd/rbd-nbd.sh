@@ -180,6 +180,15 @@ _sudo dd if=${DATA} of=${DEV} bs=1M oflag=direct
 [ "`dd if=${DATA} bs=1M | md5sum`" = "`rbd -p ${POOL} --no-progress export ${IMAGE} - | md5sum`" ]
 unmap_device ${DEV} ${PID}
 
+# multiple connections test
+DEV=`_sudo rbd device --device-type nbd --options num-connections=4 map ${POOL}/${IMAGE}`
+get_pid ${POOL}
+[ "`dd if=${DATA} bs=1M | md5sum`" = "`_sudo dd if=${DEV} bs=1M | md5sum`" ]
+dd if=/dev/urandom of=${DATA} bs=1M count=${SIZE}
+_sudo dd if=${DATA} of=${DEV} bs=1M oflag=direct
+[ "`dd if=${DATA} bs=1M | md5sum`" = "`rbd -p ${POOL} --no-progress export ${IMAGE} - | md5sum`" ]
+unmap_device ${DEV} ${PID}
+
 # notrim test
 DEV=`_sudo rbd device --device-type nbd --options notrim map ${POOL}/${IMAGE}`
 get_pid ${POOL}
@@ -485,6 +485,11 @@ Client::~Client()
   if (upkeeper.joinable())
     upkeeper.join();
 
+  {
+    std::unique_lock l{client_lock};
+    stop_async_dirop_threads(l, -ENOTCONN);
+  }
+
   // It is necessary to hold client_lock, because any inode destruction
   // may call into ObjectCacher, which asserts that it's lock (which is
   // client_lock) is held.
@@ -1497,7 +1502,8 @@ void Client::update_dentry_lease(Dentry *dn, LeaseStat *dlease, utime_t from, Me
     }
   }
   dn->cap_shared_gen = dn->dir->parent_inode->shared_gen;
-  if (dlease->mask & CEPH_LEASE_PRIMARY_LINK)
+  dn->primary_link = dlease->mask & CEPH_LEASE_PRIMARY_LINK;
+  if (dn->primary_link)
     dn->mark_primary();
   dn->alternate_name = std::move(dlease->alternate_name);
 }
@@ -2226,6 +2232,14 @@ int Client::make_request(MetaRequest *request,
 {
   int r = 0;
 
+  // don't overtake namespace ops still queued in the same dir
+  if (!request->async) {
+    if (Inode *in = request->inode(); in && in->async_dirops)
+      wait_async_dirops(in);
+    if (Dentry *od = request->old_dentry(); od && od->dir->parent_inode->async_dirops)
+      wait_async_dirops(od->dir->parent_inode);
+  }
+
   // assign a unique tid
   ceph_tid_t tid = ++last_tid;
   request->set_tid(tid);
@@ -2372,6 +2386,140 @@ int Client::make_request(MetaRequest *request,
   return r;
 }
 
+/*
+ * client_async_dirops: once the MDS has issued us Fx and the op's dir cap
+ * on the parent, nobody else can change the dir under us and the op can
+ * be sent without the caller waiting for it.  Until then, ask for them so
+ * that later ops in the same dir can go async.
+ */
+bool Client::_want_async_dirop(Inode *dir, int need)
+{
+  if (!cct->_conf.get_val<bool>("client_async_dirops"))
+    return false;
+
+  need |= CEPH_CAP_FILE_EXCL;
+  // keep wanting the caps while dir ops keep coming; check_caps() drops
+  // the want once the queue has drained and this has expired
+  dir->async_dirops_idle_until = ceph::coarse_mono_clock::now() +
+    caps_release_delay;
+  if (dir->caps_issued_mask(need))
+    return true;
+  if ((dir->async_dirops_wanted & need) != need) {
+    ldout(cct, 10) << __func__ << " asking for " << ccap_string(need)
+		   << " on " << *dir << dendl;
+    dir->async_dirops_wanted |= need;
+    check_caps(dir, CHECK_CAPS_NODELAY);
+    cap_delay_requeue(dir);  // drops the want if no dir op follows
+  }
+  return false;
+}
+
+void Client::queue_async_dirop(MetaRequest *req, const UserPerm& perms, int caps)
+{
+  req->async = true;
+  // lets the MDS replay it on reconnect even though no reply was seen yet
+  req->head.flags |= CEPH_MDS_FLAG_ASYNC;
+  req->set_caller_perms(perms);
+  // hold the caps the op relies on until its first reply, so that a revoke
+  // is not acked while it is still queued or in flight
+  req->async_caps = CEPH_CAP_FILE_EXCL | caps;
+  get_cap_ref(req->inode(), req->async_caps);
+  req->inode()->async_dirops++;
+  async_dirops_pending++;
+  async_dirop_queue.push_back(req);
+
+  auto max = cct->_conf.get_val<uint64_t>("client_async_dirop_threads");
+  if (async_dirop_threads.size() < max &&
+      async_dirop_queue.size() > async_dirop_idle) {
+    async_dirop_threads.emplace_back([this] { async_dirop_entry(); });
+  }
+  async_dirop_cond.notify_all();
+}
+
+void Client::async_dirop_entry()
+{
+  std::unique_lock cl(client_lock);
+  while (true) {
+    async_dirop_idle++;
+    async_dirop_cond.wait(cl, [this] {
+      return async_dirop_stopping || !async_dirop_queue.empty();
+    });
+    async_dirop_idle--;
+    if (async_dirop_queue.empty())
+      break;
+
+    MetaRequest *req = async_dirop_queue.front();
+    async_dirop_queue.pop_front();
+    InodeRef dir(req->inode());
+    int op = req->get_op();
+    int caps = req->async_caps;
+    filepath path = req->get_filepath();
+
+    int r = make_request(req, req->perms);
+    put_cap_ref(dir.get(), caps);
+    ldout(cct, 8) << "async " << ceph_mds_op_name(op) << "(" << path
+		  << ") = " << r << dendl;
+    if (r < 0) {
+      // the cache already shows the op as done
+      lderr(cct) << "async " << ceph_mds_op_name(op) << " of " << path
+		 << " failed: " << cpp_strerror(r) << dendl;
+      clear_dir_complete_and_ordered(dir.get(), true);
+      dir->set_async_err(r);
+    }
+
+    ceph_assert(dir->async_dirops > 0);
+    dir->async_dirops--;
+    async_dirops_pending--;
+    if (!dir->async_dirops && dir->async_dirops_wanted)
+      cap_delay_requeue(dir.get());  // let check_caps() drop the want later
+    dir.reset();
+    trim_cache();
+    async_dirop_cond.notify_all();
+  }
+}
+
+void Client::wait_async_dirops(Inode *dir)
+{
+  ldout(cct, 10) << __func__ << " on " << (dir ? dir->ino : inodeno_t())
+		 << dendl;
+  std::unique_lock l{client_lock, std::adopt_lock};
+  async_dirop_cond.wait(l, [this, dir] {
+    return dir ? !dir->async_dirops : !async_dirops_pending;
+  });
+  l.release();
+}
+
+/*
+ * Send whatever is still queued (or fail it with err) and stop the
+ * async dirop threads.
+ */
+void Client::stop_async_dirop_threads(std::unique_lock<ceph::mutex>& cl, int err)
+{
+  if (err) {
+    while (!async_dirop_queue.empty()) {
+      MetaRequest *req = async_dirop_queue.front();
+      async_dirop_queue.pop_front();
+      Inode *dir = req->inode();
+      dir->set_async_err(err);
+      put_cap_ref(dir, req->async_caps);
+      dir->async_dirops--;
+      async_dirops_pending--;
+      put_request(req);
+    }
+  }
+
+  async_dirop_stopping = true;
+  async_dirop_cond.notify_all();
+  auto threads = std::move(async_dirop_threads);
+  async_dirop_threads.clear();
+  cl.unlock();
+  for (auto& t : threads)
+    t.join();
+  cl.lock();
+  async_dirop_stopping = false;
+  async_dirop_cond.notify_all();
+}
+
 void Client::unregister_request(MetaRequest *req)
 {
   mds_requests.erase(req->tid);
@@ -3544,6 +3692,8 @@ void Client::resend_unsafe_requests(MetaSession *session)
 
 void Client::wait_unsafe_requests()
 {
+  wait_async_dirops();
+
   list<MetaRequest*> last_unsafe_reqs;
   for (const auto &p : mds_sessions) {
     const auto s = p.second;
@@ -4225,6 +4375,12 @@ static int adjust_caps_used_for_lazyio(int used, int issued, int implemented)
  */
 void Client::check_caps(const InodeRef& in, unsigned flags)
 {
+  if (in->async_dirops_wanted && !in->async_dirops &&
+      in->async_dirops_idle_until <= ceph::coarse_mono_clock::now()) {
+    ldout(cct, 10) << __func__ << " async dirops idle on " << *in << dendl;
+    in->async_dirops_wanted = 0;
+  }
+
   unsigned wanted = in->caps_wanted();
   unsigned used = get_caps_used(in.get());
   unsigned cap_used;
@@ -7192,9 +7348,11 @@ void Client::_unmount(bool abort)
     mount_aborted = true;
     // Abort all mds sessions
     _abort_mds_sessions(-ENOTCONN);
+    stop_async_dirop_threads(lock, -ENOTCONN);
 
     objecter->op_cancel_writes(-ENOTCONN);
   } else {
+    stop_async_dirop_threads(lock);
     // flush the mdlog for pending requests, if any
     flush_mdlog_sync();
   }
@@ -9850,6 +10008,11 @@ int Client::_readdir_get_frag(int op, dir_result_t* dirp,
 
   MetaRequest *req = new MetaRequest(op);
   fill_req_cb(dirp, req, diri, fg);
+  if (op != CEPH_MDS_OP_READDIR_SNAPDIFF) {
+    // bounded by the option's max, well inside the MDS's signed budget
+    req->head.args.readdir.max_bytes =
+      cct->_conf.get_val<Option::size_t>("client_readdir_max_bytes");
+  }
 
   bufferlist dirbl;
   int res = make_request(req, dirp->perms, NULL, NULL, -1, &dirbl);
@@ -9877,6 +10040,28 @@ struct dentry_off_lt {
   }
 };
 
+/*
+ * Count the cached entries from idx on, up to max of them, whose inode
+ * attributes we would have to fetch from the MDS before returning them.
+ */
+unsigned Client::_readdir_cache_count_stale(Dir *dir, unsigned idx, int caps,
+					    unsigned max)
+{
+  unsigned stale = 0;
+  unsigned end = std::min<size_t>(dir->readdir_cache.size(), idx + max);
+  for (; idx < end; ++idx) {
+    Dentry *dn = dir->readdir_cache[idx];
+    if (!dn->inode || dn->cap_shared_gen != dir->parent_inode->shared_gen)
+      continue;
+    int mask = caps;
+    if (dn->inode->is_dir() && cct->_conf->client_dirsize_rbytes)
+      mask |= CEPH_STAT_RSTAT;
+    if (!dn->inode->caps_issued_mask(mask, true))
+      ++stale;
+  }
+  return stale;
+}
+
 int Client::_readdir_cache_cb(dir_result_t *dirp, add_dirent_cb_t cb, void *p,
 			      int caps, bool getref)
 {
@@ -9898,6 +10083,11 @@ int Client::_readdir_cache_cb(dir_result_t *dirp, add_dirent_cb_t cb, void *p,
 						  dir->readdir_cache.end(),
 						  dirp->offset, dentry_off_lt());
 
+  // Past this many entries without caps, one readdir from the MDS brings
+  // the attributes of a whole chunk back cheaper than a getattr per entry.
+  const unsigned batch = cct->_conf.get_val<uint64_t>("client_readdir_batch_getattr");
+  unsigned checked_until = 0;
+
   string dn_name;
   for (unsigned idx = pd - dir->readdir_cache.begin();
        idx < dir->readdir_cache.size();
@@ -9918,6 +10108,18 @@ int Client::_readdir_cache_cb(dir_result_t *dirp, add_dirent_cb_t cb, void *p,
     if (dn->inode->is_dir() && cct->_conf->client_dirsize_rbytes) {
       mask |= CEPH_STAT_RSTAT;
     }
+    // (not before the first entry is returned: a readdir from the top is
+    // checked against this cache entry by entry, null dentries and all)
+    if (batch > 0 && idx >= checked_until && !dirp->last_name.empty() &&
+	!dn->inode->caps_issued_mask(mask, true)) {
+      unsigned stale = _readdir_cache_count_stale(dir, idx, caps, 2 * batch);
+      if (stale >= batch) {
+	ldout(cct, 10) << " " << stale << " of the next " << 2 * batch
+		       << " entries need getattr, reading from mds instead" << dendl;
+	return -EAGAIN;
+      }
+      checked_until = idx + 2 * batch;
+    }
     int r = _getattr(dn->inode, mask, dirp->perms);
     if (r < 0)
       return r;
@@ -11786,6 +11988,38 @@ void Client::C_Readahead::finish(int r) {
   }
 }
 
+/*
+ * A sequential reader that still has to wait on the OSDs has caught up
+ * with its readahead: widen the window so that more objects are in flight,
+ * up to client_readahead_grow_max_periods (and a quarter of the object
+ * cacher, so readahead does not evict itself).
+ */
+void Client::grow_readahead(Fh *f, Inode *in, uint64_t off, uint64_t len,
+			    bool missed)
+{
+  const auto& conf = cct->_conf;
+  bool sequential = off == f->readahead_last_end;
+  f->readahead_last_end = off + len;
+  if (!missed || !sequential)
+    return;
+
+  uint64_t periods = conf.get_val<uint64_t>("client_readahead_grow_max_periods");
+  if (!periods)
+    return;
+  uint64_t ceiling = std::min<uint64_t>(in->layout.get_period() * periods,
+					conf->client_oc_size / 4);
+  if (conf->client_readahead_max_bytes)
+    ceiling = std::min<uint64_t>(ceiling, conf->client_readahead_max_bytes);
+
+  uint64_t cur = f->readahead.get_max_readahead_size();
+  if (cur >= ceiling)
+    return;
+  uint64_t next = std::min(cur * 2, ceiling);
+  ldout(cct, 10) << __func__ << " " << *in << " readahead max " << cur
+		 << " -> " << next << dendl;
+  f->readahead.set_max_readahead_size(next);
+}
+
 void Client::do_readahead(Fh *f, Inode *in, uint64_t off, uint64_t len)
 {
   if(f->readahead.get_min_readahead_size() > 0) {
@@ -11913,6 +12147,7 @@ int Client::_read_async(Fh *f, uint64_t off, uint64_t len, bufferlist *bl,
   std::vector<ObjectCacher::ObjHole> holes;
   r = objectcacher->file_read_ex(&in->oset, &in->layout, in->snapid,
                                  read_start, read_len, bl, 0, &holes, io_finish.get());
+  grow_readahead(f, in, off, len, r == 0);
   if (onfinish != nullptr) {
     // put the cap ref since we're releasing C_Read_Async_Finisher
     put_cap_ref(in, CEPH_CAP_FILE_CACHE);
@@ -13289,6 +13524,9 @@ int Client::_fsync(Inode *in, bool syncdataonly)
       flush_tid = last_flush_tid;
   } else ldout(cct, 10) << "no metadata needs to commit" << dendl;
 
+  if (!syncdataonly && in->async_dirops)
+    wait_async_dirops(in);
+
   if (!syncdataonly && !in->unsafe_ops.empty()) {
     flush_mdlog_sync(in);
 
@@ -16387,7 +16625,21 @@ int Client::_unlink(Inode *dir, const char *name, const UserPerm& perm)
 
   req->set_inode(wdr.diri);
 
-  int res = make_request(req, perm);
+  int res = 0;
+  if (!in->is_dir() && in->nlink == 1 && wdr.dn->primary_link &&
+      _want_async_dirop(wdr.diri.get(), CEPH_CAP_DIR_UNLINK)) {
+    // the reply will find the dentry already null, as a sync unlink leaves it
+    ldout(cct, 10) << "unlink(" << wdr.getpath() << ") queued async" << dendl;
+    clear_dir_complete_and_ordered(wdr.diri.get(), false);
+    unlink(wdr.dn.get(), true, true);  // keep dir, dentry
+    // open fds see the unlink now, as they would after a sync reply
+    in->nlink--;
+    in->ctime = ceph_clock_now();
+    in->change_attr++;
+    queue_async_dirop(req, perm, CEPH_CAP_DIR_UNLINK);
+  } else {
+    res = make_request(req, perm);
+  }
 
   trim_cache();
   ldout(cct, 8) << "unlink(" << wdr.getpath() << ") = " << res << dendl;
@@ -17248,25 +17500,27 @@ int Client::ll_commit_blocks(Inode *in,
     return 0;
 }
 
-int Client::ll_write(Fh *fh, loff_t off, loff_t len, const char *data)
+loff_t Client::_ll_write_max_len(Fh *fh, loff_t len)
 {
-  RWRef_t mref_reader(mount_state, CLIENT_MOUNTING);
-  if (!mref_reader.is_state_satisfied()) {
-    return -ENOTCONN;
-  }
-
 #if defined(__linux__)
   /* We can't return bytes written larger than INT_MAX, clamp size to
    * that or FSCRYPT_MAXIO_SIZE*/
   Inode *in = fh->inode.get();
   if (in->is_fscrypt_enabled()) {
-    len = std::min(len, (loff_t)FSCRYPT_MAXIO_SIZE);
-  } else {
-    len = std::min(len, (loff_t)INT_MAX);
+    return std::min(len, (loff_t)FSCRYPT_MAXIO_SIZE);
   }
-#else
-  len = std::min(len, (loff_t)INT_MAX);
 #endif
+  return std::min(len, (loff_t)INT_MAX);
+}
+
+int Client::ll_write(Fh *fh, loff_t off, loff_t len, const char *data)
+{
+  RWRef_t mref_reader(mount_state, CLIENT_MOUNTING);
+  if (!mref_reader.is_state_satisfied()) {
+    return -ENOTCONN;
+  }
+
+  len = _ll_write_max_len(fh, len);
   std::scoped_lock lock(client_lock);
   if (fh == NULL || !_ll_fh_exists(fh)) {
     ldout(cct, 3) << "(fh)" << fh << " is invalid" << dendl;
@@ -17288,6 +17542,39 @@ int Client::ll_write(Fh *fh, loff_t off, loff_t len, const char *data)
   return r;
 }
 
+/*
+ * Like ll_write(), but takes over the caller's buffers instead of copying
+ * the data, for callers that can fill a bufferlist directly.
+ */
+int Client::ll_write(Fh *fh, loff_t off, bufferlist&& bl)
+{
+  RWRef_t mref_reader(mount_state, CLIENT_MOUNTING);
+  if (!mref_reader.is_state_satisfied()) {
+    return -ENOTCONN;
+  }
+
+  loff_t len = _ll_write_max_len(fh, bl.length());
+  if (len < (loff_t)bl.length())
+    bl.splice(len, bl.length() - len);
+  std::scoped_lock lock(client_lock);
+  if (fh == NULL || !_ll_fh_exists(fh)) {
+    ldout(cct, 3) << "(fh)" << fh << " is invalid" << dendl;
+    return -EBADF;
+  }
+
+  ldout(cct, 3) << "ll_write " << fh << " " << fh->inode->ino << " " << off <<
+    "~" << len << dendl;
+  tout(cct) << "ll_write" << std::endl;
+  tout(cct) << (uintptr_t)fh << std::endl;
+  tout(cct) << off << std::endl;
+  tout(cct) << len << std::endl;
+
+  int r = _write(fh, off, len, std::move(bl));
+  ldout(cct, 3) << "ll_write " << fh << " " << off << "~" << len << " = " << r
+		<< dendl;
+  return r;
+}
+
 int64_t Client::ll_writev(struct Fh *fh, const struct iovec *iov, int iovcnt, int64_t off)
 {
   RWRef_t mref_reader(mount_state, CLIENT_MOUNTING);
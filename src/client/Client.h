@@ -51,6 +51,7 @@
 #include "FSCrypt.h"
 #endif
 
+#include <deque>
 #include <fstream>
 #include <locale>
 #include <map>
@@ -732,6 +733,7 @@ public:
 
   int ll_read(Fh *fh, loff_t off, loff_t len, bufferlist *bl);
   int ll_write(Fh *fh, loff_t off, loff_t len, const char *data);
+  int ll_write(Fh *fh, loff_t off, bufferlist&& bl);
   int64_t ll_readv(struct Fh *fh, const struct iovec *iov, int iovcnt, int64_t off);
   int64_t ll_writev(struct Fh *fh, const struct iovec *iov, int iovcnt, int64_t off);
   int64_t ll_preadv_pwritev(struct Fh *fh, const struct iovec *iov, int iovcnt,
@@ -1036,6 +1038,14 @@ public:
   ceph::condition_variable upkeep_cond;
   bool tick_thread_stopped = false;
 
+  /* async dirop threads: send queued namespace ops, client_async_dirops */
+  std::vector<std::thread> async_dirop_threads;
+  std::deque<MetaRequest*> async_dirop_queue;
+  ceph::condition_variable async_dirop_cond;
+  unsigned async_dirop_idle = 0;
+  unsigned async_dirops_pending = 0;  // queued or waiting for a first reply
+  bool async_dirop_stopping = false;
+
   std::unique_ptr<PerfCounters> logger;
   std::unique_ptr<MDSMap> mdsmap;
 #if defined(__linux__)
@@ -1107,6 +1117,12 @@ protected:
   void put_request(MetaRequest *request);
   void unregister_request(MetaRequest *request);
 
+  bool _want_async_dirop(Inode *dir, int need);
+  void queue_async_dirop(MetaRequest *req, const UserPerm& perms, int caps);
+  void async_dirop_entry();
+  void wait_async_dirops(Inode *dir=nullptr);
+  void stop_async_dirop_threads(std::unique_lock<ceph::mutex>& cl, int err=0);
+
   int verify_reply_trace(int r, MetaSession *session, MetaRequest *request,
 			 const MConstRef<MClientReply>& reply,
 			 InodeRef *ptarget, bool *pcreated,
@@ -1190,6 +1206,7 @@ protected:
   bool _ll_fh_exists(Fh *f) {
     return ll_unclosed_fh_set.count(f);
   }
+  loff_t _ll_write_max_len(Fh *fh, loff_t len);
 
   // helpers
   void wake_up_session_caps(MetaSession *s, bool reconnect);
@@ -2045,6 +2062,7 @@ private:
   void _readdir_rechoose_frag(dir_result_t *dirp);
   int _readdir_get_frag(int op, dir_result_t *dirp,
     fill_readdir_args_cb_t fill_req_cb);
+  unsigned _readdir_cache_count_stale(Dir *dir, unsigned idx, int caps, unsigned max);
   int _readdir_cache_cb(dir_result_t *dirp, add_dirent_cb_t cb, void *p, int caps, bool getref);
   int _readdir_r_cb(int op,
     dir_result_t* d,
@@ -2141,6 +2159,7 @@ private:
   loff_t _lseek(Fh *fh, loff_t offset, int whence);
   int64_t _read(Fh *fh, int64_t offset, uint64_t size, bufferlist *bl,
   		Context *onfinish = nullptr, bool read_for_write = false);
+  void grow_readahead(Fh *f, Inode *in, uint64_t off, uint64_t len, bool missed);
   void do_readahead(Fh *f, Inode *in, uint64_t off, uint64_t len);
   int64_t _write_success(Fh *fh, utime_t start, uint64_t fpos,
                          int64_t request_offset, uint64_t request_size,
@@ -62,6 +62,7 @@ public:
     ceph_assert(inode_xlist_link.get_list() == &inode->dentries);
     inode_xlist_link.remove_myself();
     inode.reset();
+    primary_link = false;
     dir->num_null_dentries++;
   }
   void mark_primary() {
@@ -108,6 +109,7 @@ public:
   int cap_shared_gen = -1;
   std::string alternate_name;
   bool is_renaming = false;
+  bool primary_link = false;  // per the MDS, the inode's primary dentry
 
 private:
   xlist<Dentry *>::item inode_xlist_link;
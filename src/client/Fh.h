@@ -29,6 +29,7 @@ struct Fh {
   std::list<ceph::condition_variable*> pos_waiters;   // waiters for pos
 
   Readahead readahead;
+  uint64_t readahead_last_end = 0;  // end of the last read through the cache
 
   // file lock
   std::unique_ptr<ceph_lock_state_t> fcntl_locks;
@@ -371,7 +371,7 @@ int Inode::caps_file_wanted()
 
 int Inode::caps_wanted()
 {
-  int want = caps_file_wanted() | caps_used();
+  int want = caps_file_wanted() | caps_used() | async_dirops_wanted;
   if (want & CEPH_CAP_FILE_BUFFER)
     want |= CEPH_CAP_FILE_EXCL;
   return want;
@@ -313,6 +313,13 @@ struct Inode : RefCountedObject {
 
   xlist<MetaRequest*> unsafe_ops;
 
+  // client_async_dirops: dir op caps asked for, and ops in this dir that
+  // have been queued but whose first reply has not arrived yet
+  int async_dirops_wanted = 0;
+  unsigned async_dirops = 0;
+  // async_dirops_wanted is dropped once this passes with nothing queued
+  ceph::coarse_mono_time async_dirops_idle_until;
+
   std::set<Fh*> fhs;
 
   mds_rank_t dir_pin = MDS_RANK_NONE;
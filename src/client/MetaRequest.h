@@ -56,6 +56,8 @@ public:
   ceph::cref_t<MClientReply> reply = NULL;  // the reply
   bool kick = false;
   bool success = false;
+  bool async = false;              // sent from the client_async_dirops queue
+  int async_caps = 0;              // dir cap refs held for the queued op
 
   // readdir result
   dir_result_t *dirp = NULL;
@@ -920,6 +920,45 @@ static void fuse_ll_write(fuse_req_t req, fuse_ino_t ino, const char *buf,
     fuse_reply_err(req, get_sys_errno(-r));
 }
 
+#if FUSE_VERSION >= FUSE_MAKE_VERSION(2, 9)
+/*
+ * With splice_write the payload arrives in a pipe.  Without write_buf
+ * libfuse would copy it out into a heap buffer and ll_write() would copy
+ * it again into a bufferlist; here it is moved straight into page-aligned
+ * buffer memory that the client then owns.
+ */
+static void fuse_ll_write_buf(fuse_req_t req, fuse_ino_t ino,
+			      struct fuse_bufvec *bufv, off_t off,
+			      struct fuse_file_info *fi)
+{
+  CephFuse::Handle *cfuse = fuse_ll_req_prepare(req);
+  Fh *fh = reinterpret_cast<Fh*>(fi->fh);
+  size_t size = fuse_buf_size(bufv);
+
+  bufferlist bl;
+  if (bufv->count == 1 && !(bufv->buf[0].flags & FUSE_BUF_IS_FD)) {
+    bl.append(static_cast<const char*>(bufv->buf[0].mem) + bufv->off, size);
+  } else {
+    bufferptr bp = ceph::buffer::create_page_aligned(size);
+    struct fuse_bufvec dst = FUSE_BUFVEC_INIT(size);
+    dst.buf[0].mem = bp.c_str();
+    ssize_t r = fuse_buf_copy(&dst, bufv, (enum fuse_buf_copy_flags)0);
+    if (r < 0) {
+      fuse_reply_err(req, get_sys_errno(-r));
+      return;
+    }
+    bp.set_length(r);
+    bl.push_back(std::move(bp));
+  }
+
+  int r = cfuse->client->ll_write(fh, off, std::move(bl));
+  if (r >= 0)
+    fuse_reply_write(req, r);
+  else
+    fuse_reply_err(req, get_sys_errno(-r));
+}
+#endif
+
 static void fuse_ll_flush(fuse_req_t req, fuse_ino_t ino,
 			  struct fuse_file_info *fi)
 {
@@ -1552,7 +1591,7 @@ const static struct fuse_lowlevel_ops fuse_ll_oper = {
  poll: 0,
 #endif
 #if FUSE_VERSION >= FUSE_MAKE_VERSION(2, 9)
- write_buf: 0,
+ write_buf: fuse_ll_write_buf,
  retrieve_reply: 0,
  forget_multi: 0,
  flock: fuse_ll_flock,
@@ -14,16 +14,26 @@ AsyncOpTracker::~AsyncOpTracker() {
 }
 
 void AsyncOpTracker::start_op() {
-  std::lock_guard locker(m_lock);
-  ++m_pending_ops;
+  m_pending_ops.fetch_add(1, std::memory_order_relaxed);
 }
 
 void AsyncOpTracker::finish_op() {
+  // only the last op has to synchronize with wait_for_ops()
+  auto pending_ops = m_pending_ops.load(std::memory_order_relaxed);
+  while (pending_ops > 1) {
+    if (m_pending_ops.compare_exchange_weak(pending_ops, pending_ops - 1,
+                                            std::memory_order_release,
+                                            std::memory_order_relaxed)) {
+      return;
+    }
+  }
+
   Context *on_finish = nullptr;
   {
     std::lock_guard locker(m_lock);
-    ceph_assert(m_pending_ops > 0);
-    if (--m_pending_ops == 0) {
+    pending_ops = m_pending_ops.fetch_sub(1, std::memory_order_acq_rel);
+    ceph_assert(pending_ops > 0);
+    if (pending_ops == 1) {
       std::swap(on_finish, m_on_finish);
     }
   }
@@ -37,7 +47,7 @@ void AsyncOpTracker::wait_for_ops(Context *on_finish) {
   {
     std::lock_guard locker(m_lock);
     ceph_assert(m_on_finish == nullptr);
-    if (m_pending_ops > 0) {
+    if (m_pending_ops.load(std::memory_order_acquire) > 0) {
       m_on_finish = on_finish;
       return;
     }
@@ -46,7 +56,5 @@ void AsyncOpTracker::wait_for_ops(Context *on_finish) {
 }
 
 bool AsyncOpTracker::empty() {
-  std::lock_guard locker(m_lock);
-  return (m_pending_ops == 0);
+  return (m_pending_ops.load(std::memory_order_acquire) == 0);
 }
-
@@ -4,6 +4,8 @@
 #ifndef CEPH_ASYNC_OP_TRACKER_H
 #define CEPH_ASYNC_OP_TRACKER_H
 
+#include <atomic>
+
 #include "common/ceph_mutex.h"
 #include "include/Context.h"
 
@@ -20,8 +22,10 @@ public:
   bool empty();
 
 private:
+  // only finishing the last op takes m_lock, so tracking ops on a hot
+  // path does not serialize on it
   ceph::mutex m_lock = ceph::make_mutex("AsyncOpTracker::m_lock");
-  uint32_t m_pending_ops = 0;
+  std::atomic<uint32_t> m_pending_ops = 0;
   Context *m_on_finish = nullptr;
 
 };
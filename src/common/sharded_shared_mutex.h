@@ -0,0 +1,109 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
+// vim: ts=8 sw=2 sts=2 expandtab
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <string>
+
+#include "common/ceph_mutex.h"
+
+namespace ceph {
+/// a shared_mutex whose shared side is spread over per-thread shards
+///
+/// Every thread is pinned to one shard, so concurrent shared lockers on
+/// different threads do not bounce the same cache line.  Exclusive
+/// lockers acquire all shards in order, which makes lock() considerably
+/// more expensive than with a plain shared_mutex: use this only where
+/// shared locking dominates and exclusive locking is rare.
+///
+/// As with std::shared_mutex, unlock_shared() must be called from the
+/// thread that called lock_shared().
+class sharded_shared_mutex {
+  static constexpr std::size_t cache_line_size = 64;
+public:
+  sharded_shared_mutex([[maybe_unused]] const std::string& name,
+                       [[maybe_unused]] unsigned num_shards)
+#ifdef CEPH_DEBUG_MUTEX
+    // lockdep identifies locks by name and would flag the exclusive
+    // path taking every shard as a recursive lock.  keep a single shard
+    // carrying the name so lock ordering is still checked.
+    : shard{ceph::make_shared_mutex(name)}
+  {}
+#else
+    : num_shards(std::max(num_shards, 1u)),
+      shards(std::make_unique<shard_t[]>(this->num_shards))
+  {}
+#endif
+  ~sharded_shared_mutex() = default;
+  sharded_shared_mutex(const sharded_shared_mutex&) = delete;
+  sharded_shared_mutex& operator=(const sharded_shared_mutex&) = delete;
+
+#ifdef CEPH_DEBUG_MUTEX
+  void lock() { shard.lock(); }
+  bool try_lock() { return shard.try_lock(); }
+  void unlock() { shard.unlock(); }
+  void lock_shared() { shard.lock_shared(); }
+  bool try_lock_shared() { return shard.try_lock_shared(); }
+  void unlock_shared() { shard.unlock_shared(); }
+
+  bool is_locked() const { return shard.is_locked(); }
+  bool is_wlocked() const { return shard.is_wlocked(); }
+  bool is_rlocked() const { return shard.is_rlocked(); }
+  bool is_locked_by_me() const { return shard.is_locked_by_me(); }
+
+private:
+  ceph::shared_mutex shard;
+#else
+  void lock() {
+    for (unsigned i = 0; i < num_shards; i++) {
+      shards[i].lock.lock();
+    }
+  }
+  bool try_lock() {
+    for (unsigned i = 0; i < num_shards; i++) {
+      if (!shards[i].lock.try_lock()) {
+        while (i > 0) {
+          shards[--i].lock.unlock();
+        }
+        return false;
+      }
+    }
+    return true;
+  }
+  void unlock() {
+    for (unsigned i = num_shards; i > 0; i--) {
+      shards[i - 1].lock.unlock();
+    }
+  }
+  void lock_shared() {
+    my_shard().lock.lock_shared();
+  }
+  bool try_lock_shared() {
+    return my_shard().lock.try_lock_shared();
+  }
+  void unlock_shared() {
+    my_shard().lock.unlock_shared();
+  }
+
+private:
+  struct alignas(cache_line_size) shard_t {
+    ceph::shared_mutex lock;
+  };
+
+  shard_t& my_shard() {
+    return shards[thread_index() % num_shards];
+  }
+  static unsigned thread_index() {
+    static std::atomic<unsigned> next_index{0};
+    thread_local const unsigned index = next_index++;
+    return index;
+  }
+
+  const unsigned num_shards;
+  std::unique_ptr<shard_t[]> shards;
+#endif
+};
+} // namespace ceph
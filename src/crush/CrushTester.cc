@@ -17,6 +17,7 @@
 #include "CrushTester.h"
 #include "CrushTreeDumper.h"
 #include "common/ceph_context.h"
+#include "common/ceph_time.h"
 #include "include/ceph_features.h"
 #include "common/debug.h"
 
@@ -498,6 +499,7 @@ int CrushTester::test(CephContext* cct)
 
       vector<int> per(crush.get_max_devices());
       map<int,int> sizes;
+      ceph::timespan mapping_time = ceph::timespan::zero();
 
       int num_objects = ((max_x - min_x) + 1);
       float num_devices = (float) per.size(); // get the total number of devices, better to cast as a float here 
@@ -576,7 +578,13 @@ int CrushTester::test(CephContext* cct)
             if (pool_id != -1) {
               real_x = crush_hash32_2(CRUSH_HASH_RJENKINS1, x, (uint32_t)pool_id);
             }
-            crush.do_rule(r, real_x, out, nr, weight, 0);
+            if (output_mapping_time) {
+              auto start = ceph::mono_clock::now();
+              crush.do_rule(r, real_x, out, nr, weight, 0);
+              mapping_time += ceph::mono_clock::now() - start;
+            } else {
+              crush.do_rule(r, real_x, out, nr, weight, 0);
+            }
           } else {
             if (output_mappings)
 	      err << "RNG"; // prepend RNG to placement output to denote simulation
@@ -613,6 +621,18 @@ int CrushTester::test(CephContext* cct)
         batch_max = batch_min + objects_per_batch - 1;
       }
 
+      if (output_mapping_time && use_crush) {
+        double secs = std::chrono::duration<double>(mapping_time).count();
+        err << "rule " << r << " (" << crush.get_rule_name(r) << ") num_rep " << nr
+            << " mapped " << num_objects << " inputs in " << secs << "s";
+        if (secs > 0) {
+          err << " (" << (uint64_t)(num_objects / secs) << " mappings/s, "
+              << std::chrono::duration<double, std::nano>(mapping_time).count() / num_objects
+              << " ns/mapping)";
+        }
+        err << std::endl;
+      }
+
       for (unsigned i = 0; i < per.size(); i++)
         if (output_utilization && !output_statistics)
           err << "  device " << i
@@ -140,6 +140,61 @@ __u32 crush_hash32_5(int type, __u32 a, __u32 b, __u32 c, __u32 d, __u32 e)
 	}
 }
 
+/*
+ * The rjenkins mix is plain 32-bit add/sub/xor/shift arithmetic, so
+ * GCC/clang generic vectors let it run across SSE2/AVX2/NEON lanes
+ * without per-ISA intrinsics.  Lanes that do not fill a vector, and
+ * compilers (or the kernel) without vector support, take the scalar path,
+ * which produces identical values.
+ */
+#if defined(__GNUC__) && !defined(__KERNEL__)
+# ifdef __AVX2__
+#  define CRUSH_HASH_LANES 8
+# else
+#  define CRUSH_HASH_LANES 4
+# endif
+
+typedef __u32 crush_hash_vec_t
+	__attribute__((vector_size(CRUSH_HASH_LANES * sizeof(__u32))));
+#define crush_hash_vec_splat(v) ((crush_hash_vec_t){0} + (__u32)(v))
+
+static crush_hash_vec_t crush_hash32_rjenkins1_3_vec(crush_hash_vec_t a,
+						     crush_hash_vec_t b,
+						     crush_hash_vec_t c)
+{
+	crush_hash_vec_t hash = crush_hash_seed ^ a ^ b ^ c;
+	crush_hash_vec_t x = crush_hash_vec_splat(231232);
+	crush_hash_vec_t y = crush_hash_vec_splat(1232);
+	crush_hashmix(a, b, hash);
+	crush_hashmix(c, x, hash);
+	crush_hashmix(y, a, hash);
+	crush_hashmix(b, x, hash);
+	crush_hashmix(y, c, hash);
+	return hash;
+}
+#endif
+
+void crush_hash32_3_batch(int type, __u32 a, const __s32 *b, __u32 c,
+			  __u32 *out, unsigned int n)
+{
+	unsigned int i = 0;
+
+#ifdef CRUSH_HASH_LANES
+	if (type == CRUSH_HASH_RJENKINS1) {
+		for (; i + CRUSH_HASH_LANES <= n; i += CRUSH_HASH_LANES) {
+			crush_hash_vec_t vb, hash;
+			memcpy(&vb, b + i, sizeof(vb));
+			hash = crush_hash32_rjenkins1_3_vec(
+				crush_hash_vec_splat(a), vb,
+				crush_hash_vec_splat(c));
+			memcpy(out + i, &hash, sizeof(hash));
+		}
+	}
+#endif
+	for (; i < n; i++)
+		out[i] = crush_hash32_3(type, a, b[i], c);
+}
+
 const char *crush_hash_name(int type)
 {
 	switch (type) {
@@ -7,6 +7,7 @@
 #include "journal/Utils.h"
 
 #include <atomic>
+#include <set>
 
 #define dout_subsys ceph_subsys_journaler
 #undef dout_prefix
@@ -133,39 +134,85 @@ void JournalRecorder::set_append_batch_options(int flush_interval,
 
 Future JournalRecorder::append(uint64_t tag_tid,
                                const bufferlist &payload_bl) {
-  ldout(m_cct, 20) << "tag_tid=" << tag_tid << dendl;
+  std::list<Future> futures;
+  append(tag_tid, {payload_bl}, &futures);
+  ceph_assert(futures.size() == 1);
+  return futures.front();
+}
+
+void JournalRecorder::append(uint64_t tag_tid,
+                             const std::list<bufferlist> &payload_bls,
+                             std::list<Future> *futures) {
+  ldout(m_cct, 20) << "tag_tid=" << tag_tid << ", "
+                   << "count=" << payload_bls.size() << dendl;
+
+  // entries are grouped by splay object so that each object receives
+  // the whole batch in a single append op, and the objects are appended
+  // to in parallel
+  struct ObjectAppend {
+    ceph::ref_t<ObjectRecorder> object_recorder;
+    AppendBuffers append_buffers;
+  };
+  std::map<uint8_t, ObjectAppend> object_appends;
+  Lockers lockers;
 
   m_lock.lock();
 
-  uint64_t entry_tid = m_journal_metadata->allocate_entry_tid(tag_tid);
   uint8_t splay_width = m_journal_metadata->get_splay_width();
-  uint8_t splay_offset = entry_tid % splay_width;
+  for (auto& payload_bl : payload_bls) {
+    uint64_t entry_tid = m_journal_metadata->allocate_entry_tid(tag_tid);
+    uint8_t splay_offset = entry_tid % splay_width;
 
-  auto object_ptr = get_object(splay_offset);
-  uint64_t commit_tid = m_journal_metadata->allocate_commit_tid(
-    object_ptr->get_object_number(), tag_tid, entry_tid);
-  auto future = ceph::make_ref<FutureImpl>(tag_tid, entry_tid, commit_tid);
-  future->init(m_prev_future);
-  m_prev_future = future;
+    auto& object_append = object_appends[splay_offset];
+    if (!object_append.object_recorder) {
+      object_append.object_recorder = get_object(splay_offset);
+    }
+
+    uint64_t commit_tid = m_journal_metadata->allocate_commit_tid(
+      object_append.object_recorder->get_object_number(), tag_tid, entry_tid);
+    auto future = ceph::make_ref<FutureImpl>(tag_tid, entry_tid, commit_tid);
+    future->init(m_prev_future);
+    m_prev_future = future;
+
+    object_append.append_buffers.emplace_back(future, payload_bl);
+    futures->emplace_back(future);
+  }
 
-  m_object_locks[splay_offset].lock();
+  // acquire in splay order, consistent with lock_object_recorders()
+  lockers.reserve(object_appends.size());
+  for (auto& [splay_offset, object_append] : object_appends) {
+    lockers.emplace_back(m_object_locks[splay_offset]);
+  }
   m_lock.unlock();
 
-  bufferlist entry_bl;
-  encode(Entry(future->get_tag_tid(), future->get_entry_tid(), payload_bl),
-	 entry_bl);
-  ceph_assert(entry_bl.length() <= m_journal_metadata->get_object_size());
+  std::set<uint64_t> full_object_numbers;
+  auto locker_it = lockers.begin();
+  for (auto& [splay_offset, object_append] : object_appends) {
+    for (auto& append_buffer : object_append.append_buffers) {
+      auto& future = append_buffer.first;
+      bufferlist entry_bl;
+      encode(Entry(future->get_tag_tid(), future->get_entry_tid(),
+                   append_buffer.second),
+             entry_bl);
+      ceph_assert(entry_bl.length() <= m_journal_metadata->get_object_size());
+      append_buffer.second = std::move(entry_bl);
+    }
 
-  bool object_full = object_ptr->append({{future, entry_bl}});
-  m_object_locks[splay_offset].unlock();
+    auto& object_recorder = object_append.object_recorder;
+    if (object_recorder->append(std::move(object_append.append_buffers))) {
+      ldout(m_cct, 10) << "object " << object_recorder->get_oid()
+                       << " now full" << dendl;
+      full_object_numbers.insert(object_recorder->get_object_number());
+    }
+    (locker_it++)->unlock();
+  }
 
-  if (object_full) {
-    ldout(m_cct, 10) << "object " << object_ptr->get_oid() << " now full"
-                     << dendl;
+  if (!full_object_numbers.empty()) {
     std::lock_guard l{m_lock};
-    close_and_advance_object_set(object_ptr->get_object_number() / splay_width);
+    for (auto object_number : full_object_numbers) {
+      close_and_advance_object_set(object_number / splay_width);
+    }
   }
-  return Future(future);
 }
 
 void JournalRecorder::flush(Context *on_safe) {
@@ -14,6 +14,7 @@
 #include "journal/FutureImpl.h"
 #include "journal/JournalMetadata.h"
 #include "journal/ObjectRecorder.h"
+#include <list>
 #include <map>
 #include <string>
 
@@ -32,6 +33,8 @@ public:
                                 double flush_age);
 
   Future append(uint64_t tag_tid, const bufferlist &bl);
+  void append(uint64_t tag_tid, const std::list<bufferlist> &bls,
+              std::list<Future> *futures);
   void flush(Context *on_safe);
 
   ceph::ref_t<ObjectRecorder> get_object(uint8_t splay_offset);
@@ -428,6 +428,12 @@ Future Journaler::append(uint64_t tag_tid, const bufferlist &payload_bl) {
   return m_recorder->append(tag_tid, payload_bl);
 }
 
+void Journaler::append(uint64_t tag_tid,
+                       const std::list<bufferlist> &payload_bls,
+                       std::list<Future> *futures) {
+  m_recorder->append(tag_tid, payload_bls, futures);
+}
+
 void Journaler::flush_append(Context *on_safe) {
   m_recorder->flush(on_safe);
 }
@@ -111,6 +111,8 @@ public:
   void set_append_batch_options(int flush_interval, uint64_t flush_bytes,
                                 double flush_age);
   Future append(uint64_t tag_tid, const bufferlist &bl);
+  void append(uint64_t tag_tid, const std::list<bufferlist> &bls,
+              std::list<Future> *futures);
   void flush_append(Context *on_safe);
   void stop_append(Context *on_safe);
 
@@ -335,13 +335,7 @@ bool ObjectRecorder::send_appends(bool force, ceph::ref_t<FutureImpl> flush_futu
     ldout(m_cct, 20) << "flushing " << *future << dendl;
     future->set_flush_in_progress();
 
-    if (m_compat_mode) {
-      op.append(bl);
-      op.set_op_flags2(CEPH_OSD_OP_FLAG_FADVISE_DONTNEED);
-    } else {
-      append_bl.append(bl);
-    }
-
+    append_bl.append(bl);
     append_bytes += bl.length();
     append_buffers.push_back(*it);
     it = m_pending_buffers.erase(it);
@@ -363,7 +357,11 @@ bool ObjectRecorder::send_appends(bool force, ceph::ref_t<FutureImpl> flush_futu
     ceph_assert(m_pending_bytes >= append_bytes);
     m_pending_bytes -= append_bytes;
 
-    if (!m_compat_mode) {
+    // the whole batch is written with a single append
+    if (m_compat_mode) {
+      op.append(append_bl);
+      op.set_op_flags2(CEPH_OSD_OP_FLAG_FADVISE_DONTNEED);
+    } else {
       client::append(&op, m_soft_max_size, append_bl);
     }
 
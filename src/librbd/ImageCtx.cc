@@ -293,7 +293,13 @@ librados::IoCtx duplicate_io_ctx(librados::IoCtx& io_ctx) {
     plb.add_u64_counter(l_librbd_resize, "resize", "Resizes");
     plb.add_u64_counter(l_librbd_readahead, "readahead", "Read ahead");
     plb.add_u64_counter(l_librbd_readahead_bytes, "readahead_bytes", "Data size in read ahead", NULL, 0, unit_t(UNIT_BYTES));
+    plb.add_u64_counter(l_librbd_readahead_hit, "readahead_hit", "Reads served from read ahead buffers");
+    plb.add_u64_counter(l_librbd_readahead_hit_bytes, "readahead_hit_bytes", "Data size served from read ahead buffers", NULL, 0, unit_t(UNIT_BYTES));
+    plb.add_u64_counter(l_librbd_readahead_miss, "readahead_miss", "Reads not served from read ahead buffers");
+    plb.add_u64_counter(l_librbd_readahead_evicted_bytes, "readahead_evicted_bytes", "Read ahead data dropped before it was read", NULL, 0, unit_t(UNIT_BYTES));
     plb.add_u64_counter(l_librbd_invalidate_cache, "invalidate_cache", "Cache invalidates");
+    plb.add_time_avg(l_librbd_journal_append_latency, "journal_append_latency", "Latency of journal appends until safe");
+    plb.add_time_avg(l_librbd_journal_commit_latency, "journal_commit_latency", "Latency of image updates after journal appends are safe");
 
     plb.add_time(l_librbd_opened_time, "opened_time", "Opened time",
                  "ots", perf_prio);
@@ -6,6 +6,7 @@
 #include "common/AsyncOpTracker.h"
 #include "common/Clock.h" // for ceph_clock_now()
 #include "common/errno.h"
+#include "common/perf_counters.h"
 #include "common/Timer.h"
 #include "common/WorkQueue.h"
 #include "cls/journal/cls_journal_types.h"
@@ -916,15 +917,20 @@ uint64_t Journal<I>::append_io_events(journal::EventType event_type,
     ceph_assert(tid != 0);
   }
 
-  Futures futures;
   for (auto &bl : bufferlists) {
     ceph_assert(bl.length() <= m_max_append_size);
-    futures.push_back(m_journaler->append(m_tag_tid, bl));
   }
 
+  // append all entries of the event as a single batch
+  auto append_time = ceph_clock_now();
+  Futures futures;
+  m_journaler->append(m_tag_tid, bufferlists, &futures);
+
   {
     std::lock_guard event_locker{m_event_lock};
-    m_events[tid] = Event(futures, image_extents, filter_ret_val);
+    auto& event = m_events[tid];
+    event = Event(futures, image_extents, filter_ret_val);
+    event.append_time = append_time;
   }
 
   CephContext *cct = m_image_ctx.cct;
@@ -1303,6 +1309,8 @@ void Journal<I>::complete_event(typename Events::iterator it, int r) {
 
   event.committed_io = true;
   if (event.safe) {
+    m_image_ctx.perfcounter->tinc(l_librbd_journal_commit_latency,
+                                  ceph_clock_now() - event.safe_time);
     if (r >= 0) {
       for (auto &future : event.futures) {
         m_journaler->committed(future);
@@ -1622,6 +1630,10 @@ void Journal<I>::handle_io_event_safe(int r, uint64_t tid) {
     Event &event = it->second;
     on_safe_contexts.swap(event.on_safe_contexts);
 
+    event.safe_time = ceph_clock_now();
+    m_image_ctx.perfcounter->tinc(l_librbd_journal_append_latency,
+                                  event.safe_time - event.append_time);
+
     if (r < 0 || event.committed_io) {
       // failed journal write so IO won't be sent -- or IO extent was
       // overwritten by future IO operations so this was a no-op IO event
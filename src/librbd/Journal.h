@@ -205,6 +205,9 @@ private:
     bool safe = false;
     int ret_val = 0;
 
+    utime_t append_time;
+    utime_t safe_time;
+
     Event() {
     }
     Event(const Futures &_futures, const io::Extents &image_extents,
@@ -49,9 +49,16 @@ enum {
 
   l_librbd_readahead,
   l_librbd_readahead_bytes,
+  l_librbd_readahead_hit,
+  l_librbd_readahead_hit_bytes,
+  l_librbd_readahead_miss,
+  l_librbd_readahead_evicted_bytes,
 
   l_librbd_invalidate_cache,
 
+  l_librbd_journal_append_latency,
+  l_librbd_journal_commit_latency,
+
   l_librbd_opened_time,
   l_librbd_lock_acquired_time,
 
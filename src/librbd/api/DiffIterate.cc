@@ -288,6 +288,24 @@ std::pair<uint64_t, uint64_t> DiffIterate<I>::calc_object_diff_range() {
   return {object_extents.front().object_no, object_extents.back().object_no + 1};
 }
 
+template <typename I>
+bool DiffIterate<I>::is_object_diff_updated(
+    uint64_t off, uint64_t len, uint64_t start_object_no,
+    const BitVector<2>& object_diff_state, bool list_parent) {
+  striper::LightweightObjectExtents object_extents;
+  io::util::area_to_object_extents(&m_image_ctx, off, len,
+                                   io::ImageArea::DATA, 0, &object_extents);
+  for (const auto& oe : object_extents) {
+    uint8_t diff_state = object_diff_state[oe.object_no - start_object_no];
+    if (diff_state == object_map::DIFF_STATE_HOLE_UPDATED ||
+        diff_state == object_map::DIFF_STATE_DATA_UPDATED ||
+        (diff_state == object_map::DIFF_STATE_HOLE && list_parent)) {
+      return true;
+    }
+  }
+  return false;
+}
+
 template <typename I>
 int DiffIterate<I>::execute() {
   CephContext* cct = m_image_ctx.cct;
@@ -321,10 +339,13 @@ int DiffIterate<I>::execute() {
 
   int r;
   bool fast_diff_enabled = false;
+  bool list_parent = false;
   uint64_t start_object_no, end_object_no;
   BitVector<2> object_diff_state;
   interval_set<uint64_t> parent_diff;
-  if (m_whole_object) {
+  {
+    // even when precise extents are requested, the object map diff is
+    // used to list snapshots only of the objects that were updated
     std::tie(start_object_no, end_object_no) = calc_object_diff_range();
 
     C_SaferCond ctx;
@@ -349,14 +370,19 @@ int DiffIterate<I>::execute() {
         io::Extents parent_extents = {{m_offset, m_length}};
         if (m_image_ctx.prune_parent_extents(parent_extents, io::ImageArea::DATA,
                                              raw_overlap, false) > 0) {
-          ldout(cct, 10) << " first getting parent diff" << dendl;
-          DiffIterate diff_parent(*m_image_ctx.parent, 0,
-                                  parent_extents[0].first,
-                                  parent_extents[0].second, true, true,
-                                  &simple_diff_cb, &parent_diff);
-          r = diff_parent.execute();
-          if (r < 0) {
-            return r;
+          if (!m_whole_object) {
+            // holes in the child are reported by list_snaps from the parent
+            list_parent = true;
+          } else {
+            ldout(cct, 10) << " first getting parent diff" << dendl;
+            DiffIterate diff_parent(*m_image_ctx.parent, 0,
+                                    parent_extents[0].first,
+                                    parent_extents[0].second, true, true,
+                                    &simple_diff_cb, &parent_diff);
+            r = diff_parent.execute();
+            if (r < 0) {
+              return r;
+            }
           }
         }
       }
@@ -378,7 +404,7 @@ int DiffIterate<I>::execute() {
     uint64_t period_off = round_down_to(off, period);
     uint64_t read_len = std::min(period_off + period - off, left);
 
-    if (fast_diff_enabled) {
+    if (fast_diff_enabled && m_whole_object) {
       // map to objects (there would be one extent per object)
       striper::LightweightObjectExtents object_extents;
       io::util::area_to_object_extents(&m_image_ctx, off, read_len,
@@ -430,6 +456,11 @@ int DiffIterate<I>::execute() {
           return r;
         }
       }
+    } else if (fast_diff_enabled &&
+               !is_object_diff_updated(off, read_len, start_object_no,
+                                       object_diff_state, list_parent)) {
+      ldout(cct, 20) << "skipping unchanged image extent " << off << "~"
+                     << read_len << dendl;
     } else {
       auto diff_object = new C_DiffObject<I>(m_image_ctx, diff_context, off,
                                              read_len);
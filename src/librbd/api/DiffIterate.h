@@ -49,6 +49,10 @@ private:
   }
 
   std::pair<uint64_t, uint64_t> calc_object_diff_range();
+  bool is_object_diff_updated(uint64_t off, uint64_t len,
+                              uint64_t start_object_no,
+                              const BitVector<2>& object_diff_state,
+                              bool list_parent);
 
   int execute();
 };
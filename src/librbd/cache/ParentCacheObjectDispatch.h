@@ -134,8 +134,8 @@ public:
 
 private:
 
-  int read_object(std::string file_path, ceph::bufferlist* read_data,
-                  uint64_t offset, uint64_t length, Context *on_finish);
+  int read_object(int fd, uint64_t file_size, ceph::bufferlist* read_data,
+                  uint64_t offset, uint64_t length);
   void handle_read_cache(ceph::immutable_obj_cache::ObjectCacheRequest* ack,
                          uint64_t object_no, io::ReadExtents* extents,
                          IOContext io_context, int read_flags,
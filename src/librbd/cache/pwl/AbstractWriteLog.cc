@@ -55,6 +55,10 @@ AbstractWriteLog<I>::AbstractWriteLog(
       "librbd::cache::pwl::AbstractWriteLog::m_deferred_dispatch_lock", this))),
     m_blockguard_lock(ceph::make_mutex(pwl::unique_lock_name(
       "librbd::cache::pwl::AbstractWriteLog::m_blockguard_lock", this))),
+    m_max_flush_ops(image_ctx.config.template get_val<uint64_t>(
+      "rbd_persistent_cache_flush_ops")),
+    m_max_flush_bytes(image_ctx.config.template get_val<Option::size_t>(
+      "rbd_persistent_cache_flush_bytes")),
     m_thread_pool(
         image_ctx.cct, "librbd::cache::pwl::AbstractWriteLog::thread_pool",
         "tp_pwl", 4, ""),
@@ -268,6 +272,7 @@ void AbstractWriteLog<I>::perf_start(std::string name) {
 
   plb.add_u64_counter(l_librbd_pwl_internal_flush, "internal_flush", "Flush RWL (write back to OSD)");
   plb.add_time_avg(l_librbd_pwl_writeback_latency, "writeback_lat", "write back to OSD latency");
+  plb.add_u64_counter(l_librbd_pwl_writeback_coalesced, "writeback_coalesced", "Log entries written back as part of a larger write");
   plb.add_u64_counter(l_librbd_pwl_invalidate_cache, "invalidate", "Invalidate RWL");
   plb.add_u64_counter(l_librbd_pwl_invalidate_discard_cache, "discard", "Discard and invalidate RWL");
 
@@ -1662,15 +1667,13 @@ bool AbstractWriteLog<I>::can_flush_entry(std::shared_ptr<GenericLogEntry> log_e
   }
 
   return (log_entry->can_writeback() &&
-         (m_flush_ops_in_flight <= IN_FLIGHT_FLUSH_WRITE_LIMIT) &&
-         (m_flush_bytes_in_flight <= IN_FLIGHT_FLUSH_BYTES_LIMIT));
+         (m_flush_ops_in_flight <= m_max_flush_ops) &&
+         (m_flush_bytes_in_flight <= m_max_flush_bytes));
 }
 
 template <typename I>
 void AbstractWriteLog<I>::detain_flush_guard_request(std::shared_ptr<GenericLogEntry> log_entry,
 						     GuardedRequestFunctionContext *guarded_ctx) {
-  ldout(m_image_ctx.cct, 20) << dendl;
-
   BlockExtent extent;
   if (log_entry->is_sync_point()) {
     extent = block_extent(whole_volume_extent());
@@ -1678,6 +1681,14 @@ void AbstractWriteLog<I>::detain_flush_guard_request(std::shared_ptr<GenericLogE
     extent = log_entry->ram_entry.block_extent();
   }
 
+  detain_flush_guard_request(extent, guarded_ctx);
+}
+
+template <typename I>
+void AbstractWriteLog<I>::detain_flush_guard_request(const BlockExtent &extent,
+						     GuardedRequestFunctionContext *guarded_ctx) {
+  ldout(m_image_ctx.cct, 20) << dendl;
+
   auto req = GuardedRequest(extent, guarded_ctx, false);
   BlockGuardCell *cell = nullptr;
 
@@ -1694,12 +1705,23 @@ void AbstractWriteLog<I>::detain_flush_guard_request(std::shared_ptr<GenericLogE
 template <typename I>
 Context* AbstractWriteLog<I>::construct_flush_entry(std::shared_ptr<GenericLogEntry> log_entry,
                                                       bool invalidating) {
+  return construct_flush_entry(GenericLogEntries{log_entry}, invalidating);
+}
+
+/*
+ * Builds the completion for a single write back covering all of log_entries.
+ * The flush guard cell must be held by the first entry.
+ */
+template <typename I>
+Context* AbstractWriteLog<I>::construct_flush_entry(const GenericLogEntries &log_entries,
+                                                      bool invalidating) {
   ldout(m_image_ctx.cct, 20) << "" << dendl;
+  ceph_assert(!log_entries.empty());
 
   /* Flush write completion action */
   utime_t writeback_start_time = ceph_clock_now();
   Context *ctx = new LambdaContext(
-    [this, log_entry, writeback_start_time, invalidating](int r) {
+    [this, log_entries, writeback_start_time, invalidating](int r) {
       utime_t writeback_comp_time = ceph_clock_now();
       m_perfcounter->tinc(l_librbd_pwl_writeback_latency,
                           writeback_comp_time - writeback_start_time);
@@ -1708,24 +1730,31 @@ Context* AbstractWriteLog<I>::construct_flush_entry(std::shared_ptr<GenericLogEn
         if (r < 0) {
           lderr(m_image_ctx.cct) << "failed to flush log entry"
                                  << cpp_strerror(r) << dendl;
-          m_dirty_log_entries.push_front(log_entry);
+          /* Requeue in log order */
+          for (auto it = log_entries.rbegin(); it != log_entries.rend(); ++it) {
+            m_dirty_log_entries.push_front(*it);
+          }
         } else {
-          ceph_assert(m_bytes_dirty >= log_entry->bytes_dirty());
-          log_entry->set_flushed(true);
-          m_bytes_dirty -= log_entry->bytes_dirty();
-          sync_point_writer_flushed(log_entry->get_sync_point_entry());
-          ldout(m_image_ctx.cct, 20) << "flushed: " << log_entry
-                                     << " invalidating=" << invalidating
-                                     << dendl;
+          for (auto &log_entry : log_entries) {
+            ceph_assert(m_bytes_dirty >= log_entry->bytes_dirty());
+            log_entry->set_flushed(true);
+            m_bytes_dirty -= log_entry->bytes_dirty();
+            sync_point_writer_flushed(log_entry->get_sync_point_entry());
+            ldout(m_image_ctx.cct, 20) << "flushed: " << log_entry
+                                       << " invalidating=" << invalidating
+                                       << dendl;
+          }
+        }
+        for (auto &log_entry : log_entries) {
+          m_flush_ops_in_flight -= 1;
+          m_flush_bytes_in_flight -= log_entry->ram_entry.write_bytes;
         }
-        m_flush_ops_in_flight -= 1;
-        m_flush_bytes_in_flight -= log_entry->ram_entry.write_bytes;
         wake_up();
       }
     });
   /* Flush through lower cache before completing */
   ctx = new LambdaContext(
-    [this, ctx, log_entry](int r) {
+    [this, ctx, log_entry=log_entries.front()](int r) {
       {
 
         WriteLogGuard::BlockOperations block_reqs;
@@ -1758,7 +1787,7 @@ template <typename I>
 void AbstractWriteLog<I>::process_writeback_dirty_entries() {
   CephContext *cct = m_image_ctx.cct;
   bool all_clean = false;
-  int flushed = 0;
+  uint64_t flushed = 0;
   bool has_write_entry = false;
   bool need_update_state = false;
 
@@ -1769,7 +1798,7 @@ void AbstractWriteLog<I>::process_writeback_dirty_entries() {
 
     std::shared_lock entry_reader_locker(m_entry_reader_lock);
     std::lock_guard locker(m_lock);
-    while (flushed < IN_FLIGHT_FLUSH_WRITE_LIMIT) {
+    while (flushed < m_max_flush_ops) {
       if (m_shutting_down) {
         ldout(cct, 5) << "Flush during shutdown suppressed" << dendl;
         /* Do flush complete only when all flush ops are finished */
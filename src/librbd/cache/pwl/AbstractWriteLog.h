@@ -203,8 +203,12 @@ private:
   std::shared_ptr<pwl::SyncPoint> m_current_sync_point = nullptr;
   bool m_persist_on_flush = false; //If false, persist each write before completion
 
-  int m_flush_ops_in_flight = 0;
-  int m_flush_bytes_in_flight = 0;
+  /* Limits on log entries being written back to the image */
+  const uint64_t m_max_flush_ops;
+  const uint64_t m_max_flush_bytes;
+
+  uint64_t m_flush_ops_in_flight = 0;
+  uint64_t m_flush_bytes_in_flight = 0;
   uint64_t m_lowest_flushing_sync_gen = 0;
 
   /* Writes that have left the block guard, but are waiting for resources */
@@ -346,8 +350,12 @@ protected:
       std::shared_ptr<pwl::GenericLogEntry> log_entry) = 0;
   Context *construct_flush_entry(
       const std::shared_ptr<pwl::GenericLogEntry> log_entry, bool invalidating);
+  Context *construct_flush_entry(
+      const pwl::GenericLogEntries &log_entries, bool invalidating);
   void detain_flush_guard_request(std::shared_ptr<GenericLogEntry> log_entry,
                                   GuardedRequestFunctionContext *guarded_ctx);
+  void detain_flush_guard_request(const BlockExtent &extent,
+                                  GuardedRequestFunctionContext *guarded_ctx);
   void process_writeback_dirty_entries();
   bool can_retire_entry(const std::shared_ptr<pwl::GenericLogEntry> log_entry);
 
@@ -596,23 +596,46 @@ void WriteLog<I>::construct_flush_entries(pwl::GenericLogEntries entries_to_flus
     }
 
     Context *ctx = new LambdaContext(
-      [this, entries_to_flush, read_bls](int r) {
-        int i = 0;
-	GuardedRequestFunctionContext *guarded_ctx = nullptr;
-
-	for (auto &log_entry : entries_to_flush) {
-	  if (log_entry->is_write_entry()) {
-	    bufferlist captured_entry_bl;
-	    captured_entry_bl.claim_append(*read_bls[i]);
-	    delete read_bls[i++];
+      [this, entries_to_flush, read_bls](int r) mutable {
+        std::list<FlushGroup> groups;
+        coalesce_flush_entries(m_image_ctx.layout.stripe_unit,
+                               entries_to_flush, read_bls, &groups);
+
+        for (auto &group : groups) {
+          GuardedRequestFunctionContext *guarded_ctx = nullptr;
+          auto log_entry = group.log_entries.front();
+
+          if (group.log_entries.size() > 1) {
+            this->m_perfcounter->inc(l_librbd_pwl_writeback_coalesced,
+                                     group.log_entries.size());
+            guarded_ctx = new GuardedRequestFunctionContext(
+              [this, log_entries=group.log_entries, offset=group.offset,
+               length=group.length, group_bl=std::move(group.bl)]
+              (GuardedRequestFunctionContext &guard_ctx) {
+                log_entries.front()->m_cell = guard_ctx.cell;
+                Context *ctx = this->construct_flush_entry(log_entries, false);
 
-	    guarded_ctx = new GuardedRequestFunctionContext([this, log_entry, captured_entry_bl]
+                m_image_ctx.op_work_queue->queue(new LambdaContext(
+                  [this, offset, length, bl=group_bl, ctx](int r) mutable {
+                    ldout(m_image_ctx.cct, 15) << "flushing coalesced: "
+                                               << offset << "~" << length
+                                               << dendl;
+                    this->m_image_writeback.aio_write({{offset, length}},
+                                                      std::move(bl), 0, ctx);
+                  }), 0);
+              });
+            this->detain_flush_guard_request(
+              block_extent(io::Extent{group.offset, group.length}),
+              guarded_ctx);
+	  } else if (log_entry->is_write_entry()) {
+	    guarded_ctx = new GuardedRequestFunctionContext(
+              [this, log_entry, captured_entry_bl=std::move(group.bl)]
               (GuardedRequestFunctionContext &guard_ctx) {
                 log_entry->m_cell = guard_ctx.cell;
                 Context *ctx = this->construct_flush_entry(log_entry, false);
 
 	        m_image_ctx.op_work_queue->queue(new LambdaContext(
-	          [this, log_entry, entry_bl=std::move(captured_entry_bl), ctx](int r) {
+	          [this, log_entry, entry_bl=captured_entry_bl, ctx](int r) {
 		    auto captured_entry_bl = std::move(entry_bl);
 		    ldout(m_image_ctx.cct, 15) << "flushing:" << log_entry
 			                       << " " << *log_entry << dendl;
@@ -620,6 +643,7 @@ void WriteLog<I>::construct_flush_entries(pwl::GenericLogEntries entries_to_flus
                                             std::move(captured_entry_bl));
 	          }), 0);
 	      });
+            this->detain_flush_guard_request(log_entry, guarded_ctx);
 	  } else {
 	    guarded_ctx = new GuardedRequestFunctionContext([this, log_entry]
               (GuardedRequestFunctionContext &guard_ctx) {
@@ -632,8 +656,8 @@ void WriteLog<I>::construct_flush_entries(pwl::GenericLogEntries entries_to_flus
 		    log_entry->writeback(this->m_image_writeback, ctx);
 		  }), 0);
             });
+            this->detain_flush_guard_request(log_entry, guarded_ctx);
 	  }
-          this->detain_flush_guard_request(log_entry, guarded_ctx);
 	}
       });
 
@@ -641,6 +665,104 @@ void WriteLog<I>::construct_flush_entries(pwl::GenericLogEntries entries_to_flus
   }
 }
 
+/*
+ * Groups the dirty entries of a flush batch into write backs.  Plain writes
+ * that overlap or abut within one stripe unit (and so one object) are merged
+ * into a single write, later entries overlaying earlier ones.  A batch never
+ * spans a sync point, so only the relative order of overlapping entries has
+ * to be preserved: a group is closed as soon as an entry it cannot absorb
+ * overlaps it, and groups are detained in the flush guard in creation order.
+ * Growing a group moves data back in that order, so an entry is only merged
+ * when the grown group overlaps none of the groups created after it.
+ */
+template <typename I>
+void WriteLog<I>::coalesce_flush_entries(
+    uint64_t stripe_unit, const pwl::GenericLogEntries &entries_to_flush,
+    std::vector<bufferlist *> &read_bls, std::list<FlushGroup> *groups) {
+  std::map<uint64_t, FlushGroup*> open_groups;
+  unsigned int i = 0;
+
+  for (auto &log_entry : entries_to_flush) {
+    bufferlist entry_bl;
+    bool mergeable = false;
+    if (log_entry->is_write_entry()) {
+      entry_bl.claim_append(*read_bls[i]);
+      delete read_bls[i++];
+      mergeable = !log_entry->is_writesame_entry();
+    }
+
+    bool whole_volume = log_entry->is_sync_point();
+    uint64_t offset = log_entry->ram_entry.image_offset_bytes;
+    uint64_t length = log_entry->ram_entry.write_bytes;
+    uint64_t end = offset + length;
+    uint64_t unit = 0;
+    if (mergeable && stripe_unit > 0) {
+      unit = offset / stripe_unit;
+      mergeable = (end <= (unit + 1) * stripe_unit);
+    } else {
+      mergeable = false;
+    }
+
+    if (mergeable) {
+      auto it = open_groups.find(unit);
+      if (it != open_groups.end()) {
+        auto group = it->second;
+        uint64_t group_end = group->offset + group->length;
+        uint64_t grown_offset = std::min(offset, group->offset);
+        uint64_t grown_end = std::max(end, group_end);
+        bool overtakes = false;
+        for (auto later = groups->rbegin(); &*later != group; ++later) {
+          if (grown_offset < later->offset + later->length &&
+              later->offset < grown_end) {
+            overtakes = true;
+            break;
+          }
+        }
+        if (!overtakes && offset <= group_end && end >= group->offset) {
+          bufferlist bl;
+          if (offset > group->offset) {
+            bufferlist head;
+            head.substr_of(group->bl, 0, offset - group->offset);
+            bl.claim_append(head);
+          }
+          bl.claim_append(entry_bl);
+          if (group_end > end) {
+            bufferlist tail;
+            tail.substr_of(group->bl, end - group->offset, group_end - end);
+            bl.claim_append(tail);
+          }
+
+          group->bl = std::move(bl);
+          group->offset = std::min(group->offset, offset);
+          group->length = std::max(group_end, end) - group->offset;
+          group->log_entries.push_back(log_entry);
+          continue;
+        }
+      }
+    }
+
+    for (auto it = open_groups.begin(); it != open_groups.end(); ) {
+      auto group = it->second;
+      if (whole_volume || (mergeable && it->first == unit) ||
+          (offset < group->offset + group->length && group->offset < end)) {
+        it = open_groups.erase(it);
+      } else {
+        ++it;
+      }
+    }
+
+    auto &group = groups->emplace_back();
+    group.log_entries.push_back(log_entry);
+    group.offset = offset;
+    group.length = length;
+    group.bl = std::move(entry_bl);
+    if (mergeable) {
+      open_groups[unit] = &group;
+    }
+  }
+  ceph_assert(i == read_bls.size());
+}
+
 template <typename I>
 void WriteLog<I>::process_work() {
   CephContext *cct = m_image_ctx.cct;
@@ -54,6 +54,18 @@ public:
       C_BlockIORequestT *req) override;
   void complete_user_request(Context *&user_req, int r) override;
 
+  /* Dirty log entries written back to the image with a single request */
+  struct FlushGroup {
+    pwl::GenericLogEntries log_entries;
+    uint64_t offset = 0;
+    uint64_t length = 0;
+    bufferlist bl;
+  };
+
+  static void coalesce_flush_entries(
+      uint64_t stripe_unit, const pwl::GenericLogEntries &entries_to_flush,
+      std::vector<bufferlist *> &read_bls, std::list<FlushGroup> *groups);
+
 protected:
   using AbstractWriteLog<ImageCtxT>::m_lock;
   using AbstractWriteLog<ImageCtxT>::m_log_entries;
@@ -152,14 +152,17 @@ void ImageCopyRequest<I>::send_object_copies() {
   bool complete;
   {
     std::lock_guard locker{m_lock};
-    auto max_ops = m_src_image_ctx->config.template get_val<uint64_t>(
+    m_min_ops = m_src_image_ctx->config.template get_val<uint64_t>(
       "rbd_concurrent_management_ops");
+    m_max_ops = m_min_ops;
+    m_max_ops_limit = std::max(
+      m_min_ops, m_src_image_ctx->config.template get_val<uint64_t>(
+        "rbd_deep_copy_max_concurrent_ops"));
+    m_window_start = TypeTraits<I>::Clock::now();
 
     // attempt to schedule at least 'max_ops' initial requests where
     // some objects might be skipped if fast-diff notes no change
-    for (uint64_t i = 0; i < max_ops; i++) {
-      send_next_object_copy();
-    }
+    send_next_object_copies();
 
     complete = (m_current_ops == 0) && !m_updating_progress;
   }
@@ -170,7 +173,15 @@ void ImageCopyRequest<I>::send_object_copies() {
 }
 
 template <typename I>
-void ImageCopyRequest<I>::send_next_object_copy() {
+void ImageCopyRequest<I>::send_next_object_copies() {
+  ceph_assert(ceph_mutex_is_locked(m_lock));
+
+  while (m_current_ops < m_max_ops && send_next_object_copy()) {
+  }
+}
+
+template <typename I>
+bool ImageCopyRequest<I>::send_next_object_copy() {
   ceph_assert(ceph_mutex_is_locked(m_lock));
 
   if (m_canceled && m_ret_val == 0) {
@@ -179,14 +190,10 @@ void ImageCopyRequest<I>::send_next_object_copy() {
   }
 
   if (m_ret_val < 0 || m_object_no >= m_end_object_no) {
-    return;
+    return false;
   }
 
   uint64_t ono = m_object_no++;
-  Context *ctx = new LambdaContext(
-    [this, ono](int r) {
-      handle_object_copy(ono, r);
-    });
 
   ldout(m_cct, 20) << "object_num=" << ono << dendl;
   ++m_current_ops;
@@ -213,11 +220,20 @@ void ImageCopyRequest<I>::send_next_object_copy() {
 
     if (object_diff_state == object_map::DIFF_STATE_HOLE) {
       ldout(m_cct, 20) << "skipping non-existent object " << ono << dendl;
+      Context *ctx = new LambdaContext(
+        [this, ono](int r) {
+          handle_object_copy(ono, false, r);
+        });
       create_async_context_callback(*m_src_image_ctx, ctx)->complete(0);
-      return;
+      return true;
     }
   }
 
+  Context *ctx = new LambdaContext(
+    [this, ono](int r) {
+      handle_object_copy(ono, true, r);
+    });
+
   uint32_t flags = 0;
   if (m_flatten) {
     flags |= OBJECT_COPY_REQUEST_FLAG_FLATTEN;
@@ -231,10 +247,12 @@ void ImageCopyRequest<I>::send_next_object_copy() {
     m_src_image_ctx, m_dst_image_ctx, m_src_snap_id_start, m_dst_snap_id_start,
     m_snap_map, ono, flags, m_handler, ctx);
   req->send();
+  return true;
 }
 
 template <typename I>
-void ImageCopyRequest<I>::handle_object_copy(uint64_t object_no, int r) {
+void ImageCopyRequest<I>::handle_object_copy(uint64_t object_no, bool copied,
+                                             int r) {
   ldout(m_cct, 20) << "object_no=" << object_no << ", r=" << r << dendl;
 
   bool complete;
@@ -265,7 +283,10 @@ void ImageCopyRequest<I>::handle_object_copy(uint64_t object_no, int r) {
       }
     }
 
-    send_next_object_copy();
+    if (copied) {
+      update_max_ops();
+    }
+    send_next_object_copies();
     complete = (m_current_ops == 0) && !m_updating_progress;
   }
 
@@ -274,6 +295,47 @@ void ImageCopyRequest<I>::handle_object_copy(uint64_t object_no, int r) {
   }
 }
 
+template <typename I>
+void ImageCopyRequest<I>::update_max_ops() {
+  ceph_assert(ceph_mutex_is_locked(m_lock));
+
+  if (m_max_ops_limit == m_min_ops || ++m_window_copies < m_max_ops) {
+    return;
+  }
+
+  // probe upwards while more concurrency still pays off and back off
+  // once the link or the OSDs are saturated
+  auto now = TypeTraits<I>::Clock::now();
+  double elapsed = std::chrono::duration<double>(now - m_window_start).count();
+  double rate = m_window_copies / std::max(elapsed, 0.001);
+  int step = 0;
+  if (m_window_rate == 0) {
+    // first window: only the baseline to judge later windows against
+  } else if (rate > m_window_rate * 1.05) {
+    // the last change paid off, keep going (upwards after a hold)
+    step = m_window_step < 0 ? -1 : 1;
+  } else if (rate < m_window_rate * 0.95) {
+    // the last change made things worse, undo it
+    step = -m_window_step;
+  } else if (m_window_step == 0) {
+    // steady for two windows at this concurrency, try a step up
+    step = 1;
+  }
+
+  if (step > 0) {
+    m_max_ops = std::min(m_max_ops + m_min_ops, m_max_ops_limit);
+  } else if (step < 0) {
+    m_max_ops = std::max(m_max_ops - m_min_ops, m_min_ops);
+  }
+
+  ldout(m_cct, 15) << "copy rate=" << rate << " objects/s, "
+                   << "max_ops=" << m_max_ops << dendl;
+  m_window_start = now;
+  m_window_copies = 0;
+  m_window_rate = rate;
+  m_window_step = step;
+}
+
 template <typename I>
 void ImageCopyRequest<I>::finish(int r) {
   ldout(m_cct, 20) << "r=" << r << dendl;
@@ -10,6 +10,7 @@
 #include "common/ceph_mutex.h"
 #include "common/RefCountedObj.h"
 #include "librbd/Types.h"
+#include "librbd/deep_copy/TypeTraits.h"
 #include "librbd/deep_copy/Types.h"
 #include <functional>
 #include <map>
@@ -95,6 +96,17 @@ private:
   uint64_t m_object_no = 0;
   uint64_t m_end_object_no = 0;
   uint64_t m_current_ops = 0;
+
+  // object copy concurrency, adjusted within [m_min_ops, m_max_ops_limit]
+  // by comparing the copy rate of consecutive windows
+  uint64_t m_min_ops = 0;
+  uint64_t m_max_ops = 0;
+  uint64_t m_max_ops_limit = 0;
+  typename TypeTraits<ImageCtxT>::Clock::time_point m_window_start;
+  uint64_t m_window_copies = 0;
+  double m_window_rate = 0;
+  int m_window_step = 0;  // direction m_max_ops last moved in
+
   std::priority_queue<
     uint64_t, std::vector<uint64_t>, std::greater<uint64_t>> m_copied_objects;
   bool m_updating_progress = false;
@@ -109,8 +121,10 @@ private:
   void handle_compute_diff(int r);
 
   void send_object_copies();
-  void send_next_object_copy();
-  void handle_object_copy(uint64_t object_no, int r);
+  void send_next_object_copies();
+  bool send_next_object_copy();
+  void handle_object_copy(uint64_t object_no, bool copied, int r);
+  void update_max_ops();
 
   void finish(int r);
 };
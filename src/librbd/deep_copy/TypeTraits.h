@@ -0,0 +1,20 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
+// vim: ts=8 sw=2 sts=2 expandtab
+
+#ifndef CEPH_LIBRBD_DEEP_COPY_TYPE_TRAITS_H
+#define CEPH_LIBRBD_DEEP_COPY_TYPE_TRAITS_H
+
+#include "common/ceph_time.h"
+
+namespace librbd {
+namespace deep_copy {
+
+template <typename ImageCtxT>
+struct TypeTraits {
+  typedef ceph::mono_clock Clock;
+};
+
+} // namespace deep_copy
+} // namespace librbd
+
+#endif // CEPH_LIBRBD_DEEP_COPY_TYPE_TRAITS_H
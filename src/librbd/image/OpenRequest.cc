@@ -14,6 +14,7 @@
 #include "librbd/image/CloseRequest.h"
 #include "librbd/image/RefreshRequest.h"
 #include "librbd/image/SetSnapRequest.h"
+#include "librbd/io/ReadaheadImageDispatch.h"
 #include "librbd/io/SimpleSchedulerObjectDispatch.h"
 #include <boost/algorithm/string/predicate.hpp>
 #include "include/ceph_assert.h"
@@ -561,6 +562,7 @@ template <typename I>
 Context *OpenRequest<I>::send_init_cache(int *result) {
   if (!m_image_ctx->cache || m_image_ctx->child != nullptr ||
       !m_image_ctx->data_ctx.is_valid()) {
+    init_readahead();
     return send_register_watch(result);
   }
 
@@ -579,6 +581,7 @@ Context *OpenRequest<I>::send_init_cache(int *result) {
     cache->init();
 
     m_image_ctx->readahead.set_max_readahead_size(0);
+    init_readahead();
   } else if (cache_policy == "writethrough" || cache_policy == "writeback") {
     if (cache_policy == "writethrough") {
       max_dirty = 0;
@@ -597,6 +600,26 @@ Context *OpenRequest<I>::send_init_cache(int *result) {
   return send_register_watch(result);
 }
 
+template <typename I>
+void OpenRequest<I>::init_readahead() {
+  // without the object cacher, readahead is handled at the image level
+  if (m_image_ctx->child != nullptr || !m_image_ctx->data_ctx.is_valid() ||
+      m_image_ctx->config.template get_val<uint64_t>(
+        "rbd_readahead_streams") == 0 ||
+      m_image_ctx->config.template get_val<Option::size_t>(
+        "rbd_readahead_max_bytes") == 0 ||
+      m_image_ctx->config.template get_val<Option::size_t>(
+        "rbd_readahead_buffer_size") == 0) {
+    return;
+  }
+
+  CephContext *cct = m_image_ctx->cct;
+  ldout(cct, 10) << this << " " << __func__ << dendl;
+
+  auto readahead = io::ReadaheadImageDispatch<I>::create(m_image_ctx);
+  readahead->init();
+}
+
 template <typename I>
 Context *OpenRequest<I>::send_register_watch(int *result) {
   if ((m_image_ctx->read_only_flags & IMAGE_READ_ONLY_FLAG_USER) != 0U) {
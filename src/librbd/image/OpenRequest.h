@@ -127,6 +127,7 @@ private:
   Context* handle_init_plugin_registry(int *result);
 
   Context *send_init_cache(int *result);
+  void init_readahead();
 
   Context *send_register_watch(int *result);
   Context *handle_register_watch(int *result);
@@ -8,11 +8,14 @@
 #include "include/Context.h"
 #include "common/ceph_mutex.h"
 #include "common/dout.h"
+#include "common/sharded_shared_mutex.h"
 #include "common/AsyncOpTracker.h"
 #include "librbd/Utils.h"
 #include "librbd/io/DispatcherInterface.h"
 #include "librbd/io/Types.h"
+#include <algorithm>
 #include <map>
+#include <thread>
 
 #define dout_subsys ceph_subsys_rbd
 #undef dout_prefix
@@ -31,9 +34,9 @@ public:
 
   Dispatcher(ImageCtxT* image_ctx)
     : m_image_ctx(image_ctx),
-      m_lock(ceph::make_shared_mutex(
-        librbd::util::unique_lock_name("librbd::io::Dispatcher::lock",
-                                       this))) {
+      m_lock(librbd::util::unique_lock_name("librbd::io::Dispatcher::lock",
+                                            this),
+             std::clamp(std::thread::hardware_concurrency(), 1u, 16u)) {
   }
 
   virtual ~Dispatcher() {
@@ -153,7 +156,11 @@ protected:
 
   ImageCtxT* m_image_ctx;
 
-  ceph::shared_mutex m_lock;
+  // every IO takes this for read once per layer it passes through, while
+  // layers are (un)registered only when the image is opened, closed or
+  // reconfigured.  sharding the read side keeps IO threads from contending
+  // on it.
+  ceph::sharded_shared_mutex m_lock;
   std::map<DispatchLayer, DispatchMeta> m_dispatches;
 
   virtual bool send_dispatch(Dispatch* dispatch,
@@ -0,0 +1,685 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
+// vim: ts=8 sw=2 sts=2 expandtab
+
+#include "librbd/io/ReadaheadImageDispatch.h"
+#include "common/dout.h"
+#include "common/errno.h"
+#include "common/perf_counters.h"
+#include "common/Readahead.h"
+#include "include/rados/librados.hpp"
+#include "librbd/ExclusiveLock.h"
+#include "librbd/ImageCtx.h"
+#include "librbd/Utils.h"
+#include "librbd/io/AioCompletion.h"
+#include "librbd/io/ImageDispatchSpec.h"
+#include "librbd/io/ImageDispatcherInterface.h"
+#include <algorithm>
+
+#define dout_subsys ceph_subsys_rbd
+#undef dout_prefix
+#define dout_prefix *_dout << "librbd::io::ReadaheadImageDispatch: " \
+                           << this << " " << __func__ << ": "
+
+namespace librbd {
+namespace io {
+
+template <typename I>
+struct ReadaheadImageDispatch<I>::C_PrefetchRead : public Context {
+  ReadaheadImageDispatch* dispatch;
+  BufferRef buffer;
+  bufferlist bl;
+
+  C_PrefetchRead(ReadaheadImageDispatch* dispatch, const BufferRef& buffer)
+    : dispatch(dispatch), buffer(buffer) {
+  }
+
+  void finish(int r) override {
+    dispatch->handle_prefetch(buffer, r, std::move(bl));
+  }
+};
+
+template <typename I>
+struct ReadaheadImageDispatch<I>::C_BufferedRead : public Context {
+  ReadaheadImageDispatch* dispatch;
+  AioCompletion* aio_comp;
+  uint64_t offset;
+  uint64_t length;
+  ReadResult* read_result;
+  DispatchResult* dispatch_result;
+  Context* on_dispatched;
+  BufferRefs buffers;
+
+  // one reference for the dispatching thread plus one per buffer that is
+  // still being prefetched
+  std::atomic<uint32_t> pending = {1};
+
+  C_BufferedRead(ReadaheadImageDispatch* dispatch, AioCompletion* aio_comp,
+                 uint64_t offset, uint64_t length, ReadResult* read_result,
+                 DispatchResult* dispatch_result, Context* on_dispatched,
+                 BufferRefs&& buffers)
+    : dispatch(dispatch), aio_comp(aio_comp), offset(offset), length(length),
+      read_result(read_result), dispatch_result(dispatch_result),
+      on_dispatched(on_dispatched), buffers(std::move(buffers)) {
+  }
+
+  void complete(int r) override {
+    if (--pending == 0) {
+      dispatch->complete_buffered_read(this);
+      delete this;
+    }
+  }
+
+  void finish(int r) override {
+  }
+};
+
+template <typename I>
+ReadaheadImageDispatch<I>::ReadaheadImageDispatch(I* image_ctx)
+  : m_image_ctx(image_ctx),
+    m_max_streams(std::max<uint64_t>(
+      1, image_ctx->config.template get_val<uint64_t>(
+        "rbd_readahead_streams"))),
+    m_max_buffered_bytes(image_ctx->config.template get_val<Option::size_t>(
+      "rbd_readahead_buffer_size")),
+    m_trigger_requests(image_ctx->config.template get_val<uint64_t>(
+      "rbd_readahead_trigger_requests")),
+    m_max_readahead_bytes(image_ctx->config.template get_val<Option::size_t>(
+      "rbd_readahead_max_bytes")),
+    m_lock(ceph::make_mutex(util::unique_lock_name(
+      "librbd::io::ReadaheadImageDispatch::m_lock", this))) {
+  auto cct = m_image_ctx->cct;
+  ldout(cct, 5) << "ictx=" << image_ctx << dendl;
+
+  // same alignments as the object cacher readahead
+  auto& layout = m_image_ctx->layout;
+  m_alignments.push_back(
+    static_cast<uint64_t>(layout.stripe_count) * layout.object_size);
+  m_alignments.push_back(
+    static_cast<uint64_t>(layout.stripe_unit) * layout.stripe_count);
+  m_alignments.push_back(layout.stripe_unit);
+
+  m_streams.reserve(m_max_streams);
+}
+
+template <typename I>
+ReadaheadImageDispatch<I>::~ReadaheadImageDispatch() {
+  ceph_assert(m_in_flight_writes.empty());
+}
+
+template <typename I>
+void ReadaheadImageDispatch<I>::init() {
+  auto cct = m_image_ctx->cct;
+  ldout(cct, 5) << dendl;
+
+  m_image_ctx->io_image_dispatcher->register_dispatch(this);
+}
+
+template <typename I>
+void ReadaheadImageDispatch<I>::shut_down(Context* on_finish) {
+  auto cct = m_image_ctx->cct;
+  ldout(cct, 5) << dendl;
+
+  {
+    std::lock_guard locker{m_lock};
+    while (!m_buffers.empty()) {
+      invalidate_buffer(m_buffers.begin()->second);
+    }
+    m_streams.clear();
+  }
+
+  m_async_op_tracker.wait_for_ops(on_finish);
+}
+
+template <typename I>
+bool ReadaheadImageDispatch<I>::read(
+    AioCompletion* aio_comp, Extents &&image_extents, ReadResult &&read_result,
+    IOContext io_context, int op_flags, int read_flags,
+    const ZTracer::Trace &parent_trace, uint64_t tid,
+    std::atomic<uint32_t>* image_dispatch_flags,
+    DispatchResult* dispatch_result, Context** on_finish,
+    Context* on_dispatched) {
+  if (*image_dispatch_flags & IMAGE_DISPATCH_FLAG_CRYPTO_HEADER) {
+    return false;
+  }
+
+  auto cct = m_image_ctx->cct;
+  ldout(cct, 20) << "tid=" << tid << ", image_extents=" << image_extents
+                 << dendl;
+
+  // other clients may write to the image unless we own the lock, and
+  // releasing it invalidates the buffers.  a release racing with this
+  // read bumps the generation before we get to add any
+  uint64_t generation;
+  {
+    std::lock_guard locker{m_lock};
+    generation = m_generation;
+  }
+  {
+    std::shared_lock owner_locker{m_image_ctx->owner_lock};
+    if (m_image_ctx->exclusive_lock == nullptr ||
+        !m_image_ctx->exclusive_lock->is_lock_owner()) {
+      return false;
+    }
+  }
+
+  // only simple, single extent reads are tracked as part of a stream
+  if (image_extents.size() != 1 || image_extents.front().second == 0) {
+    return false;
+  }
+
+  auto [offset, length] = image_extents.front();
+  auto snap_id = io_context->get_read_snap();
+
+  auto disable_after_bytes = m_image_ctx->readahead_disable_after_bytes;
+  auto total_bytes_read = m_total_bytes_read.fetch_add(length);
+  bool detect = ((op_flags & LIBRADOS_OP_FLAG_FADVISE_RANDOM) == 0 &&
+                 (disable_after_bytes == 0 ||
+                  total_bytes_read <= disable_after_bytes));
+
+  uint64_t data_size = 0;
+  if (detect) {
+    std::shared_lock image_locker{m_image_ctx->image_lock};
+    data_size = m_image_ctx->get_area_size(ImageArea::DATA);
+  }
+
+  BufferRefs prefetches;
+  C_BufferedRead* req = nullptr;
+  {
+    std::lock_guard locker{m_lock};
+    if (generation != m_generation) {
+      ldout(cct, 20) << "cache invalidated, not buffering" << dendl;
+      return false;
+    }
+
+    if (detect) {
+      update_streams(snap_id, offset, length, data_size, &prefetches);
+    }
+
+    BufferRefs buffers;
+    if (get_buffers(snap_id, offset, length, &buffers)) {
+      req = new C_BufferedRead(this, aio_comp, offset, length, &read_result,
+                               dispatch_result, on_dispatched,
+                               std::move(buffers));
+      for (auto& buffer : req->buffers) {
+        if (!buffer->ready) {
+          ++req->pending;
+          buffer->waiters.push_back(req);
+        }
+      }
+    }
+  }
+
+  prefetch(io_context, prefetches);
+
+  if (req == nullptr) {
+    m_image_ctx->perfcounter->inc(l_librbd_readahead_miss);
+    return false;
+  }
+
+  // resumes through the remaining layers if the buffered data is lost
+  *dispatch_result = DISPATCH_RESULT_CONTINUE;
+  req->complete(0);
+  return true;
+}
+
+template <typename I>
+bool ReadaheadImageDispatch<I>::write(
+    AioCompletion* aio_comp, Extents &&image_extents, bufferlist &&bl,
+    int op_flags, const ZTracer::Trace &parent_trace,
+    uint64_t tid, std::atomic<uint32_t>* image_dispatch_flags,
+    DispatchResult* dispatch_result, Context** on_finish,
+    Context* on_dispatched) {
+  auto cct = m_image_ctx->cct;
+  ldout(cct, 20) << "tid=" << tid << ", image_extents=" << image_extents
+                 << dendl;
+
+  return handle_write(tid, image_extents, image_dispatch_flags, on_finish);
+}
+
+template <typename I>
+bool ReadaheadImageDispatch<I>::discard(
+    AioCompletion* aio_comp, Extents &&image_extents,
+    uint32_t discard_granularity_bytes, const ZTracer::Trace &parent_trace,
+    uint64_t tid, std::atomic<uint32_t>* image_dispatch_flags,
+    DispatchResult* dispatch_result, Context** on_finish,
+    Context* on_dispatched) {
+  auto cct = m_image_ctx->cct;
+  ldout(cct, 20) << "tid=" << tid << ", image_extents=" << image_extents
+                 << dendl;
+
+  return handle_write(tid, image_extents, image_dispatch_flags, on_finish);
+}
+
+template <typename I>
+bool ReadaheadImageDispatch<I>::write_same(
+    AioCompletion* aio_comp, Extents &&image_extents, bufferlist &&bl,
+    int op_flags, const ZTracer::Trace &parent_trace,
+    uint64_t tid, std::atomic<uint32_t>* image_dispatch_flags,
+    DispatchResult* dispatch_result, Context** on_finish,
+    Context* on_dispatched) {
+  auto cct = m_image_ctx->cct;
+  ldout(cct, 20) << "tid=" << tid << ", image_extents=" << image_extents
+                 << dendl;
+
+  return handle_write(tid, image_extents, image_dispatch_flags, on_finish);
+}
+
+template <typename I>
+bool ReadaheadImageDispatch<I>::compare_and_write(
+    AioCompletion* aio_comp, Extents &&image_extents,
+    bufferlist &&cmp_bl, bufferlist &&bl, uint64_t *mismatch_offset,
+    int op_flags, const ZTracer::Trace &parent_trace,
+    uint64_t tid, std::atomic<uint32_t>* image_dispatch_flags,
+    DispatchResult* dispatch_result, Context** on_finish,
+    Context* on_dispatched) {
+  auto cct = m_image_ctx->cct;
+  ldout(cct, 20) << "tid=" << tid << ", image_extents=" << image_extents
+                 << dendl;
+
+  return handle_write(tid, image_extents, image_dispatch_flags, on_finish);
+}
+
+template <typename I>
+bool ReadaheadImageDispatch<I>::invalidate_cache(Context* on_finish) {
+  auto cct = m_image_ctx->cct;
+  ldout(cct, 5) << dendl;
+
+  std::lock_guard locker{m_lock};
+  ++m_generation;
+  while (!m_buffers.empty()) {
+    invalidate_buffer(m_buffers.begin()->second);
+  }
+  m_streams.clear();
+  return false;
+}
+
+template <typename I>
+bool ReadaheadImageDispatch<I>::handle_write(
+    uint64_t tid, const Extents& image_extents,
+    const std::atomic<uint32_t>* image_dispatch_flags, Context** on_finish) {
+  if (*image_dispatch_flags & IMAGE_DISPATCH_FLAG_CRYPTO_HEADER) {
+    return false;
+  }
+
+  {
+    std::lock_guard locker{m_lock};
+    m_in_flight_writes[tid] = image_extents;
+    invalidate_buffers(image_extents);
+  }
+
+  // prefetches issued before the write completes could observe the old
+  // data, so the write is tracked until it is durable below this layer
+  *on_finish = new LambdaContext([this, tid, on_finish=*on_finish](int r) {
+      handle_write_finished(tid);
+      on_finish->complete(r);
+    });
+  return false;
+}
+
+template <typename I>
+void ReadaheadImageDispatch<I>::handle_write_finished(uint64_t tid) {
+  std::lock_guard locker{m_lock};
+  m_in_flight_writes.erase(tid);
+}
+
+template <typename I>
+bool ReadaheadImageDispatch<I>::get_buffers(
+    uint64_t snap_id, uint64_t offset, uint64_t length, BufferRefs* buffers) {
+  ceph_assert(ceph_mutex_is_locked_by_me(m_lock));
+
+  auto it = m_buffers.upper_bound(offset);
+  if (it == m_buffers.begin()) {
+    return false;
+  }
+  --it;
+
+  uint64_t end = offset + length;
+  uint64_t pos = offset;
+  while (pos < end) {
+    if (it == m_buffers.end() || it->first > pos) {
+      return false;
+    }
+
+    auto& buffer = it->second;
+    if (buffer->snap_id != snap_id ||
+        buffer->offset + buffer->length <= pos) {
+      return false;
+    }
+
+    buffers->push_back(buffer);
+    pos = buffer->offset + buffer->length;
+    ++it;
+  }
+  return true;
+}
+
+template <typename I>
+void ReadaheadImageDispatch<I>::update_streams(
+    uint64_t snap_id, uint64_t offset, uint64_t length, uint64_t data_size,
+    BufferRefs* prefetches) {
+  ceph_assert(ceph_mutex_is_locked_by_me(m_lock));
+
+  // a read continuing where a stream left off belongs to that stream,
+  // anything else starts a new one in place of the least recently used
+  Stream* stream = nullptr;
+  for (auto& s : m_streams) {
+    if (s.next_offset == offset) {
+      stream = &s;
+      break;
+    }
+  }
+
+  if (stream == nullptr) {
+    if (m_streams.size() < m_max_streams) {
+      stream = &m_streams.emplace_back();
+    } else {
+      stream = &*std::min_element(
+        m_streams.begin(), m_streams.end(),
+        [](const Stream& lhs, const Stream& rhs) {
+          return lhs.last_used < rhs.last_used;
+        });
+    }
+
+    stream->readahead = std::make_unique<Readahead>();
+    stream->readahead->set_trigger_requests(m_trigger_requests);
+    stream->readahead->set_max_readahead_size(m_max_readahead_bytes);
+    stream->readahead->set_alignments(m_alignments);
+  }
+
+  stream->next_offset = offset + length;
+  stream->last_used = ++m_stream_clock;
+
+  auto [readahead_offset, readahead_length] = stream->readahead->update(
+    offset, length, data_size);
+  if (readahead_length == 0) {
+    return;
+  }
+
+  auto cct = m_image_ctx->cct;
+  ldout(cct, 20) << "readahead " << readahead_offset << "~"
+                 << readahead_length << dendl;
+
+  // only prefetch the parts that are not buffered yet
+  uint64_t readahead_end = readahead_offset + readahead_length;
+  uint64_t pos = readahead_offset;
+  auto it = m_buffers.lower_bound(readahead_offset);
+  if (it != m_buffers.begin()) {
+    auto prev = std::prev(it);
+    pos = std::max(pos, prev->second->offset + prev->second->length);
+  }
+
+  while (pos < readahead_end) {
+    uint64_t gap_end = readahead_end;
+    if (it != m_buffers.end() && it->first < readahead_end) {
+      gap_end = it->first;
+    }
+
+    if (gap_end > pos) {
+      add_buffer(snap_id, pos, gap_end - pos, prefetches);
+    }
+
+    if (it == m_buffers.end() || it->first >= readahead_end) {
+      break;
+    }
+    pos = std::max(gap_end, it->second->offset + it->second->length);
+    ++it;
+  }
+}
+
+template <typename I>
+void ReadaheadImageDispatch<I>::add_buffer(
+    uint64_t snap_id, uint64_t offset, uint64_t length, BufferRefs* prefetches) {
+  ceph_assert(ceph_mutex_is_locked_by_me(m_lock));
+
+  uint64_t end = offset + length;
+  for (auto& [tid, image_extents] : m_in_flight_writes) {
+    for (auto& [write_offset, write_length] : image_extents) {
+      if (write_offset < end && offset < write_offset + write_length) {
+        return;
+      }
+    }
+  }
+
+  length = std::min(length, m_max_buffered_bytes);
+  if (length == 0 || !reserve_buffer_space(length)) {
+    return;
+  }
+
+  auto buffer = std::make_shared<Buffer>(offset, length, snap_id,
+                                         ++m_buffer_seq);
+  buffer->generation = m_generation;
+  m_buffers[offset] = buffer;
+  m_buffered_bytes += length;
+  prefetches->push_back(buffer);
+}
+
+template <typename I>
+void ReadaheadImageDispatch<I>::prefetch(IOContext io_context,
+                                         const BufferRefs& prefetches) {
+  if (prefetches.empty()) {
+    return;
+  }
+
+  auto cct = m_image_ctx->cct;
+  uint64_t prefetch_bytes = 0;
+  for (auto& buffer : prefetches) {
+    ldout(cct, 20) << "prefetch " << buffer->offset << "~" << buffer->length
+                   << dendl;
+
+    m_async_op_tracker.start_op();
+    m_image_ctx->readahead.inc_pending();
+
+    auto ctx = new C_PrefetchRead(this, buffer);
+    auto aio_comp = AioCompletion::create_and_start(
+      ctx, util::get_image_ctx(m_image_ctx), AIO_TYPE_READ);
+    auto req = ImageDispatchSpec::create_read(
+      *m_image_ctx, IMAGE_DISPATCH_LAYER_READAHEAD, aio_comp,
+      {{buffer->offset, buffer->length}}, ImageArea::DATA,
+      ReadResult{&ctx->bl}, io_context, 0, 0, {});
+    req->send();
+
+    prefetch_bytes += buffer->length;
+  }
+
+  m_image_ctx->perfcounter->inc(l_librbd_readahead);
+  m_image_ctx->perfcounter->inc(l_librbd_readahead_bytes, prefetch_bytes);
+}
+
+template <typename I>
+void ReadaheadImageDispatch<I>::handle_prefetch(const BufferRef& buffer,
+                                                int r, bufferlist&& bl) {
+  auto cct = m_image_ctx->cct;
+  ldout(cct, 20) << "buffer " << buffer->offset << "~" << buffer->length
+                 << ": r=" << r << dendl;
+
+  std::list<Context*> waiters;
+  {
+    std::lock_guard locker{m_lock};
+    std::swap(waiters, buffer->waiters);
+    buffer->ready = true;
+    if (r < 0 || bl.length() != buffer->length ||
+        buffer->generation != m_generation) {
+      if (r < 0) {
+        ldout(cct, 5) << "failed to prefetch " << buffer->offset << "~"
+                      << buffer->length << ": " << cpp_strerror(r) << dendl;
+      }
+      invalidate_buffer(buffer);
+    } else if (buffer->valid) {
+      buffer->bl = std::move(bl);
+    }
+  }
+
+  for (auto ctx : waiters) {
+    ctx->complete(0);
+  }
+
+  m_image_ctx->readahead.dec_pending();
+  m_async_op_tracker.finish_op();
+}
+
+template <typename I>
+void ReadaheadImageDispatch<I>::complete_buffered_read(C_BufferedRead* req) {
+  auto cct = m_image_ctx->cct;
+  uint64_t end = req->offset + req->length;
+
+  bufferlist bl;
+  bool hit = true;
+  {
+    std::lock_guard locker{m_lock};
+
+    // buffers may have been invalidated or consumed by another read while
+    // waiting for the prefetch to complete
+    uint64_t pos = req->offset;
+    for (auto& buffer : req->buffers) {
+      uint64_t buffer_end = buffer->offset + buffer->length;
+      if (!buffer->valid || !buffer->ready || buffer->offset > pos ||
+          buffer_end <= pos) {
+        hit = false;
+        break;
+      }
+
+      uint64_t length = std::min(buffer_end, end) - pos;
+      bufferlist sub_bl;
+      sub_bl.substr_of(buffer->bl, pos - buffer->offset, length);
+      bl.claim_append(sub_bl);
+      pos += length;
+    }
+
+    if (hit && pos == end) {
+      consume_buffers(req->buffers, end);
+    } else {
+      hit = false;
+    }
+  }
+
+  if (!hit) {
+    ldout(cct, 20) << "lost buffered data for " << req->offset << "~"
+                   << req->length << dendl;
+    m_image_ctx->perfcounter->inc(l_librbd_readahead_miss);
+    req->on_dispatched->complete(0);
+    return;
+  }
+
+  ldout(cct, 20) << "buffered read " << req->offset << "~" << req->length
+                 << dendl;
+  m_image_ctx->perfcounter->inc(l_librbd_readahead_hit);
+  m_image_ctx->perfcounter->inc(l_librbd_readahead_hit_bytes, req->length);
+
+  // hand the prefetched buffers to the read result without copying
+  auto aio_comp = req->aio_comp;
+  *req->dispatch_result = DISPATCH_RESULT_COMPLETE;
+  if (!aio_comp->async_op.started()) {
+    aio_comp->start_op();
+  }
+
+  Extents image_extents{{req->offset, req->length}};
+  aio_comp->read_result = std::move(*req->read_result);
+  aio_comp->read_result.set_image_extents(image_extents);
+  aio_comp->set_request_count(1);
+
+  auto req_comp = new ReadResult::C_ImageReadRequest(
+    aio_comp, 0, image_extents);
+  req_comp->bl = std::move(bl);
+  req_comp->complete(0);
+}
+
+template <typename I>
+void ReadaheadImageDispatch<I>::consume_buffers(const BufferRefs& buffers,
+                                                uint64_t end) {
+  ceph_assert(ceph_mutex_is_locked_by_me(m_lock));
+
+  // sequential streams do not read the same data twice: drop everything
+  // up to the end of the read and keep the remainder of the last buffer
+  for (auto& buffer : buffers) {
+    uint64_t buffer_end = buffer->offset + buffer->length;
+    if (buffer_end <= end) {
+      erase_buffer(buffer);
+      continue;
+    }
+
+    auto it = m_buffers.find(buffer->offset);
+    ceph_assert(it != m_buffers.end() && it->second == buffer);
+    m_buffers.erase(it);
+
+    uint64_t consumed = end - buffer->offset;
+    bufferlist bl;
+    bl.substr_of(buffer->bl, consumed, buffer->length - consumed);
+    buffer->bl = std::move(bl);
+    buffer->offset = end;
+    buffer->length -= consumed;
+    m_buffered_bytes -= consumed;
+    m_buffers[end] = buffer;
+  }
+}
+
+template <typename I>
+void ReadaheadImageDispatch<I>::invalidate_buffers(
+    const Extents& image_extents) {
+  ceph_assert(ceph_mutex_is_locked_by_me(m_lock));
+
+  for (auto& [offset, length] : image_extents) {
+    uint64_t end = offset + length;
+    auto it = m_buffers.lower_bound(offset);
+    if (it != m_buffers.begin()) {
+      --it;
+    }
+
+    while (it != m_buffers.end() && it->first < end) {
+      auto buffer = (it++)->second;
+      if (buffer->offset + buffer->length > offset) {
+        invalidate_buffer(buffer);
+      }
+    }
+  }
+}
+
+template <typename I>
+void ReadaheadImageDispatch<I>::invalidate_buffer(const BufferRef& buffer) {
+  ceph_assert(ceph_mutex_is_locked_by_me(m_lock));
+
+  if (buffer->valid && buffer->ready) {
+    m_image_ctx->perfcounter->inc(l_librbd_readahead_evicted_bytes,
+                                  buffer->length);
+  }
+  buffer->valid = false;
+  buffer->bl.clear();
+  erase_buffer(buffer);
+}
+
+template <typename I>
+void ReadaheadImageDispatch<I>::erase_buffer(const BufferRef& buffer) {
+  ceph_assert(ceph_mutex_is_locked_by_me(m_lock));
+
+  auto it = m_buffers.find(buffer->offset);
+  if (it != m_buffers.end() && it->second == buffer) {
+    m_buffers.erase(it);
+    m_buffered_bytes -= buffer->length;
+  }
+}
+
+template <typename I>
+bool ReadaheadImageDispatch<I>::reserve_buffer_space(uint64_t length) {
+  ceph_assert(ceph_mutex_is_locked_by_me(m_lock));
+
+  // evict the oldest prefetched data, in-flight prefetches cannot be
+  // reclaimed until they complete
+  while (m_buffered_bytes + length > m_max_buffered_bytes) {
+    BufferRef victim;
+    for (auto& [offset, buffer] : m_buffers) {
+      if (buffer->ready && (!victim || buffer->seq < victim->seq)) {
+        victim = buffer;
+      }
+    }
+
+    if (!victim) {
+      return false;
+    }
+    invalidate_buffer(victim);
+  }
+  return true;
+}
+
+} // namespace io
+} // namespace librbd
+
+template class librbd::io::ReadaheadImageDispatch<librbd::ImageCtx>;
@@ -0,0 +1,198 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
+// vim: ts=8 sw=2 sts=2 expandtab
+
+#ifndef CEPH_LIBRBD_IO_READAHEAD_IMAGE_DISPATCH_H
+#define CEPH_LIBRBD_IO_READAHEAD_IMAGE_DISPATCH_H
+
+#include "librbd/io/ImageDispatchInterface.h"
+#include "include/int_types.h"
+#include "include/buffer.h"
+#include "common/AsyncOpTracker.h"
+#include "common/ceph_mutex.h"
+#include "common/zipkin_trace.h"
+#include "librbd/io/ReadResult.h"
+#include "librbd/io/Types.h"
+#include <atomic>
+#include <list>
+#include <map>
+#include <memory>
+#include <vector>
+
+struct Context;
+class Readahead;
+
+namespace librbd {
+
+struct ImageCtx;
+
+namespace io {
+
+struct AioCompletion;
+
+/**
+ * Image-level readahead for images that do not use the object cacher.
+ *
+ * Reads are matched against a small set of sequential streams, each of
+ * which drives its own Readahead state.  Once a stream triggers, the
+ * readahead extent is read through the remaining image dispatch layers
+ * into a bounded set of buffers and later reads covered by those buffers
+ * are completed directly from them.  Prefetched data is handed out once:
+ * it is dropped as soon as a read consumes it, and whenever a write,
+ * discard or cache invalidation touches it.  Nothing is prefetched unless
+ * the exclusive lock is owned.
+ */
+template <typename ImageCtxT>
+class ReadaheadImageDispatch : public ImageDispatchInterface {
+public:
+  static ReadaheadImageDispatch* create(ImageCtxT* image_ctx) {
+    return new ReadaheadImageDispatch(image_ctx);
+  }
+
+  ReadaheadImageDispatch(ImageCtxT* image_ctx);
+  ~ReadaheadImageDispatch() override;
+
+  ImageDispatchLayer get_dispatch_layer() const override {
+    return IMAGE_DISPATCH_LAYER_READAHEAD;
+  }
+
+  void init();
+  void shut_down(Context* on_finish) override;
+
+  bool read(
+      AioCompletion* aio_comp, Extents &&image_extents,
+      ReadResult &&read_result, IOContext io_context, int op_flags,
+      int read_flags, const ZTracer::Trace &parent_trace, uint64_t tid,
+      std::atomic<uint32_t>* image_dispatch_flags,
+      DispatchResult* dispatch_result, Context** on_finish,
+      Context* on_dispatched) override;
+  bool write(
+      AioCompletion* aio_comp, Extents &&image_extents, bufferlist &&bl,
+      int op_flags, const ZTracer::Trace &parent_trace,
+      uint64_t tid, std::atomic<uint32_t>* image_dispatch_flags,
+      DispatchResult* dispatch_result, Context** on_finish,
+      Context* on_dispatched) override;
+  bool discard(
+      AioCompletion* aio_comp, Extents &&image_extents,
+      uint32_t discard_granularity_bytes, const ZTracer::Trace &parent_trace,
+      uint64_t tid, std::atomic<uint32_t>* image_dispatch_flags,
+      DispatchResult* dispatch_result, Context** on_finish,
+      Context* on_dispatched) override;
+  bool write_same(
+      AioCompletion* aio_comp, Extents &&image_extents, bufferlist &&bl,
+      int op_flags, const ZTracer::Trace &parent_trace,
+      uint64_t tid, std::atomic<uint32_t>* image_dispatch_flags,
+      DispatchResult* dispatch_result, Context** on_finish,
+      Context* on_dispatched) override;
+  bool compare_and_write(
+      AioCompletion* aio_comp, Extents &&image_extents,
+      bufferlist &&cmp_bl, bufferlist &&bl, uint64_t *mismatch_offset,
+      int op_flags, const ZTracer::Trace &parent_trace,
+      uint64_t tid, std::atomic<uint32_t>* image_dispatch_flags,
+      DispatchResult* dispatch_result, Context** on_finish,
+      Context* on_dispatched) override;
+  bool flush(
+      AioCompletion* aio_comp, FlushSource flush_source,
+      const ZTracer::Trace &parent_trace, uint64_t tid,
+      std::atomic<uint32_t>* image_dispatch_flags,
+      DispatchResult* dispatch_result, Context** on_finish,
+      Context* on_dispatched) override {
+    return false;
+  }
+
+  bool list_snaps(
+      AioCompletion* aio_comp, Extents&& image_extents, SnapIds&& snap_ids,
+      int list_snaps_flags, SnapshotDelta* snapshot_delta,
+      const ZTracer::Trace &parent_trace, uint64_t tid,
+      std::atomic<uint32_t>* image_dispatch_flags,
+      DispatchResult* dispatch_result, Context** on_finish,
+      Context* on_dispatched) override {
+    return false;
+  }
+
+  bool invalidate_cache(Context* on_finish) override;
+
+private:
+  struct Buffer {
+    uint64_t offset;
+    uint64_t length;
+    uint64_t snap_id;
+    uint64_t seq;
+    uint64_t generation = 0;
+
+    bool ready = false;
+    bool valid = true;
+    bufferlist bl;
+    std::list<Context*> waiters;
+
+    Buffer(uint64_t offset, uint64_t length, uint64_t snap_id, uint64_t seq)
+      : offset(offset), length(length), snap_id(snap_id), seq(seq) {
+    }
+  };
+  typedef std::shared_ptr<Buffer> BufferRef;
+  typedef std::vector<BufferRef> BufferRefs;
+
+  struct Stream {
+    uint64_t next_offset = 0;
+    uint64_t last_used = 0;
+    std::unique_ptr<Readahead> readahead;
+  };
+
+  struct C_PrefetchRead;
+  struct C_BufferedRead;
+
+  ImageCtxT* m_image_ctx;
+
+  const uint32_t m_max_streams;
+  const uint64_t m_max_buffered_bytes;
+  const uint64_t m_trigger_requests;
+  const uint64_t m_max_readahead_bytes;
+  std::vector<uint64_t> m_alignments;
+
+  AsyncOpTracker m_async_op_tracker;
+  std::atomic<uint64_t> m_total_bytes_read = {0};
+
+  ceph::mutex m_lock;
+  std::vector<Stream> m_streams;
+  uint64_t m_stream_clock = 0;
+
+  // non-overlapping buffers keyed by image offset
+  std::map<uint64_t, BufferRef> m_buffers;
+  uint64_t m_buffered_bytes = 0;
+  uint64_t m_buffer_seq = 0;
+  // bumped by invalidate_cache(); buffers from an older generation were
+  // requested before the cache was invalidated and are never served
+  uint64_t m_generation = 0;
+
+  // writes that have passed this layer but not yet completed
+  std::map<uint64_t, Extents> m_in_flight_writes;
+
+  bool handle_write(uint64_t tid, const Extents& image_extents,
+                    const std::atomic<uint32_t>* image_dispatch_flags,
+                    Context** on_finish);
+  void handle_write_finished(uint64_t tid);
+
+  bool get_buffers(uint64_t snap_id, uint64_t offset, uint64_t length,
+                   BufferRefs* buffers);
+  void update_streams(uint64_t snap_id, uint64_t offset, uint64_t length,
+                      uint64_t data_size, BufferRefs* prefetches);
+  void add_buffer(uint64_t snap_id, uint64_t offset, uint64_t length,
+                  BufferRefs* prefetches);
+  void prefetch(IOContext io_context, const BufferRefs& prefetches);
+  void handle_prefetch(const BufferRef& buffer, int r, bufferlist&& bl);
+
+  void complete_buffered_read(C_BufferedRead* req);
+
+  void consume_buffers(const BufferRefs& buffers, uint64_t end);
+  void invalidate_buffers(const Extents& image_extents);
+  void invalidate_buffer(const BufferRef& buffer);
+  void erase_buffer(const BufferRef& buffer);
+  bool reserve_buffer_space(uint64_t length);
+
+};
+
+} // namespace io
+} // namespace librbd
+
+extern template class librbd::io::ReadaheadImageDispatch<librbd::ImageCtx>;
+
+#endif // CEPH_LIBRBD_IO_READAHEAD_IMAGE_DISPATCH_H
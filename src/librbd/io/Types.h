@@ -65,6 +65,7 @@ enum ImageDispatchLayer {
   IMAGE_DISPATCH_LAYER_MIGRATION,
   IMAGE_DISPATCH_LAYER_JOURNAL,
   IMAGE_DISPATCH_LAYER_WRITE_BLOCK,
+  IMAGE_DISPATCH_LAYER_READAHEAD,
   IMAGE_DISPATCH_LAYER_WRITEBACK_CACHE,
   IMAGE_DISPATCH_LAYER_CORE,
   IMAGE_DISPATCH_LAYER_LAST
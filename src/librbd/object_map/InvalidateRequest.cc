@@ -5,6 +5,7 @@
 #include "common/dout.h"
 #include "librbd/ExclusiveLock.h"
 #include "librbd/ImageCtx.h"
+#include "librbd/object_map/SnapshotCache.h"
 
 #define dout_subsys ceph_subsys_rbd
 #undef dout_prefix
@@ -26,6 +27,12 @@ void InvalidateRequest<I>::send() {
   ceph_assert(ceph_mutex_is_locked(image_ctx.owner_lock));
   ceph_assert(ceph_mutex_is_wlocked(image_ctx.image_lock));
 
+  if (m_snap_id != CEPH_NOSNAP) {
+    SnapshotCache::get_instance(image_ctx.cct).remove(
+      {image_ctx.md_ctx.get_id(), image_ctx.md_ctx.get_namespace(),
+       image_ctx.id, m_snap_id});
+  }
+
   uint64_t snap_flags;
   int r = image_ctx.get_flags(m_snap_id, &snap_flags);
   if (r < 0 || ((snap_flags & RBD_FLAG_OBJECT_MAP_INVALID) != 0)) {
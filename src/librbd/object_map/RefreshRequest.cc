@@ -10,9 +10,11 @@
 #include "librbd/object_map/InvalidateRequest.h"
 #include "librbd/object_map/LockRequest.h"
 #include "librbd/object_map/ResizeRequest.h"
+#include "librbd/object_map/SnapshotCache.h"
 #include "librbd/Utils.h"
 #include "osdc/Striper.h"
 
+#include <iterator>
 #include <shared_mutex> // for std::shared_lock
 
 #define dout_subsys ceph_subsys_rbd
@@ -71,6 +73,9 @@ void RefreshRequest<I>::send_lock() {
     send_invalidate_and_close();
     return;
   } else if (m_snap_id != CEPH_NOSNAP) {
+    if (load_from_cache()) {
+      return;
+    }
     send_load();
     return;
   }
@@ -161,10 +166,88 @@ Context *RefreshRequest<I>::handle_load(int *ret_val) {
                   << m_object_count << dendl;
   }
 
+  save_to_cache();
   apply();
   return m_on_finish;
 }
 
+template <typename I>
+bool RefreshRequest<I>::get_cache_key(SnapshotCache::Key* key,
+                                      uint64_t* prev_snap_id) {
+  ceph_assert(m_snap_id != CEPH_NOSNAP);
+
+  // only parent snapshots opened on behalf of a clone are cached.  Deep
+  // copy, migration and rbd-mirror write into the snapshot object maps of
+  // the image they copy to, the latter two until the migration or mirror
+  // snapshot completes, and another process would not drop the entries.
+  if (m_image_ctx.child == nullptr) {
+    return false;
+  }
+
+  std::shared_lock image_locker{m_image_ctx.image_lock};
+  if (!m_image_ctx.migration_info.empty()) {
+    return false;
+  }
+  for (auto& [snap_id, snap_info] : m_image_ctx.snap_info) {
+    auto mirror_ns = std::get_if<cls::rbd::MirrorSnapshotNamespace>(
+      &snap_info.snap_namespace);
+    if (mirror_ns != nullptr && !mirror_ns->complete) {
+      return false;
+    }
+  }
+
+  auto it = m_image_ctx.snap_info.find(m_snap_id);
+  if (it == m_image_ctx.snap_info.end() ||
+      (it->second.flags & RBD_FLAG_OBJECT_MAP_INVALID) != 0) {
+    return false;
+  }
+
+  *key = {m_image_ctx.md_ctx.get_id(), m_image_ctx.md_ctx.get_namespace(),
+          m_image_ctx.id, m_snap_id};
+  *prev_snap_id = (it == m_image_ctx.snap_info.begin() ?
+                     CEPH_NOSNAP : std::prev(it)->first);
+  return true;
+}
+
+template <typename I>
+bool RefreshRequest<I>::load_from_cache() {
+  SnapshotCache::Key key;
+  uint64_t prev_snap_id;
+  if (!get_cache_key(&key, &prev_snap_id)) {
+    return false;
+  }
+
+  auto& cache = SnapshotCache::get_instance(m_image_ctx.cct);
+  if (!cache.get(key, prev_snap_id, &m_on_disk_object_map)) {
+    return false;
+  } else if (m_on_disk_object_map.size() < m_object_count) {
+    cache.remove(key);
+    m_on_disk_object_map.clear();
+    return false;
+  }
+
+  CephContext *cct = m_image_ctx.cct;
+  ldout(cct, 10) << this << " " << __func__ << ": num_objs="
+                 << m_on_disk_object_map.size() << dendl;
+
+  apply();
+  m_image_ctx.op_work_queue->queue(m_on_finish, 0);
+  delete this;
+  return true;
+}
+
+template <typename I>
+void RefreshRequest<I>::save_to_cache() {
+  SnapshotCache::Key key;
+  uint64_t prev_snap_id;
+  if (!get_cache_key(&key, &prev_snap_id)) {
+    return;
+  }
+
+  auto& cache = SnapshotCache::get_instance(m_image_ctx.cct);
+  cache.put(key, prev_snap_id, m_on_disk_object_map);
+}
+
 template <typename I>
 void RefreshRequest<I>::send_invalidate() {
   CephContext *cct = m_image_ctx.cct;
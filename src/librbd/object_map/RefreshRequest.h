@@ -8,6 +8,7 @@
 #include "include/buffer.h"
 #include "common/bit_vector.hpp"
 #include "common/ceph_mutex.h"
+#include "librbd/object_map/SnapshotCache.h"
 
 class Context;
 class RWLock;
@@ -59,6 +60,9 @@ private:
    *    v                                     v
    * INVALIDATE_AND_CLOSE ---------------> <finish>
    *
+   * LOAD is skipped if the snapshot object map is found in the
+   * SnapshotCache.
+   *
    * @endverbatim
    */
 
@@ -91,6 +95,10 @@ private:
   void send_invalidate_and_close();
   Context *handle_invalidate_and_close(int *ret_val);
 
+  bool get_cache_key(SnapshotCache::Key* key, uint64_t* prev_snap_id);
+  bool load_from_cache();
+  void save_to_cache();
+
   void apply();
 };
 
@@ -0,0 +1,97 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
+// vim: ts=8 sw=2 sts=2 expandtab
+
+#include "librbd/object_map/SnapshotCache.h"
+#include "common/ceph_context.h"
+#include "common/dout.h"
+
+#define dout_subsys ceph_subsys_rbd
+#undef dout_prefix
+#define dout_prefix *_dout << "librbd::object_map::SnapshotCache: " \
+                           << this << " " << __func__ << ": "
+
+namespace librbd {
+namespace object_map {
+
+SnapshotCache& SnapshotCache::get_instance(CephContext* cct) {
+  return cct->lookup_or_create_singleton_object<SnapshotCache>(
+    "librbd::object_map::SnapshotCache", false, cct);
+}
+
+SnapshotCache::SnapshotCache(CephContext* cct) : m_cct(cct) {
+}
+
+bool SnapshotCache::get(const Key& key, uint64_t prev_snap_id,
+                        ceph::BitVector<2>* object_map) {
+  std::lock_guard locker{m_lock};
+  auto it = m_entries.find(key);
+  if (it == m_entries.end()) {
+    return false;
+  }
+
+  if (it->second.prev_snap_id != prev_snap_id) {
+    // the preceding snapshot was removed and merged into this object map
+    ldout(m_cct, 20) << "stale: image_id=" << key.image_id << ", "
+                     << "snap_id=" << key.snap_id << dendl;
+    erase(it);
+    return false;
+  }
+
+  ldout(m_cct, 20) << "hit: image_id=" << key.image_id << ", "
+                   << "snap_id=" << key.snap_id << dendl;
+  m_lru.splice(m_lru.end(), m_lru, it->second.lru_it);
+  *object_map = it->second.object_map;
+  return true;
+}
+
+void SnapshotCache::put(const Key& key, uint64_t prev_snap_id,
+                        const ceph::BitVector<2>& object_map) {
+  auto max_bytes = m_cct->_conf.get_val<Option::size_t>(
+    "rbd_object_map_snapshot_cache_size");
+  uint64_t bytes = (object_map.size() + 3) / 4;
+
+  std::lock_guard locker{m_lock};
+  auto it = m_entries.find(key);
+  if (it != m_entries.end()) {
+    erase(it);
+  }
+  if (bytes > max_bytes) {
+    trim(max_bytes);
+    return;
+  }
+
+  trim(max_bytes - bytes);
+  ldout(m_cct, 20) << "image_id=" << key.image_id << ", "
+                   << "snap_id=" << key.snap_id << ", "
+                   << "bytes=" << bytes << dendl;
+  auto lru_it = m_lru.insert(m_lru.end(), key);
+  m_entries.emplace(key, Entry{prev_snap_id, object_map, bytes, lru_it});
+  m_bytes += bytes;
+}
+
+void SnapshotCache::remove(const Key& key) {
+  std::lock_guard locker{m_lock};
+  auto it = m_entries.find(key);
+  if (it != m_entries.end()) {
+    ldout(m_cct, 20) << "image_id=" << key.image_id << ", "
+                     << "snap_id=" << key.snap_id << dendl;
+    erase(it);
+  }
+}
+
+void SnapshotCache::erase(std::map<Key, Entry>::iterator it) {
+  ceph_assert(ceph_mutex_is_locked(m_lock));
+  m_bytes -= it->second.bytes;
+  m_lru.erase(it->second.lru_it);
+  m_entries.erase(it);
+}
+
+void SnapshotCache::trim(uint64_t max_bytes) {
+  ceph_assert(ceph_mutex_is_locked(m_lock));
+  while (m_bytes > max_bytes && !m_lru.empty()) {
+    erase(m_entries.find(m_lru.front()));
+  }
+}
+
+} // namespace object_map
+} // namespace librbd
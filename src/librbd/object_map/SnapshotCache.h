@@ -0,0 +1,79 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
+// vim: ts=8 sw=2 sts=2 expandtab
+
+#ifndef CEPH_LIBRBD_OBJECT_MAP_SNAPSHOT_CACHE_H
+#define CEPH_LIBRBD_OBJECT_MAP_SNAPSHOT_CACHE_H
+
+#include "include/int_types.h"
+#include "common/bit_vector.hpp"
+#include "common/ceph_mutex.h"
+#include <list>
+#include <map>
+#include <string>
+#include <tuple>
+
+class CephContext;
+
+namespace librbd {
+namespace object_map {
+
+/**
+ * Process-wide cache of snapshot object maps.
+ *
+ * Unlike the HEAD object map, the object map of a snapshot only changes
+ * when it is invalidated or rebuilt, or when the preceding snapshot is
+ * removed and its state is folded into it.  Clones of the same parent
+ * snapshot all load the parent's snapshot object map when they are
+ * opened, so caching it avoids one OSD read per clone open.  Entries
+ * record the id of the preceding snapshot at load time and are only
+ * returned while it is unchanged.
+ */
+class SnapshotCache {
+public:
+  struct Key {
+    int64_t pool_id;
+    std::string pool_namespace;
+    std::string image_id;
+    uint64_t snap_id;
+
+    bool operator<(const Key& rhs) const {
+      return std::tie(pool_id, pool_namespace, image_id, snap_id) <
+             std::tie(rhs.pool_id, rhs.pool_namespace, rhs.image_id,
+                      rhs.snap_id);
+    }
+  };
+
+  static SnapshotCache& get_instance(CephContext* cct);
+
+  explicit SnapshotCache(CephContext* cct);
+
+  bool get(const Key& key, uint64_t prev_snap_id,
+           ceph::BitVector<2>* object_map);
+  void put(const Key& key, uint64_t prev_snap_id,
+           const ceph::BitVector<2>& object_map);
+  void remove(const Key& key);
+
+private:
+  struct Entry {
+    uint64_t prev_snap_id;
+    ceph::BitVector<2> object_map;
+    uint64_t bytes;
+    std::list<Key>::iterator lru_it;
+  };
+
+  CephContext* m_cct;
+
+  ceph::mutex m_lock = ceph::make_mutex(
+    "librbd::object_map::SnapshotCache::m_lock");
+  std::map<Key, Entry> m_entries;
+  std::list<Key> m_lru;
+  uint64_t m_bytes = 0;
+
+  void erase(std::map<Key, Entry>::iterator it);
+  void trim(uint64_t max_bytes);
+};
+
+} // namespace object_map
+} // namespace librbd
+
+#endif // CEPH_LIBRBD_OBJECT_MAP_SNAPSHOT_CACHE_H
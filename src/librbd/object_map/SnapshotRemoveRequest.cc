@@ -7,6 +7,7 @@
 #include "librbd/ImageCtx.h"
 #include "librbd/ObjectMap.h"
 #include "librbd/object_map/InvalidateRequest.h"
+#include "librbd/object_map/SnapshotCache.h"
 #include "cls/lock/cls_lock_client.h"
 
 #include <shared_mutex> // for std::shared_lock
@@ -23,11 +24,21 @@ void SnapshotRemoveRequest::send() {
   ceph_assert(ceph_mutex_is_locked(m_image_ctx.owner_lock));
   ceph_assert(ceph_mutex_is_wlocked(m_image_ctx.image_lock));
 
+  SnapshotCache::get_instance(m_image_ctx.cct).remove(
+    {m_image_ctx.md_ctx.get_id(), m_image_ctx.md_ctx.get_namespace(),
+     m_image_ctx.id, m_snap_id});
+
   if ((m_image_ctx.features & RBD_FEATURE_FAST_DIFF) != 0) {
     int r = m_image_ctx.get_flags(m_snap_id, &m_flags);
     ceph_assert(r == 0);
 
     compute_next_snap_id();
+    if (m_next_snap_id != CEPH_NOSNAP) {
+      // the state of the removed snapshot is merged into the next one
+      SnapshotCache::get_instance(m_image_ctx.cct).remove(
+        {m_image_ctx.md_ctx.get_id(), m_image_ctx.md_ctx.get_namespace(),
+         m_image_ctx.id, m_next_snap_id});
+    }
     load_map();
   } else {
     remove_map();
@@ -8,6 +8,7 @@
 #include "librbd/ImageCtx.h"
 #include "librbd/ObjectMap.h"
 #include "librbd/Utils.h"
+#include "librbd/object_map/SnapshotCache.h"
 #include "cls/lock/cls_lock_client.h"
 
 #include <shared_mutex> // for std::shared_lock
@@ -30,6 +31,11 @@ const uint64_t MAX_OBJECTS_PER_UPDATE = 256 * (1 << 10);
 
 template <typename I>
 void UpdateRequest<I>::send() {
+  if (m_snap_id != CEPH_NOSNAP) {
+    SnapshotCache::get_instance(m_image_ctx.cct).remove(
+      {m_image_ctx.md_ctx.get_id(), m_image_ctx.md_ctx.get_namespace(),
+       m_image_ctx.id, m_snap_id});
+  }
   update_object_map();
 }
 
@@ -47,9 +47,10 @@ CDentry::CDentry(std::string_view n, __u32 h,
   item_dirty(this),
   lock(this, &lock_type),
   versionlock(this, &versionlock_type),
-  name(n),
-  alternate_name(std::move(alternate_name))
-{}
+  name(n)
+{
+  set_alternate_name(std::move(alternate_name));
+}
 
 CDentry::CDentry(std::string_view n, __u32 h,
 		 mempool::mds_co::string alternate_name,
@@ -60,9 +61,9 @@ CDentry::CDentry(std::string_view n, __u32 h,
   item_dirty(this),
   lock(this, &lock_type),
   versionlock(this, &versionlock_type),
-  name(n),
-  alternate_name(std::move(alternate_name))
+  name(n)
 {
+  set_alternate_name(std::move(alternate_name));
   linkage.remote_ino = ino;
   linkage.remote_d_type = dt;
   linkage.referent_ino = referent_ino;
@@ -879,3 +880,4 @@ bool CDentry::check_corruption(bool load)
 }
 
 MEMPOOL_DEFINE_OBJECT_FACTORY(CDentry, co_dentry, mds_co);
+MEMPOOL_DEFINE_OBJECT_FACTORY(CDentry::alternate_name_t, co_dentry_altname, mds_co);
@@ -110,6 +110,14 @@ public:
     }
   };
 
+  // out-of-line holder for alternate_name, so the object itself is
+  // accounted to mds_co and not just the string's buffer
+  struct alternate_name_t {
+    MEMPOOL_CLASS_HELPERS();
+    explicit alternate_name_t(mempool::mds_co::string&& s) : str(std::move(s)) {}
+    mempool::mds_co::string str;
+  };
+
 
   // -- state --
   static const int STATE_NEW =          (1<<0);
@@ -171,13 +179,16 @@ public:
   CDir *get_dir() { return dir; }
   std::string_view get_name() const { return std::string_view(name); }
   std::string_view get_alternate_name() const {
-    return std::string_view(alternate_name);
+    return alternate_name ? std::string_view(alternate_name->str) : std::string_view();
   }
   void set_alternate_name(mempool::mds_co::string altn) {
-    alternate_name = std::move(altn);
+    if (altn.empty())
+      alternate_name.reset();
+    else
+      alternate_name = std::make_unique<alternate_name_t>(std::move(altn));
   }
   void set_alternate_name(std::string_view altn) {
-    alternate_name = mempool::mds_co::string(altn);
+    set_alternate_name(mempool::mds_co::string(altn));
   }
 
   __u32 get_hash() const { return hash; }
@@ -395,7 +406,8 @@ public:
     ClientLease, boost::intrusive::key_of_value<client_is_key>> ClientLeaseMap;
   ClientLeaseMap client_leases;
 
-  std::map<int, std::unique_ptr<BatchOp>> batch_ops;
+  // almost always empty: only allocated while getattr/lookup ops batch
+  mempool::mds_co::compact_map<int, std::unique_ptr<BatchOp>> batch_ops;
 
   ceph_tid_t reintegration_reqid = 0;
 
@@ -417,7 +429,8 @@ protected:
 
 private:
   mempool::mds_co::string name;
-  mempool::mds_co::string alternate_name;
+  // only set for encrypted names, so kept out of line
+  std::unique_ptr<alternate_name_t> alternate_name;
 };
 
 std::ostream& operator<<(std::ostream& out, const CDentry& dn);
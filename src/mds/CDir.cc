@@ -143,6 +143,8 @@ ostream& operator<<(ostream& out, const CDir& dir)
   if (dir.state_test(CDir::STATE_CREATING)) out << "|creating";
   if (dir.state_test(CDir::STATE_COMMITTING)) out << "|committing";
   if (dir.state_test(CDir::STATE_FETCHING)) out << "|fetching";
+  if (dir.state_test(CDir::STATE_FETCHPAGED)) out << "|fetchpaged";
+  if (dir.state_test(CDir::STATE_FETCHTRIMMED)) out << "|fetchtrimmed";
   if (dir.state_test(CDir::STATE_EXPORTING)) out << "|exporting";
   if (dir.state_test(CDir::STATE_IMPORTING)) out << "|importing";
   if (dir.state_test(CDir::STATE_STICKY)) out << "|sticky";
@@ -1795,7 +1797,9 @@ public:
       omap.insert(omap_more.begin(), omap_more.end());
     }
     if (more) {
-      dir->_omap_fetch_more(omap_version, hdrbl, omap, fin);
+      std::string after = omap.rbegin()->first;
+      if (dir->_omap_fetched_page(hdrbl, omap, r))
+	dir->_omap_fetch_more(omap_version, hdrbl, omap, after, fin);
     } else {
       dir->_omap_fetched(hdrbl, omap, true, {}, r);
       if (fin)
@@ -1834,7 +1838,9 @@ public:
       if (omap_version < dir->get_committed_version()) {
 	dir->_omap_fetch(nullptr, fin);
       } else {
-	dir->_omap_fetch_more(omap_version, hdrbl, omap, fin);
+	std::string after = omap.rbegin()->first;
+	if (dir->_omap_fetched_page(hdrbl, omap, r))
+	  dir->_omap_fetch_more(omap_version, hdrbl, omap, after, fin);
       }
       return;
     }
@@ -1861,6 +1867,8 @@ void CDir::_omap_fetch(std::set<string> *keys, MDSContext *c)
     rd.omap_get_vals_by_keys(fin->keys, &fin->omap, &fin->ret2);
   } else {
     ceph_assert(!c);
+    // (re)starting from the first page
+    state_clear(STATE_FETCHPAGED);
     rd.omap_get_vals("", "", g_conf()->mds_dir_keys_per_op,
 		     &fin->omap, &fin->more, &fin->ret2);
   }
@@ -1877,7 +1885,8 @@ void CDir::_omap_fetch(std::set<string> *keys, MDSContext *c)
 }
 
 void CDir::_omap_fetch_more(version_t omap_version, bufferlist& hdrbl,
-			    map<string, bufferlist>& omap, MDSContext *c)
+			    map<string, bufferlist>& omap,
+			    const string& after, MDSContext *c)
 {
   // we have more omap keys to fetch!
   object_t oid = get_ondisk_object();
@@ -1886,7 +1895,7 @@ void CDir::_omap_fetch_more(version_t omap_version, bufferlist& hdrbl,
   fin->hdrbl = std::move(hdrbl);
   fin->omap.swap(omap);
   ObjectOperation rd;
-  rd.omap_get_vals(fin->omap.rbegin()->first,
+  rd.omap_get_vals(after,
 		   "", /* filter prefix */
 		   g_conf()->mds_dir_keys_per_op,
 		   &fin->omap_more,
@@ -1896,6 +1905,35 @@ void CDir::_omap_fetch_more(version_t omap_version, bufferlist& hdrbl,
 			     new C_OnFinisher(fin, mdcache->mds->finisher));
 }
 
+/*
+ * With mds_dir_fetch_paged, load each page of a multi-page fetch into the
+ * cache as it arrives instead of holding on to the whole dirfrag until the
+ * last page is read.  Waiters on dentries in the page are woken right
+ * away.  The loaded dentries may be trimmed like any other; the dirfrag
+ * is only marked complete by the last page if none of them were.  If some
+ * were, STATE_FETCHTRIMMED stays set and the next fetch of the dirfrag, by
+ * the WAIT_COMPLETE waiters, holds on to every page so it can complete.
+ *
+ * Returns false if the fetch was abandoned.
+ */
+bool CDir::_omap_fetched_page(bufferlist& hdrbl, map<string, bufferlist>& omap,
+			      int r)
+{
+  if (!g_conf().get_val<bool>("mds_dir_fetch_paged") ||
+      state_test(STATE_FETCHTRIMMED))
+    return true; // carry the page over to the last one
+
+  state_set(STATE_FETCHPAGED);
+  _omap_fetched(hdrbl, omap, true, {}, r, true);
+  omap.clear();
+
+  if (mdcache->mds->logger)
+    mdcache->mds->logger->inc(l_mds_dir_fetch_page);
+
+  // went bad?
+  return state_test(STATE_FETCHING);
+}
+
 CDentry *CDir::_load_dentry(
     std::string_view key,
     std::string_view dname,
@@ -2232,11 +2270,13 @@ CDentry *CDir::_load_dentry(
 }
 
 void CDir::_omap_fetched(bufferlist& hdrbl, map<string, bufferlist>& omap,
-			 bool complete, const std::set<string>& keys, int r)
+			 bool complete, const std::set<string>& keys, int r,
+			 bool more)
 {
   LogChannelRef clog = mdcache->mds->clog;
   dout(10) << "_fetched header " << hdrbl.length() << " bytes "
-	   << omap.size() << " keys for " << *this << dendl;
+	   << omap.size() << " keys for " << *this
+	   << (more ? ", more to come" : "") << dendl;
 
   ceph_assert(r == 0 || r == -ENOENT || r == -ENODATA);
   ceph_assert(is_auth());
@@ -2416,11 +2456,16 @@ void CDir::_omap_fetched(bufferlist& hdrbl, map<string, bufferlist>& omap,
       undef_inodes.push_back(dnl->get_referent_inode());
   }
 
-  if (complete) {
+  // if dentries loaded with earlier pages have been trimmed, we can't tell
+  // which keys are missing.
+  bool pages_trimmed = state_test(STATE_FETCHPAGED) &&
+		       state_test(STATE_FETCHTRIMMED);
+
+  if (complete && !more) {
     if (!waiting_on_dentry.empty()) {
       for (auto &p : waiting_on_dentry) {
 	std::copy(p.second.begin(), p.second.end(), std::back_inserter(finished));
-	if (p.first.snapid == CEPH_NOSNAP)
+	if (p.first.snapid == CEPH_NOSNAP && !pages_trimmed)
 	  null_keys.emplace_back(p.first);
       }
       waiting_on_dentry.clear();
@@ -2450,9 +2495,14 @@ void CDir::_omap_fetched(bufferlist& hdrbl, map<string, bufferlist>& omap,
   //cache->mds->logger->inc("newin", num_new_inodes_loaded);
 
   // mark complete, !fetching
-  if (complete) {
-    mark_complete();
-    state_clear(STATE_FETCHING);
+  if (complete && !more) {
+    if (pages_trimmed) {
+      dout(10) << "_fetched some pages were trimmed, not complete" << dendl;
+      state_clear(STATE_FETCHING | STATE_FETCHPAGED);
+    } else {
+      mark_complete();
+      state_clear(STATE_FETCHING | STATE_FETCHPAGED | STATE_FETCHTRIMMED);
+    }
     take_waiting(WAIT_COMPLETE, finished);
   }
 
@@ -2472,7 +2522,8 @@ void CDir::_omap_fetched(bufferlist& hdrbl, map<string, bufferlist>& omap,
   if (force_dirty && !mdcache->is_readonly())
     log_mark_dirty();
 
-  auth_unpin(this);
+  if (!more)
+    auth_unpin(this);
 
   if (!finished.empty())
     mdcache->mds->queue_waiters(finished);
@@ -2513,7 +2564,7 @@ void CDir::go_bad(bool complete)
     mark_complete();
   }
 
-  state_clear(STATE_FETCHING);
+  state_clear(STATE_FETCHING | STATE_FETCHPAGED | STATE_FETCHTRIMMED);
   auth_unpin(this);
   finish_waiting(WAIT_COMPLETE, -EIO);
 }
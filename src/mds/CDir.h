@@ -144,6 +144,8 @@ public:
   static const unsigned STATE_BADFRAG =       (1<<17);  // bad dirfrag
   static const unsigned STATE_TRACKEDBYOFT =  (1<<18);  // tracked by open file table
   static const unsigned STATE_AUXSUBTREE =    (1<<19);  // no subtree merge
+  static const unsigned STATE_FETCHPAGED =    (1<<20);  // fetch loads pages as they arrive
+  static const unsigned STATE_FETCHTRIMMED =  (1<<21);  // dentries of a paged fetch were trimmed
 
   // common states
   static const unsigned STATE_CLEAN =  0;
@@ -670,7 +672,8 @@ protected:
 
   void _omap_fetch(std::set<std::string> *keys, MDSContext *fin=nullptr);
   void _omap_fetch_more(version_t omap_version, bufferlist& hdrbl,
-			std::map<std::string, bufferlist>& omap, MDSContext *fin);
+			std::map<std::string, bufferlist>& omap,
+			const std::string& after, MDSContext *fin);
   CDentry *_load_dentry(
       std::string_view key,
       std::string_view dname,
@@ -687,7 +690,10 @@ protected:
   void go_bad(bool complete);
 
   void _omap_fetched(ceph::buffer::list& hdrbl, std::map<std::string, ceph::buffer::list>& omap,
-		     bool complete, const std::set<std::string>& keys, int r);
+		     bool complete, const std::set<std::string>& keys, int r,
+		     bool more=false);
+  bool _omap_fetched_page(ceph::buffer::list& hdrbl,
+			  std::map<std::string, ceph::buffer::list>& omap, int r);
 
   // -- commit --
   void _commit(version_t want, int op_prio);
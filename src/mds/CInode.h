@@ -424,7 +424,8 @@ class CInode : public MDSCacheObject, public InodeStoreBase, public Counter<CIno
   CInode(MDCache *c, bool auth=true, snapid_t f=2, snapid_t l=CEPH_NOSNAP);
   ~CInode() override;
 
-  std::map<int, std::unique_ptr<BatchOp>> batch_ops;
+  // almost always empty: only allocated while getattr ops batch
+  mempool::mds_co::compact_map<int, std::unique_ptr<BatchOp>> batch_ops;
 
   std::string_view pin_name(int p) const override;
 
@@ -1098,7 +1099,7 @@ class CInode : public MDSCacheObject, public InodeStoreBase, public Counter<CIno
   // list item node for when we have unpropagated rstat data
   elist<CInode*>::item dirty_rstat_item;
 
-  mempool::mds_co::set<client_t> client_snap_caps;
+  mempool::mds_co::compact_set<client_t> client_snap_caps;
   mempool::mds_co::compact_map<snapid_t, mempool::mds_co::set<client_t> > client_need_snapflush;
 
   // LogSegment lists i (may) belong to
@@ -4558,15 +4558,18 @@ void Locker::issue_client_lease(CDentry *dn, CInode *in, const MDRequestRef& mdr
     lstat.mask = CEPH_LEASE_VALID | mask;
     lstat.duration_ms = (uint32_t)(1000 * mdcache->client_lease_durations[pool]);
     lstat.seq = ++l->seq;
-    lstat.alternate_name = std::string(dn->alternate_name);
+    lstat.alternate_name = std::string(dn->get_alternate_name());
     encode_lease(bl, session->info, lstat);
     dout(20) << "issue_client_lease seq " << lstat.seq << " dur " << lstat.duration_ms << "ms "
 	     << " on " << *dn << dendl;
   } else {
-    // null lease
+    // null lease; still tell the client whether this is the primary link,
+    // which it needs to unlink asynchronously under the dir caps
     LeaseStat lstat;
     lstat.mask = 0;
-    lstat.alternate_name = std::string(dn->alternate_name);
+    if (dn->get_linkage(client, mdr)->is_primary())
+      lstat.mask = CEPH_LEASE_PRIMARY_LINK;
+    lstat.alternate_name = std::string(dn->get_alternate_name());
     encode_lease(bl, session->info, lstat);
     dout(20) << "issue_client_lease no/null lease on " << *dn << dendl;
   }
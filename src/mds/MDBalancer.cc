@@ -333,6 +333,11 @@ double mds_load_t::mds_load(int64_t bal_mode) const
   case 2:
     return cpu_load_avg;
 
+  case 3:
+    // everything we spent serving requests, replicated reads included;
+    // prep_rebalance() rescales this to the auth subtrees we can export
+    return all.cpu_load();
+
   }
   ceph_abort();
   return 0;
@@ -447,6 +452,17 @@ int MDBalancer::localize_balancer()
   return r;
 }
 
+map<string, double> MDBalancer::get_load_metrics(const mds_load_t& load)
+{
+  return {{"auth.meta_load", load.auth.meta_load()},
+          {"all.meta_load", load.all.meta_load()},
+          {"auth.cpu_load", load.auth.cpu_load()},
+          {"all.cpu_load", load.all.cpu_load()},
+          {"req_rate", load.req_rate},
+          {"queue_len", load.queue_len},
+          {"cpu_load_avg", load.cpu_load_avg}};
+}
+
 void MDBalancer::send_heartbeat()
 {
   if (mds->is_cluster_degraded()) {
@@ -481,7 +497,7 @@ void MDBalancer::send_heartbeat()
     mds_rank_t from = im->inode->authority().first;
     if (from == mds->get_nodeid()) continue;
     if (im->get_inode()->is_stray()) continue;
-    import_map[from] += im->pop_auth_subtree.meta_load();
+    import_map[from] += subtree_load(im->pop_auth_subtree);
   }
   mds_import_map[ mds->get_nodeid() ] = import_map;
 
@@ -561,6 +577,16 @@ void MDBalancer::handle_heartbeat(const cref_t<MHeartbeat> &m)
   {
     unsigned cluster_size = mds->get_mds_map()->get_num_in_mds();
     if (mds_load.size() == cluster_size) {
+      // one line per rank and epoch; ceph_test_mds_balancer_replay reads
+      // these back to compare balancer policies offline
+      for (const auto& [rank, load] : mds_load) {
+        dout(5) << "trace epoch " << m->get_beat() << " mds." << rank;
+        for (const auto& [name, value] : get_load_metrics(load)) {
+          *_dout << " " << name << "=" << value;
+        }
+        *_dout << dendl;
+      }
+
       // let's go!
       //export_empties();  // no!
 
@@ -771,11 +797,11 @@ void MDBalancer::prep_rebalance(int beat)
 
     mds->mdcache->migrator->clear_export_queue();
 
-    // rescale!  turn my mds_load back into meta_load units
+    // rescale!  turn my mds_load back into meta_load (or cpu_load) units
     double load_fac = 1.0;
     map<mds_rank_t, mds_load_t>::iterator m = mds_load.find(whoami);
     if ((m != mds_load.end()) && (m->second.mds_load(bal_mode) > 0)) {
-      double metald = m->second.auth.meta_load();
+      double metald = subtree_load(m->second.auth);
       double mdsld = m->second.mds_load(bal_mode);
       load_fac = metald / mdsld;
       dout(7) << " load_fac is " << load_fac
@@ -947,13 +973,7 @@ int MDBalancer::mantle_prep_rebalance()
   /* fill in the metrics for each mds by grabbing load struct */
   vector < map<string, double> > metrics (cluster_size);
   for (mds_rank_t i=mds_rank_t(0); i < mds_rank_t(cluster_size); i++) {
-    mds_load_t& load = mds_load.at(i);
-
-    metrics[i] = {{"auth.meta_load", load.auth.meta_load()},
-                  {"all.meta_load", load.all.meta_load()},
-                  {"req_rate", load.req_rate},
-                  {"queue_len", load.queue_len},
-                  {"cpu_load_avg", load.cpu_load_avg}};
+    metrics[i] = get_load_metrics(mds_load.at(i));
   }
 
   /* execute the balancer */
@@ -981,6 +1001,10 @@ void MDBalancer::try_rebalance(balance_state_t& state)
     return;
   }
 
+  // forget imports that have settled
+  recent_imports.trim(clock::now(), clock::duration(
+    g_conf().get_val<std::chrono::seconds>("mds_bal_reexport_hold")));
+
   // make a sorted list of my imports
   multimap<double, CDir*> import_pop_map;
   multimap<mds_rank_t, pair<CDir*, double> > import_from_map;
@@ -993,9 +1017,15 @@ void MDBalancer::try_rebalance(balance_state_t& state)
       continue;
     if (dir->is_freezing() || dir->is_frozen())
       continue;  // export pbly already in progress
+    if (recent_imports.is_held(dir->dirfrag())) {
+      // its load has not settled here yet; moving it (or part of it) on
+      // now is how subtrees end up bouncing between ranks
+      dout(15) << "  holding recent import " << *dir << dendl;
+      continue;
+    }
 
     mds_rank_t from = diri->authority().first;
-    double pop = dir->pop_auth_subtree.meta_load();
+    double pop = subtree_load(dir->pop_auth_subtree);
     const auto bal_idle_threshold = g_conf().get_val<double>("mds_bal_idle_threshold");
     if (bal_idle_threshold > 0 &&
 	pop < bal_idle_threshold &&
@@ -1133,7 +1163,7 @@ void MDBalancer::try_rebalance(balance_state_t& state)
 
     for (const auto& dir : exports) {
       dout(5) << "   - exporting " << dir->pop_auth_subtree
-	      << " " << dir->pop_auth_subtree.meta_load()
+	      << " " << subtree_load(dir->pop_auth_subtree)
 	      << " to mds." << target << " " << *dir << dendl;
       mds->mdcache->migrator->export_dir_nicely(dir, target);
     }
@@ -1172,7 +1202,7 @@ void MDBalancer::find_exports(CDir *dir,
   std::vector<CDir*> bigger_rep, bigger_unrep;
   multimap<double, CDir*> smaller;
 
-  double dir_pop = dir->pop_auth_subtree.meta_load();
+  double dir_pop = subtree_load(dir->pop_auth_subtree);
   dout(7) << "in " << dir_pop << " " << *dir << " need " << need << " (" << needmin << " - " << needmax << ")" << dendl;
 
   double subdir_sum = 0;
@@ -1198,7 +1228,7 @@ void MDBalancer::find_exports(CDir *dir,
 	continue;  // can't export this right now!
 
       // how popular?
-      double pop = subdir->pop_auth_subtree.meta_load();
+      double pop = subtree_load(subdir->pop_auth_subtree);
       subdir_sum += pop;
       dout(15) << "   subdir pop " << pop << " " << *subdir << dendl;
 
@@ -1426,6 +1456,9 @@ void MDBalancer::add_import(CDir *dir)
 {
   dirfrag_load_vec_t subload = dir->pop_auth_subtree;
 
+  if (g_conf().get_val<std::chrono::seconds>("mds_bal_reexport_hold").count() > 0)
+    recent_imports.add(dir->dirfrag(), clock::now());
+
   while (true) {
     dir = dir->inode->get_parent_dir();
     if (!dir) break;
@@ -37,6 +37,44 @@ class Messenger;
 class MonClient;
 class Message;
 
+/*
+ * Subtrees imported within mds_bal_reexport_hold.  Their load has not
+ * been measured on this rank yet, so neither they nor any fragment split
+ * off them are exported again until the hold runs out.
+ */
+class ReexportHold {
+public:
+  using clock = ceph::coarse_mono_clock;
+  using time = ceph::coarse_mono_time;
+
+  void add(dirfrag_t df, time now) {
+    imports[df] = now;
+  }
+  // forget imports that have been here for at least @a hold
+  void trim(time now, clock::duration hold) {
+    for (auto p = imports.begin(); p != imports.end(); ) {
+      if (now - p->second >= hold)
+        p = imports.erase(p);
+      else
+        ++p;
+    }
+  }
+  bool is_held(dirfrag_t df) const {
+    for (auto p = imports.lower_bound(dirfrag_t(df.ino, frag_t()));
+         p != imports.end() && p->first.ino == df.ino; ++p) {
+      if (p->first.frag.contains(df.frag))
+        return true;
+    }
+    return false;
+  }
+  size_t size() const {
+    return imports.size();
+  }
+
+private:
+  std::map<dirfrag_t, time> imports;
+};
+
 class MDBalancer {
 public:
   using clock = ceph::coarse_mono_clock;
@@ -95,6 +133,10 @@ public:
   double get_bal_fragment_fast_factor() const {
     return bal_fragment_fast_factor;
   }
+  // whether the server should time requests for META_POP_CPU
+  bool get_bal_charge_cpu() const {
+    return bal_mode == 3;
+  }
 
 private:
   typedef struct {
@@ -111,6 +153,7 @@ private:
   int mantle_prep_rebalance();
 
   mds_load_t get_load();
+  static std::map<std::string, double> get_load_metrics(const mds_load_t& load);
   int localize_balancer();
   void send_heartbeat();
   void handle_heartbeat(const cref_t<MHeartbeat> &m);
@@ -124,6 +167,11 @@ private:
                    mds_rank_t ex, double& maxex,
                    mds_rank_t im, double& maxim);
 
+  // the load of a subtree, in the units bal_mode balances
+  double subtree_load(const dirfrag_load_vec_t& pop) const {
+    return bal_mode == 3 ? pop.cpu_load() : pop.meta_load();
+  }
+
   double get_maxim(balance_state_t &state, mds_rank_t im, double im_target_load) {
     return im_target_load - mds_meta_load[im] - state.imported[im];
   }
@@ -182,6 +230,8 @@ private:
   // dirfrags that already have one in flight.
   std::set<dirfrag_t> split_pending, merge_pending;
 
+  ReexportHold recent_imports;
+
   // per-epoch scatter/gathered info
   std::map<mds_rank_t, mds_load_t> mds_load;
   std::map<mds_rank_t, double> mds_meta_load;
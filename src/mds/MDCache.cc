@@ -1724,7 +1724,7 @@ void MDCache::journal_cow_dentry(MutationImpl *mut, EMetaBlob *metablob,
             dout(10) << __func__ << " lookout-1 - Adding dentry as remote for journal when referent inode feature is enabled !!! "
 	             << " dentry " << *dn << " first " << oldfirst << " last " << dir_follows << dendl;
 	  }
-	  CDentry *olddn = dir->add_remote_dentry(dn->get_name(), nullptr, in->ino(), in->d_type(), dn->alternate_name, oldfirst, dir_follows);
+	  CDentry *olddn = dir->add_remote_dentry(dn->get_name(), nullptr, in->ino(), in->d_type(), mempool::mds_co::string(dn->get_alternate_name()), oldfirst, dir_follows);
 	  dout(10) << " olddn " << *olddn << dendl;
 	  ceph_assert(dir->is_projected());
 	  olddn->set_projected_version(dir->get_projected_version());
@@ -1798,7 +1798,7 @@ void MDCache::journal_cow_dentry(MutationImpl *mut, EMetaBlob *metablob,
       mut->add_cow_inode(oldin);
       if (pcow_inode)
 	*pcow_inode = oldin;
-      CDentry *olddn = dir->add_primary_dentry(dn->get_name(), oldin, dn->alternate_name, oldfirst, follows);
+      CDentry *olddn = dir->add_primary_dentry(dn->get_name(), oldin, mempool::mds_co::string(dn->get_alternate_name()), oldfirst, follows);
       dout(10) << " olddn " << *olddn << dendl;
       bool need_snapflush = !oldin->client_snap_caps.empty();
       if (need_snapflush) {
@@ -1818,7 +1818,7 @@ void MDCache::journal_cow_dentry(MutationImpl *mut, EMetaBlob *metablob,
         dout(10) << __func__ << " lookout-2 - Adding dentry as remote for journal when referent inode feature is enabled !!! "
 	         << " dentry " << *dn << " first " << oldfirst << " last " << follows << dendl;
       }
-      CDentry *olddn = dir->add_remote_dentry(dn->get_name(), nullptr, dnl->get_remote_ino(), dnl->get_remote_d_type(), dn->alternate_name, oldfirst, follows);
+      CDentry *olddn = dir->add_remote_dentry(dn->get_name(), nullptr, dnl->get_remote_ino(), dnl->get_remote_d_type(), mempool::mds_co::string(dn->get_alternate_name()), oldfirst, follows);
       dout(10) << " olddn " << *olddn << dendl;
 
       olddn->set_projected_version(dir->get_projected_version());
@@ -7325,6 +7325,8 @@ bool MDCache::trim_dentry(CDentry *dn, expiremap& expiremap)
     if (dn->last == CEPH_NOSNAP)
       dir->add_to_bloom(dn);
     dir->state_clear(CDir::STATE_COMPLETE);
+    if (dir->state_test(CDir::STATE_FETCHPAGED))
+      dir->state_set(CDir::STATE_FETCHTRIMMED);
   }
 
   // remove dentry
@@ -11220,7 +11222,7 @@ void MDCache::encode_replica_dentry(CDentry *dn, mds_rank_t to, bufferlist& bl)
   dn->lock.encode_state_for_replica(bl);
   bool need_recover = mds->get_state() < MDSMap::STATE_ACTIVE;
   encode(need_recover, bl);
-  encode(dn->alternate_name, bl);
+  encode(dn->get_alternate_name(), bl);
   encode(dn->linkage.referent_ino, bl);
   ENCODE_FINISH(bl);
 }
@@ -11345,7 +11347,7 @@ void MDCache::decode_replica_dentry(CDentry *&dn, bufferlist::const_iterator& p,
     if (need_recover)
       dn->lock.mark_need_recover();
   } else {
-    ceph_assert(dn->alternate_name == alternate_name);
+    ceph_assert(dn->get_alternate_name() == alternate_name);
   }
 
   dir->take_dentry_waiting(name, dn->first, dn->last, finished);
@@ -13236,8 +13238,22 @@ void MDCache::cache_status(Formatter *f)
 {
   f->open_object_section("cache");
 
+  auto& pool = mempool::get_pool(mempool::mds_co::id);
   f->open_object_section("pool");
-  mempool::get_pool(mempool::mds_co::id).dump(f);
+  pool.dump(f);
+  f->close_section();
+
+  // what caching metadata costs, to compare in-memory layouts by
+  uint64_t inodes = CInode::count();
+  f->dump_unsigned("inodes", inodes);
+  f->dump_unsigned("dentries", CDentry::count());
+  f->dump_unsigned("dirfrags", CDir::count());
+  f->dump_unsigned("bytes_per_inode",
+                   inodes ? pool.allocated_bytes() / inodes : 0);
+  f->open_object_section("object_size");
+  f->dump_unsigned("inode", sizeof(CInode));
+  f->dump_unsigned("dentry", sizeof(CDentry));
+  f->dump_unsigned("dirfrag", sizeof(CDir));
   f->close_section();
 
   f->close_section();
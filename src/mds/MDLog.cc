@@ -27,6 +27,7 @@
 #include "common/perf_counters.h"
 #include "common/Cond.h"
 #include "common/ceph_time.h"
+#include "common/Thread.h"
 
 #include "events/ESubtreeMap.h"
 #include "events/ESegment.h"
@@ -36,6 +37,8 @@
 #include "common/errno.h"
 #include "include/ceph_assert.h"
 
+#include <deque>
+
 #define dout_context g_ceph_context
 #define dout_subsys ceph_subsys_mds
 #undef dout_prefix
@@ -1413,20 +1416,190 @@ void MDLog::_reformat_journal(JournalPointer const &jp_in, Journaler *old_journa
 }
 
 
-// i am a separate thread
-void MDLog::_replay_thread()
+namespace {
+uint64_t ns_since(ceph::mono_time start)
 {
-  dout(10) << __func__ << ": start time: " << replay_start_time << ", now: "
-           << ceph::coarse_mono_clock::now() << dendl;
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    ceph::mono_clock::now() - start).count();
+}
+} // anonymous namespace
 
-  // loop
+/*
+ * Reads journal entries ahead of the replay thread and decodes them on a
+ * set of worker threads, handing them to the replay thread in journal
+ * order.  The replay thread is left with applying the events.
+ *
+ * The reader stops at the end of the journal or on the first error,
+ * without handling it: once every entry read has been handed out, the
+ * replay thread carries on reading by itself and deals with the error.
+ */
+class MDLog::ReplayPrefetcher {
+public:
+  ReplayPrefetcher(MDLog *log, unsigned num_decoders, uint64_t max_bytes)
+    : log(log), num_decoders(num_decoders), max_bytes(max_bytes) {}
+  ~ReplayPrefetcher() {
+    stop();
+  }
+
+  void start() {
+    reader = make_named_thread("mds-log-prefetch",
+                               &ReplayPrefetcher::read_entries, this);
+    for (unsigned i = 0; i < num_decoders; ++i) {
+      decoders.push_back(make_named_thread("mds-log-decode",
+                                           &ReplayPrefetcher::decode_entries,
+                                           this));
+    }
+  }
+
+  void stop() {
+    {
+      std::lock_guard l(lock);
+      stopping = true;
+    }
+    read_cond.notify_all();
+    decode_cond.notify_all();
+    if (reader.joinable()) {
+      reader.join();
+    }
+    for (auto& t : decoders) {
+      t.join();
+    }
+    decoders.clear();
+  }
+
+  // wait for the next entry.  false once the reader has stopped and all
+  // the entries it read have been handed out.
+  bool get(uint64_t& pos, uint64_t& end, bufferlist& bl,
+           std::unique_ptr<LogEvent>& le) {
+    auto start = ceph::mono_clock::now();
+    std::unique_lock l(lock);
+    apply_cond.wait(l, [this] {
+      return entries.empty() ? reading_done : entries.front()->decoded;
+    });
+    log->replay_apply_wait_ns += ns_since(start);
+    if (entries.empty()) {
+      return false;
+    }
+
+    auto e = std::move(entries.front());
+    entries.pop_front();
+    ++front_seq;
+    queued_bytes -= e->bl.length();
+    l.unlock();
+    read_cond.notify_one();
+
+    pos = e->pos;
+    end = e->end;
+    bl = std::move(e->bl);
+    le = std::move(e->le);
+    return true;
+  }
+
+private:
+  struct Entry {
+    uint64_t pos = 0;
+    uint64_t end = 0;  // read pos after this entry
+    bufferlist bl;
+    std::unique_ptr<LogEvent> le;
+    bool decoded = false;
+  };
+
+  void read_entries() {
+    Journaler *journaler = log->journaler;
+    while (true) {
+      {
+        std::unique_lock l(lock);
+        read_cond.wait(l, [this] {
+          return stopping || queued_bytes < max_bytes;
+        });
+        if (stopping) {
+          break;
+        }
+      }
+
+      auto start = ceph::mono_clock::now();
+      journaler->check_isreadable();
+      if (journaler->get_error() ||
+          journaler->get_read_pos() == journaler->get_write_pos()) {
+        break;
+      }
+      auto e = std::make_unique<Entry>();
+      e->pos = journaler->get_read_pos();
+      if (!journaler->try_read_entry(e->bl)) {
+        break;
+      }
+      e->end = journaler->get_read_pos();
+      log->replay_read_ns += ns_since(start);
+
+      std::lock_guard l(lock);
+      queued_bytes += e->bl.length();
+      entries.push_back(std::move(e));
+      decode_cond.notify_one();
+    }
+
+    std::lock_guard l(lock);
+    reading_done = true;
+    decode_cond.notify_all();
+    apply_cond.notify_all();
+  }
+
+  void decode_entries() {
+    std::unique_lock l(lock);
+    while (true) {
+      decode_cond.wait(l, [this] {
+        return stopping || reading_done ||
+               next_decode < front_seq + entries.size();
+      });
+      if (stopping) {
+        break;
+      }
+      if (next_decode == front_seq + entries.size()) {
+        ceph_assert(reading_done);
+        break;
+      }
+
+      // entries are only handed out once decoded, so e stays put
+      Entry *e = entries[next_decode++ - front_seq].get();
+      l.unlock();
+      auto start = ceph::mono_clock::now();
+      e->le = LogEvent::decode_event(e->bl.cbegin());
+      log->replay_decode_ns += ns_since(start);
+      l.lock();
+      e->decoded = true;
+      if (e == entries.front().get()) {
+        apply_cond.notify_one();
+      }
+    }
+  }
+
+  MDLog *log;
+  const unsigned num_decoders;
+  const uint64_t max_bytes;
+
+  ceph::mutex lock = ceph::make_mutex("MDLog::ReplayPrefetcher::lock");
+  ceph::condition_variable read_cond;
+  ceph::condition_variable decode_cond;
+  ceph::condition_variable apply_cond;
+  std::deque<std::unique_ptr<Entry>> entries;
+  uint64_t front_seq = 0;    // seq of entries.front()
+  uint64_t next_decode = 0;  // seq of the next entry to decode
+  uint64_t queued_bytes = 0;
+  bool reading_done = false;
+  bool stopping = false;
+
+  std::thread reader;
+  std::vector<std::thread> decoders;
+};
+
+/*
+ * Read the next journal entry, waiting for it to become readable.
+ * Returns 0 with the entry, 1 at the end of the journal, or a negative
+ * error code once the journaler error has been dealt with.
+ */
+int MDLog::_replay_read_entry(uint64_t& pos, bufferlist& bl)
+{
   int r = 0;
   while (1) {
-    auto sleep_time = g_conf().get_val<std::chrono::milliseconds>("mds_delay_journal_replay_for_testing");
-    if (unlikely(sleep_time > 0ms)) {
-      dout(10) << __func__ << ": sleeping for " << sleep_time << "ms" << dendl;
-      std::this_thread::sleep_for(sleep_time);
-    }
     // wait for read?
     journaler->check_isreadable(); 
     if (journaler->get_error()) {
@@ -1466,7 +1639,7 @@ void MDLog::_replay_thread()
               r = -EAGAIN;
               dout(1) << "Journal header went away while in standby replay, journal rewritten?"
                       << dendl;
-              break;
+              return r;
             } else {
                 dout(0) << "got error while reading head: " << cpp_strerror(err)
                         << dendl;
@@ -1484,24 +1657,80 @@ void MDLog::_replay_thread()
           }
         }
       }
-      break;
+      return r;
     }
 
     if (journaler->get_read_pos() == journaler->get_write_pos()) {
       dout(10) << "_replay: read_pos == write_pos" << dendl;
-      break;
+      return 1;
     }
-    
+
     // read it
-    uint64_t pos = journaler->get_read_pos();
-    bufferlist bl;
-    bool r = journaler->try_read_entry(bl);
-    if (!r && journaler->get_error())
+    pos = journaler->get_read_pos();
+    bool ok = journaler->try_read_entry(bl);
+    if (!ok && journaler->get_error())
       continue;
-    ceph_assert(r);
-    
-    // unpack event
-    auto le = LogEvent::decode_event(bl.cbegin());
+    ceph_assert(ok);
+    return 0;
+  }
+}
+
+// i am a separate thread
+void MDLog::_replay_thread()
+{
+  dout(10) << __func__ << ": start time: " << replay_start_time << ", now: "
+           << ceph::coarse_mono_clock::now() << dendl;
+
+  replay_read_ns = 0;
+  replay_decode_ns = 0;
+  replay_apply_ns = 0;
+  replay_apply_wait_ns = 0;
+  replay_decode_threads = g_conf().get_val<uint64_t>("mds_replay_decode_threads");
+  journaler->set_prefetch_periods(
+    g_conf().get_val<uint64_t>("mds_replay_prefetch_periods"));
+
+  std::unique_ptr<ReplayPrefetcher> prefetcher;
+  if (replay_decode_threads > 0) {
+    prefetcher = std::make_unique<ReplayPrefetcher>(
+      this, replay_decode_threads,
+      g_conf().get_val<Option::size_t>("mds_replay_prefetch_bytes"));
+    prefetcher->start();
+  }
+
+  // loop
+  int r = 0;
+  while (1) {
+    auto sleep_time = g_conf().get_val<std::chrono::milliseconds>("mds_delay_journal_replay_for_testing");
+    if (unlikely(sleep_time > 0ms)) {
+      dout(10) << __func__ << ": sleeping for " << sleep_time << "ms" << dendl;
+      std::this_thread::sleep_for(sleep_time);
+    }
+
+    uint64_t pos = 0;
+    uint64_t end = 0;
+    bufferlist bl;
+    std::unique_ptr<LogEvent> le;
+    if (!prefetcher || !prefetcher->get(pos, end, bl, le)) {
+      // the prefetcher stopped at the end of the journal or on an error
+      // and everything it read has been applied: carry on by ourselves.
+      prefetcher.reset();
+
+      auto start = ceph::mono_clock::now();
+      r = _replay_read_entry(pos, bl);
+      if (r != 0) {
+        if (r > 0)
+          r = 0;
+        break;
+      }
+      end = journaler->get_read_pos();
+      replay_read_ns += ns_since(start);
+
+      // unpack event
+      start = ceph::mono_clock::now();
+      le = LogEvent::decode_event(bl.cbegin());
+      replay_decode_ns += ns_since(start);
+    }
+
     if (!le) {
       dout(0) << "_replay " << pos << "~" << bl.length() << " / " << journaler->get_write_pos() 
 	      << " -- unable to decode event" << dendl;
@@ -1570,10 +1799,11 @@ void MDLog::_replay_thread()
              << " " << le->get_stamp() << ": " << *le << dendl;
     le->_segment = get_current_segment();    // replay may need this
     le->_segment->num_events++;
-    le->_segment->end = journaler->get_read_pos();
+    le->_segment->end = end;
     num_events++;
     logger->set(l_mdl_ev, num_events);
 
+    auto apply_start = ceph::mono_clock::now();
     {
       std::lock_guard l(mds->mds_lock);
       if (mds->is_daemon_stopping()) {
@@ -1582,12 +1812,16 @@ void MDLog::_replay_thread()
       logger->inc(l_mdl_replayed);
       le->replay(mds);
     }
+    replay_apply_ns += ns_since(apply_start);
+    replay_apply_pos = end;
 
     logger->set(l_mdl_rdpos, pos);
     logger->set(l_mdl_expos, journaler->get_expire_pos());
     logger->set(l_mdl_wrpos, journaler->get_write_pos());
   }
 
+  journaler->set_prefetch_periods(0);
+
   // done!
   if (r == 0) {
     ceph_assert(journaler->get_read_pos() == journaler->get_write_pos());
@@ -1660,6 +1894,14 @@ void MDLog::dump_replay_status(Formatter *f) const
   f->dump_unsigned("journal_expire_pos", journaler ? journaler->get_expire_pos() : 0);
   f->dump_unsigned("num_events", get_num_events());
   f->dump_unsigned("num_segments", get_num_segments());
+  f->dump_unsigned("journal_apply_pos", replay_apply_pos);
+  f->dump_unsigned("decode_threads", replay_decode_threads);
+  f->open_object_section("phase_time_sec");
+  f->dump_float("read", replay_read_ns / 1e9);
+  f->dump_float("decode", replay_decode_ns / 1e9);
+  f->dump_float("apply", replay_apply_ns / 1e9);
+  f->dump_float("apply_wait", replay_apply_wait_ns / 1e9);
+  f->close_section();
   f->close_section();
 }
 
@@ -233,7 +233,11 @@ protected:
     MDLog *log;
   } submit_thread;
 
+  // reads and decodes journal entries ahead of the replay thread
+  class ReplayPrefetcher;
+
   friend class ReplayThread;
+  friend class ReplayPrefetcher;
   friend class C_MDL_Replay;
   friend class MDSLogContextBase;
   friend class SubmitThread;
@@ -243,6 +247,7 @@ protected:
 
   void _replay();         // old way
   void _replay_thread();  // new way
+  int _replay_read_entry(uint64_t& pos, bufferlist& bl);
 
   void _recovery_thread(MDSContext *completion);
   void _reformat_journal(JournalPointer const &jp, Journaler *old_journal, MDSContext *completion);
@@ -341,5 +346,15 @@ private:
   std::map<uint64_t, std::vector<Context*>> waiting_for_expire; // protected by mds_lock
 
   ceph::coarse_mono_time replay_start_time = ceph::coarse_mono_clock::zero();
+
+  // time spent in each replay phase, in ns.  decode time is summed over
+  // the decode threads; apply_wait is the time the replay thread spent
+  // waiting for the next decoded event.
+  std::atomic<uint64_t> replay_read_ns{0};
+  std::atomic<uint64_t> replay_decode_ns{0};
+  std::atomic<uint64_t> replay_apply_ns{0};
+  std::atomic<uint64_t> replay_apply_wait_ns{0};
+  std::atomic<uint64_t> replay_apply_pos{0};
+  std::atomic<unsigned> replay_decode_threads{0};
 };
 #endif
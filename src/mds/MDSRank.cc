@@ -3753,6 +3753,8 @@ void MDSRank::create_logger()
 			    "dir_fetch_complete", "Fetch complete dirfrag");
     mds_plb.add_u64_counter(l_mds_dir_fetch_keys,
 			    "dir_fetch_keys", "Fetch keys from dirfrag");
+    mds_plb.add_u64_counter(l_mds_dir_fetch_page,
+			    "dir_fetch_page", "Dirfrag pages loaded before the fetch completed");
     mds_plb.add_u64_counter(l_mds_dir_commit, "dir_commit", "Directory commit");
     mds_plb.add_u64_counter(l_mds_dir_split, "dir_split", "Directory split");
     mds_plb.add_u64_counter(l_mds_dir_merge, "dir_merge", "Directory merge");
@@ -4113,6 +4115,7 @@ std::vector<std::string> MDSRankDispatcher::get_tracked_keys()
     "host",
     "mds_allow_async_dirops",
     "mds_allow_batched_ops",
+    "mds_allow_fast_getattr",
     "mds_alternate_name_max",
     "mds_bal_export_pin",
     "mds_bal_fragment_dirs",
@@ -55,6 +55,7 @@ enum {
   l_mds_forward,
   l_mds_dir_fetch_complete,
   l_mds_dir_fetch_keys,
+  l_mds_dir_fetch_page,
   l_mds_dir_commit,
   l_mds_dir_split,
   l_mds_dir_merge,
@@ -1949,7 +1949,7 @@ void Migrator::encode_export_dir(bufferlist& exportbl,
     if (dn->get_linkage()->is_remote()) {
       inodeno_t ino = dn->get_linkage()->get_remote_ino();
       unsigned char d_type = dn->get_linkage()->get_remote_d_type();
-      auto& alternate_name = dn->alternate_name;
+      auto alternate_name = dn->get_alternate_name();
       // remote link
       CDentry::encode_remote(ino, d_type, alternate_name, exportbl);
       continue;
@@ -1961,7 +1961,7 @@ void Migrator::encode_export_dir(bufferlist& exportbl,
       exportbl.append("r", 1);    // referent inode dentry
       ENCODE_START(2, 1, exportbl);
       encode_export_inode(ref_in, exportbl, exported_client_map, exported_client_metadata_map);  // encode, and (update state for) export
-      encode(dn->alternate_name, exportbl);
+      encode(dn->get_alternate_name(), exportbl);
       ENCODE_FINISH(exportbl);
       continue;
     }
@@ -1971,7 +1971,7 @@ void Migrator::encode_export_dir(bufferlist& exportbl,
 
     ENCODE_START(2, 1, exportbl);
     encode_export_inode(in, exportbl, exported_client_map, exported_client_metadata_map);  // encode, and (update state for) export
-    encode(dn->alternate_name, exportbl);
+    encode(dn->get_alternate_name(), exportbl);
     ENCODE_FINISH(exportbl);
 
     // directory?
@@ -3734,7 +3734,9 @@ void Migrator::decode_import_dir(bufferlist::const_iterator& blp,
         decode_import_inode(dn, blp, oldauth, ls,
                             peer_exports, updated_scatterlocks);
         ceph_assert(!dn->is_projected());
-        decode(dn->alternate_name, blp);
+        mempool::mds_co::string alternate_name;
+        decode(alternate_name, blp);
+        dn->set_alternate_name(std::move(alternate_name));
         DECODE_FINISH(blp);
       } else {
         decode_import_inode(dn, blp, oldauth, ls,
@@ -3749,7 +3751,9 @@ void Migrator::decode_import_dir(bufferlist::const_iterator& blp,
         decode_import_inode(dn, blp, oldauth, ls,
                             peer_exports, updated_scatterlocks);
         ceph_assert(!dn->is_projected());
-        decode(dn->alternate_name, blp);
+        mempool::mds_co::string alternate_name;
+        decode(alternate_name, blp);
+        dn->set_alternate_name(std::move(alternate_name));
         DECODE_FINISH(blp);
       } else {
         decode_import_inode(dn, blp, oldauth, ls,
@@ -207,6 +207,11 @@ void Server::create_logger()
   plb.add_u64_counter(l_mdss_cap_acquisition_throttle,
                       "cap_acquisition_throttle", "Cap acquisition throttle counter", "cat",
                       PerfCountersBuilder::PRIO_INTERESTING);
+  plb.add_u64_counter(l_mdss_req_getattr_fast, "req_getattr_fast",
+                      "Lookup/getattr requests that took all locks at once", "gfst",
+                      PerfCountersBuilder::PRIO_INTERESTING);
+  plb.add_u64_counter(l_mdss_req_getattr_fast_miss, "req_getattr_fast_miss",
+                      "Lookup/getattr requests whose locks were not readable at once");
 
   // fop latencies are useful
   plb.set_prio_default(PerfCountersBuilder::PRIO_USEFUL);
@@ -293,6 +298,7 @@ Server::Server(MDSRank *m, MetricsHandler *metrics_handler) :
   forward_all_requests_to_auth = g_conf().get_val<bool>("mds_forward_all_requests_to_auth");
   replay_unsafe_with_closed_session = g_conf().get_val<bool>("mds_replay_unsafe_with_closed_session");
   allow_batched_ops = g_conf().get_val<bool>("mds_allow_batched_ops");
+  allow_fast_getattr = g_conf().get_val<bool>("mds_allow_fast_getattr");
   cap_revoke_eviction_timeout = g_conf().get_val<double>("mds_cap_revoke_eviction_timeout");
   max_snaps_per_dir = g_conf().get_val<uint64_t>("mds_max_snaps_per_dir");
   delegate_inos_pct = g_conf().get_val<uint64_t>("mds_client_delegate_inos_pct");
@@ -1398,6 +1404,9 @@ void Server::handle_conf_change(const std::set<std::string>& changed) {
   if (changed.count("mds_allow_batched_ops")) {
     allow_batched_ops = g_conf().get_val<bool>("mds_allow_batched_ops");
   }
+  if (changed.count("mds_allow_fast_getattr")) {
+    allow_fast_getattr = g_conf().get_val<bool>("mds_allow_fast_getattr");
+  }
   if (changed.count("mds_cap_revoke_eviction_timeout")) {
     cap_revoke_eviction_timeout = g_conf().get_val<double>("mds_cap_revoke_eviction_timeout");
     dout(20) << __func__ << " cap revoke eviction timeout changed to "
@@ -2749,7 +2758,55 @@ void Server::handle_osd_map()
     });
 }
 
+static double thread_cpu_ms()
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+/*
+ * Charge CPU time spent on a request to the dirfrag it works in: the one
+ * holding the dentry it names, or the one linking the inode it names.
+ * The balancer sums these up the tree like any other popularity counter.
+ */
+void Server::charge_request_cpu(const MDRequestRef& mdr, double ms)
+{
+  const filepath& path = mdr->client_request->get_filepath();
+  CInode *in = mdcache->get_inode(path.get_ino());
+  if (!in)
+    return;
+
+  CDir *dir = nullptr;
+  if (path.depth() > 0 && in->is_dir())
+    dir = in->get_dirfrag(in->pick_dirfrag(path[0]));
+  else if (in->get_parent_dn())
+    dir = in->get_parent_dn()->get_dir();
+  if (dir)
+    mds->balancer->hit_dir(dir, META_POP_CPU, ms);
+}
+
 void Server::dispatch_client_request(const MDRequestRef& mdr)
+{
+  if (!mds->balancer->get_bal_charge_cpu()) {
+    _dispatch_client_request(mdr);
+    return;
+  }
+
+  // requests dispatched from within this one (waiters it wakes up, or
+  // itself again) charge their own time; leave that out of ours
+  double outer_nested_ms = nested_dispatch_cpu_ms;
+  nested_dispatch_cpu_ms = 0;
+  double start = thread_cpu_ms();
+  _dispatch_client_request(mdr);
+  double own = thread_cpu_ms() - start - nested_dispatch_cpu_ms;
+
+  if (mdr->client_request && own > 0)
+    charge_request_cpu(mdr, own);
+  nested_dispatch_cpu_ms = outer_nested_ms + (thread_cpu_ms() - start);
+}
+
+void Server::_dispatch_client_request(const MDRequestRef& mdr)
 {
   // we shouldn't be waiting on anyone.
   ceph_assert(!mdr->has_more() || mdr->more()->waiting_on_peer.empty());
@@ -3900,6 +3957,87 @@ CInode* Server::rdlock_path_pin_ref(const MDRequestRef& mdr,
 }
 
 
+/*
+ * Try to take every lock of a batchable lookup/getattr in one step,
+ * after the unlocked traversal in handle_client_getattr().
+ *
+ * This is only done if all of the locks are readable right now, so the
+ * request never waits here.  On success, the path is marked locked and
+ * rdlock_path_pin_ref() will not traverse it again.
+ *
+ * Returns 0 if the locks were taken, > 0 if the request was delayed and
+ * < 0 if the caller should fall back to the normal path.
+ */
+int Server::try_rdlock_getattr_fast(const MDRequestRef& mdr, int mask)
+{
+  if (mdr->snapid != CEPH_NOSNAP || forward_all_requests_to_auth ||
+      mdr->get_filepath().is_last_snap())
+    return -EAGAIN;
+
+  client_t client = mdr->get_client();
+  CInode *ref = mdr->in[0];
+  CDentry *dn = mdr->dn[0].empty() ? nullptr : mdr->dn[0].back();
+  CInode *base = dn ? dn->get_dir()->get_inode() : ref;
+
+  MutationImpl::LockOpVec lov;
+  if (dn) {
+    // client needs to flush async dir operations first
+    if (base->filelock.is_cached())
+      goto miss;
+    lov.add_rdlock(&dn->lock);
+    lov.add_rdlock(&ref->snaplock);
+  }
+
+  {
+    // same as handle_client_getattr(), nothing is locked yet
+    int issued = 0;
+    Capability *cap = ref->get_client_cap(client);
+    if (cap)
+      issued = cap->issued();
+    if ((mask & CEPH_CAP_LINK_SHARED) && !(issued & CEPH_CAP_LINK_EXCL))
+      lov.add_rdlock(&ref->linklock);
+    if ((mask & CEPH_CAP_AUTH_SHARED) && !(issued & CEPH_CAP_AUTH_EXCL))
+      lov.add_rdlock(&ref->authlock);
+    if ((mask & CEPH_CAP_XATTR_SHARED) && !(issued & CEPH_CAP_XATTR_EXCL))
+      lov.add_rdlock(&ref->xattrlock);
+    if ((mask & CEPH_CAP_FILE_SHARED) && !(issued & CEPH_CAP_FILE_EXCL) &&
+	(ref->filelock.is_stable() ||
+	 ref->filelock.get_num_wrlocks() > 0 ||
+	 !ref->filelock.can_read(client)))
+      lov.add_rdlock(&ref->filelock);
+  }
+
+  for (const auto& op : lov) {
+    if (!op.lock->can_rdlock(client))
+      goto miss;
+  }
+  for (CInode *t = base; ; ) {
+    if (!t->snaplock.can_rdlock(client))
+      goto miss;
+    CDentry *pdn = t->get_projected_parent_dn();
+    if (!pdn)
+      break;
+    t = pdn->get_dir()->get_inode();
+  }
+
+  if (!mds->locker->try_rdlock_snap_layout(base, mdr))
+    return 1;
+  if (!mds->locker->acquire_locks(mdr, lov))
+    return 1;
+
+  mdr->locking_state |= MutationImpl::SNAP_LOCKED | MutationImpl::PATH_LOCKED;
+  if (dn)
+    mdr->pin(dn);
+  mdr->pin(ref);
+  logger->inc(l_mdss_req_getattr_fast);
+  dout(20) << __func__ << " took all locks for " << *mdr << dendl;
+  return 0;
+
+miss:
+  logger->inc(l_mdss_req_getattr_fast_miss);
+  return -EAGAIN;
+}
+
 /** rdlock_path_xlock_dentry
  * traverse path to the directory that could/would contain dentry.
  * make sure i am auth for that dentry (or target inode if it exists and authexist),
@@ -4257,8 +4395,16 @@ void Server::handle_client_getattr(const MDRequestRef& mdr, bool is_lookup)
       }
     }
 
+    if (r == 0 && !want_auth && allow_fast_getattr) {
+      r = try_rdlock_getattr_fast(mdr, mask);
+      if (r > 0)
+	return; // delayed
+    }
+
     if (r < 0) {
       // fall-thru. let rdlock_path_pin_ref() check again.
+    } else if (mdr->locking_state & MutationImpl::PATH_LOCKED) {
+      // all locks taken, fall-thru without batching
     } else if (is_lookup && mdr->dn[0].size()) {
       CDentry* dn = mdr->dn[0].back();
       mdr->pin(dn);
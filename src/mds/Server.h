@@ -128,6 +128,8 @@ enum {
   l_mdss_cap_acquisition_throttle,
   l_mdss_req_getvxattr_latency,
   l_mdss_req_file_blockdiff_latency,
+  l_mdss_req_getattr_fast,
+  l_mdss_req_getattr_fast_miss,
   l_mdss_last,
 };
 
@@ -212,6 +214,8 @@ public:
   void submit_mdlog_entry(LogEvent *le, MDSLogContextBase *fin,
                           const MDRequestRef& mdr, std::string_view event);
   void dispatch_client_request(const MDRequestRef& mdr);
+  void _dispatch_client_request(const MDRequestRef& mdr);
+  void charge_request_cpu(const MDRequestRef& mdr, double ms);
   void perf_gather_op_latency(const cref_t<MClientRequest> &req, utime_t lat);
   void early_reply(const MDRequestRef& mdr, CInode *tracei, CDentry *tracedn);
   void respond_to_request(const MDRequestRef& mdr, int r = 0);
@@ -240,6 +244,7 @@ public:
 			      bool no_want_auth=false);
   CInode* rdlock_path_pin_ref(const MDRequestRef& mdr, const filepath& refpath, bool want_auth,
 			      bool no_want_auth=false);
+  int try_rdlock_getattr_fast(const MDRequestRef& mdr, int mask);
   CDentry* rdlock_path_xlock_dentry(const MDRequestRef& mdr, bool create,
 				    bool okexist=false, bool authexist=false,
 				    bool want_layout=false);
@@ -616,6 +621,9 @@ private:
   uint64_t dir_max_entries = 0;
   int64_t bal_fragment_size_max = 0;
   bool allow_batched_ops = true;
+  bool allow_fast_getattr = true;
+  // CPU time of the dispatches nested in the current one, in ms
+  double nested_dispatch_cpu_ms = 0;
 
   double inject_rename_corrupt_dentry_first = 0.0;
 
@@ -124,7 +124,15 @@ struct BatchCommitBacktrace : public Context {
 
 void LogSegment::try_to_expire(MDSRank *mds, MDSGatherBuilder &gather_bld, int op_prio)
 {
-  set<CDir*> commit;
+  // dirfrag -> version this segment needs committed, 0 for the latest.
+  // dirfrags still dirty in a later segment keep getting new versions,
+  // so only wait for the ones our dentries and inodes were dirtied at.
+  map<CDir*, version_t> commit;
+  auto need_commit = [&commit](CDir *dir, version_t v) {
+    auto em = commit.emplace(dir, v);
+    if (!em.second && em.first->second)
+      em.first->second = v ? std::max(em.first->second, v) : 0;
+  };
 
   dout(6) << "LogSegment(" << seq << "/" << offset << ").try_to_expire" << dendl;
 
@@ -134,17 +142,17 @@ void LogSegment::try_to_expire(MDSRank *mds, MDSGatherBuilder &gather_bld, int o
   for (elist<CDir*>::iterator p = new_dirfrags.begin(); !p.end(); ++p) {
     dout(20) << " new_dirfrag " << **p << dendl;
     ceph_assert((*p)->is_auth());
-    commit.insert(*p);
+    need_commit(*p, 0);
   }
   for (elist<CDir*>::iterator p = dirty_dirfrags.begin(); !p.end(); ++p) {
     dout(20) << " dirty_dirfrag " << **p << dendl;
     ceph_assert((*p)->is_auth());
-    commit.insert(*p);
+    need_commit(*p, 0);
   }
   for (elist<CDentry*>::iterator p = dirty_dentries.begin(); !p.end(); ++p) {
     dout(20) << " dirty_dentry " << **p << dendl;
     ceph_assert((*p)->is_auth());
-    commit.insert((*p)->get_dir());
+    need_commit((*p)->get_dir(), (*p)->get_version());
   }
   for (elist<CInode*>::iterator p = dirty_inodes.begin(); !p.end(); ++p) {
     dout(20) << " dirty_inode " << **p << dendl;
@@ -152,18 +160,18 @@ void LogSegment::try_to_expire(MDSRank *mds, MDSGatherBuilder &gather_bld, int o
     if ((*p)->is_base()) {
       (*p)->store(gather_bld.new_sub());
     } else
-      commit.insert((*p)->get_parent_dn()->get_dir());
+      need_commit((*p)->get_parent_dn()->get_dir(), (*p)->get_version());
   }
 
   if (!commit.empty()) {
-    for (set<CDir*>::iterator p = commit.begin();
-	 p != commit.end();
-	 ++p) {
-      CDir *dir = *p;
+    for (auto& [dir, v] : commit) {
       ceph_assert(dir->is_auth());
+      version_t want = v;
+      if (want <= dir->get_committed_version() || want > dir->get_version())
+	want = 0;
       if (dir->can_auth_pin()) {
-	dout(15) << "try_to_expire committing " << *dir << dendl;
-	dir->commit(0, gather_bld.new_sub(), false, op_prio);
+	dout(15) << "try_to_expire committing " << *dir << " want " << want << dendl;
+	dir->commit(want, gather_bld.new_sub(), false, op_prio);
       } else {
 	dout(15) << "try_to_expire waiting for unfreeze on " << *dir << dendl;
 	dir->add_waiter(CDir::WAIT_UNFREEZE, gather_bld.new_sub());
@@ -1015,6 +1015,7 @@ void dirfrag_load_vec_t::dump(Formatter *f, const DecayRate& rate) const
   f->dump_float("READDIR", get(META_POP_READDIR).get());
   f->dump_float("FETCH", get(META_POP_FETCH).get());
   f->dump_float("STORE", get(META_POP_STORE).get());
+  f->dump_float("CPU", get(META_POP_CPU).get());
 }
 
 void dirfrag_load_vec_t::print(std::ostream& out) const {
@@ -1026,6 +1027,7 @@ void dirfrag_load_vec_t::print(std::ostream& out) const {
        << " RDR:" << vec[2]
        << " FET:" << vec[3]
        << " STR:" << vec[4]
+       << " CPU:" << vec[5]
        << " *LOAD:" << meta_load() << "]";
   out << css->strv();
 }
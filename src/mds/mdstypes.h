@@ -784,7 +784,8 @@ namespace std {
 #define META_POP_READDIR 2
 #define META_POP_FETCH   3
 #define META_POP_STORE   4
-#define META_NPOP        5
+#define META_POP_CPU     5  // ms spent serving requests, not a hit count
+#define META_NPOP        6
 
 class inode_load_vec_t {
 public:
@@ -822,31 +823,36 @@ class dirfrag_load_vec_t {
 public:
   using time = DecayCounter::time;
   using clock = DecayCounter::clock;
-  static const size_t NUM = 5;
+  static const size_t NUM = 6;
 
   dirfrag_load_vec_t() :
       vec{DecayCounter(DecayRate()),
           DecayCounter(DecayRate()),
           DecayCounter(DecayRate()),
           DecayCounter(DecayRate()),
+          DecayCounter(DecayRate()),
           DecayCounter(DecayRate())
          }
   {}
   dirfrag_load_vec_t(const DecayRate &rate) : 
-      vec{DecayCounter(rate), DecayCounter(rate), DecayCounter(rate), DecayCounter(rate), DecayCounter(rate)}
+      vec{DecayCounter(rate), DecayCounter(rate), DecayCounter(rate), DecayCounter(rate), DecayCounter(rate),
+          DecayCounter(rate)}
   {}
 
   void encode(ceph::buffer::list &bl) const {
-    ENCODE_START(2, 2, bl);
+    ENCODE_START(3, 2, bl);
     for (const auto &i : vec) {
       encode(i, bl);
     }
     ENCODE_FINISH(bl);
   }
   void decode(ceph::buffer::list::const_iterator &p) {
-    DECODE_START_LEGACY_COMPAT_LEN(2, 2, 2, p);
-    for (auto &i : vec) {
-      decode(i, p);
+    DECODE_START_LEGACY_COMPAT_LEN(3, 2, 2, p);
+    for (size_t i = 0; i < META_POP_CPU; i++) {
+      decode(vec[i], p);
+    }
+    if (struct_v >= 3) {
+      decode(vec[META_POP_CPU], p);
     }
     DECODE_FINISH(p);
   }
@@ -879,6 +885,10 @@ public:
       2*vec[META_POP_FETCH].get() +
       4*vec[META_POP_STORE].get();
   }
+  // measured cost, as opposed to the weighted op counts of meta_load()
+  double cpu_load() const {
+    return vec[META_POP_CPU].get();
+  }
 
   void add(dirfrag_load_vec_t& r) {
     for (size_t i=0; i<dirfrag_load_vec_t::NUM; i++)
@@ -27,6 +27,7 @@ std::vector<std::string> CompressorRegistry::get_tracked_keys() const noexcept
 {
   return {
     "ms_osd_compress_mode"s,
+    "ms_client_compress_mode"s,
     "ms_osd_compression_algorithm"s,
     "ms_osd_compress_min_size"s,
     "ms_compress_secure"s
@@ -77,12 +78,23 @@ void CompressorRegistry::_refresh_config()
     ms_osd_compress_mode = Compressor::COMP_NONE;
   }
 
+  c_mode = Compressor::get_comp_mode_type(cct->_conf.get_val<std::string>("ms_client_compress_mode"));
+  if (c_mode) {
+    ms_client_compress_mode = *c_mode;
+  } else {
+    ldout(cct,1) << __func__ << " failed to identify ms_client_compress_mode "
+      << ms_client_compress_mode << dendl;
+
+    ms_client_compress_mode = Compressor::COMP_NONE;
+  }
+
   ms_osd_compression_methods = _parse_method_list(cct->_conf.get_val<std::string>("ms_osd_compression_algorithm"));
   ms_osd_compress_min_size = cct->_conf.get_val<std::uint64_t>("ms_osd_compress_min_size");
 
   ms_compress_secure = cct->_conf.get_val<bool>("ms_compress_secure");
 
   ldout(cct,10) << __func__ << " ms_osd_compression_mode " << ms_osd_compress_mode
+    << " ms_client_compress_mode " << ms_client_compress_mode
     << " ms_osd_compression_methods " << ms_osd_compression_methods
     << " ms_osd_compress_above_min_size " << ms_osd_compress_min_size
     << " ms_compress_secure " << ms_compress_secure
@@ -122,6 +134,8 @@ CompressorRegistry::get_mode(uint32_t peer_type, bool is_secure)
   switch (peer_type) {
   case CEPH_ENTITY_TYPE_OSD:
     return static_cast<Compressor::CompressionMode>(ms_osd_compress_mode);
+  case CEPH_ENTITY_TYPE_CLIENT:
+    return static_cast<Compressor::CompressionMode>(ms_client_compress_mode);
   default:
     return Compressor::COMP_NONE;
   }
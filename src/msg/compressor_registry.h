@@ -11,7 +11,7 @@
 #include "common/ceph_mutex.h"
 #include "common/config_obs.h"
 #include "include/common_fwd.h" // for CephContext
-#include "include/msgr.h" // for CEPH_ENTITY_TYPE_OSD
+#include "include/msgr.h" // for CEPH_ENTITY_TYPE_*
 
 class CompressorRegistry : public md_config_obs_t {
 public:
@@ -36,6 +36,7 @@ public:
     std::scoped_lock l(lock);
     switch (peer_type) {
       case CEPH_ENTITY_TYPE_OSD:
+      case CEPH_ENTITY_TYPE_CLIENT:
         return ms_osd_compression_methods;
       default:
         return {};
@@ -46,6 +47,7 @@ public:
     std::scoped_lock l(lock);
     switch (peer_type) {
       case CEPH_ENTITY_TYPE_OSD:
+      case CEPH_ENTITY_TYPE_CLIENT:
         return ms_osd_compress_min_size;
       default:
         return 0;
@@ -62,6 +64,7 @@ private:
   mutable ceph::mutex lock = ceph::make_mutex("CompressorRegistry::lock");
 
   uint32_t ms_osd_compress_mode;
+  uint32_t ms_client_compress_mode;
   bool ms_compress_secure;
   std::uint64_t ms_osd_compress_min_size;
   std::vector<uint32_t> ms_osd_compression_methods;
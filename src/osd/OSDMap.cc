@@ -19,10 +19,12 @@
 #include "OSDMap.h"
 
 #include <algorithm>
+#include <atomic>
 #include <bit>
 #include <iomanip>
 #include <optional>
 #include <random>
+#include <ranges>
 #include <sstream>
 #include <fmt/format.h>
 
@@ -250,6 +252,41 @@ int OSDMap::Incremental::identify_osd(uuid_d u) const
   return -1;
 }
 
+bool OSDMap::Incremental::may_remap_all_pgs() const
+{
+  // anything feeding crush or the raw -> up/acting filtering, which is
+  // not specific to a pool
+  return fullmap.length() ||
+    crush.length() ||
+    new_max_osd >= 0 ||
+    !new_up_client.empty() ||
+    !new_state.empty() ||
+    !new_weight.empty() ||
+    !new_primary_affinity.empty() ||
+    !new_crush_node_flags.empty() ||
+    !new_device_class_flags.empty() ||
+    change_stretch_mode;
+}
+
+bool OSDMap::Incremental::may_remap_pool(int64_t pool) const
+{
+  if (new_pools.count(pool) || old_pools.count(pool)) {
+    return true;
+  }
+  auto in_pool = [pool](const pg_t& pgid) {
+    return pgid.pool() == (uint64_t)pool;
+  };
+  using std::views::keys;
+  return std::ranges::any_of(new_pg_temp | keys, in_pool) ||
+    std::ranges::any_of(new_primary_temp | keys, in_pool) ||
+    std::ranges::any_of(new_pg_upmap | keys, in_pool) ||
+    std::ranges::any_of(new_pg_upmap_items | keys, in_pool) ||
+    std::ranges::any_of(new_pg_upmap_primary | keys, in_pool) ||
+    std::ranges::any_of(old_pg_upmap, in_pool) ||
+    std::ranges::any_of(old_pg_upmap_items, in_pool) ||
+    std::ranges::any_of(old_pg_upmap_primary, in_pool);
+}
+
 int OSDMap::Incremental::propagate_base_properties_to_tiers(CephContext *cct,
 							    const OSDMap& osdmap)
 {
@@ -5764,7 +5801,8 @@ int OSDMap::calc_pg_upmaps(
   int max,
   const set<int64_t>& only_pools,
   OSDMap::Incremental *pending_inc,
-  std::random_device::result_type *p_seed)
+  std::random_device::result_type *p_seed,
+  int *p_iterations)
 {
   ldout(cct, 10) << __func__ << " pools " << only_pools << dendl;
   OSDMap tmp_osd_map;
@@ -5814,8 +5852,25 @@ int OSDMap::calc_pg_upmaps(
     cct->_conf.get_val<bool>("osd_calc_pg_upmaps_aggressively_fast");
   auto local_fallback_retries =
     cct->_conf.get_val<uint64_t>("osd_calc_pg_upmaps_local_fallback_retries");
-    
+
+  // the candidate changes are made to temp_pgs_by_osd.  only the few osds
+  // a change touches are copied back to pgs_by_osd when it is accepted,
+  // or restored from it when it is not.
+  auto temp_pgs_by_osd = pgs_by_osd;
+  auto reset_temp_pgs = [&](const set<int>& osds) {
+    for (auto osd : osds) {
+      auto p = pgs_by_osd.find(osd);
+      if (p != pgs_by_osd.end()) {
+        temp_pgs_by_osd[osd] = p->second;
+      } else {
+        temp_pgs_by_osd.erase(osd);
+      }
+    }
+  };
+  int iterations = 0;
+
   while (max--) {
+    ++iterations;
     ldout(cct, 30) << "Top of loop #" << max+1 << dendl;
     // build overfull and underfull
     set<int> overfull;
@@ -5852,7 +5907,6 @@ int OSDMap::calc_pg_upmaps(
 
     set<pg_t> to_unmap;
     map<pg_t, mempool::osdmap::vector<pair<int32_t,int32_t>>> to_upmap;
-    auto temp_pgs_by_osd = pgs_by_osd;
     // always start with fullest, break if we find any changes to make
     for (auto p = deviation_osd.rbegin(); p != deviation_osd.rend(); ++p) {
       if (skip_overfull && !underfull.empty()) {
@@ -6025,14 +6079,17 @@ int OSDMap::calc_pg_upmaps(
 
     // test change, apply if change is good
     ceph_assert(to_unmap.size() || to_upmap.size());
+    set<int> changed_osds;
+    get_remapped_osds(tmp_osd_map, to_unmap, to_upmap, changed_osds);
     float new_stddev = 0;
     map<int,float> temp_osd_deviation;
-    multimap<float,int> temp_deviation_osd;
-    float cur_max_deviation = calc_deviations(cct, temp_pgs_by_osd, osd_weight,
-    					      pgs_per_weight, temp_osd_deviation,
-					      temp_deviation_osd, new_stddev);
+    float cur_max_deviation = update_deviations(cct, temp_pgs_by_osd,
+                                                changed_osds, osd_weight,
+                                                pgs_per_weight, osd_deviation,
+                                                temp_osd_deviation, new_stddev);
     ldout(cct, 10) << " stddev " << stddev << " -> " << new_stddev << dendl;
     if (new_stddev >= stddev) {
+      reset_temp_pgs(changed_osds);
       if (!aggressive) {
         ldout(cct, 10) << " break because stddev is not decreasing"
                        << " and aggressive mode is not enabled"
@@ -6063,9 +6120,18 @@ int OSDMap::calc_pg_upmaps(
     // ready to go
     ceph_assert(new_stddev < stddev);
     stddev = new_stddev;
-    pgs_by_osd = temp_pgs_by_osd;
-    osd_deviation = temp_osd_deviation;
-    deviation_osd = temp_deviation_osd;
+    for (auto osd : changed_osds) {
+      auto t = temp_pgs_by_osd.find(osd);
+      if (t == temp_pgs_by_osd.end())
+        continue;
+      pgs_by_osd[osd] = t->second;
+      auto d = osd_deviation.find(osd);
+      move_deviation(deviation_osd, osd,
+                     d != osd_deviation.end() ?
+                       std::optional<float>(d->second) : std::nullopt,
+                     temp_osd_deviation.at(osd));
+    }
+    osd_deviation.swap(temp_osd_deviation);
     n_changes++;
 
 
@@ -6078,7 +6144,11 @@ int OSDMap::calc_pg_upmaps(
       break;
     }
   }
-  ldout(cct, 10) << " num_changed = " << num_changed << dendl;
+  ldout(cct, 10) << " num_changed = " << num_changed
+                 << " iterations = " << iterations << dendl;
+  if (p_iterations) {
+    *p_iterations = iterations;
+  }
   return num_changed;
 }
 
@@ -6245,6 +6315,105 @@ float OSDMap::calc_deviations (
   return cur_max_deviation;
 }
 
+float OSDMap::update_deviations (
+  CephContext *cct,
+  const map<int,set<pg_t>>& pgs_by_osd,
+  const set<int>& changed_osds,
+  const map<int,float>& osd_weight,
+  float pgs_per_weight,
+  const map<int,float>& osd_deviation,
+  map<int,float>& new_osd_deviation,
+  float& stddev)  // return new max deviation
+{
+  //
+  // Same as calc_deviations, but only recounts the pgs of changed_osds and
+  // takes the deviation of every other osd from osd_deviation.  The sums
+  // run over all osds in the same order, so the results are identical.
+  //
+  new_osd_deviation = osd_deviation;
+  for (auto oid : changed_osds) {
+    auto p = pgs_by_osd.find(oid);
+    if (p == pgs_by_osd.end())
+      continue;
+    // make sure osd is still there (belongs to this crush-tree)
+    ceph_assert(osd_weight.count(oid));
+    float target = osd_weight.at(oid) * pgs_per_weight;
+    float deviation = (float)p->second.size() - target;
+    ldout(cct, 20) << " osd." << oid
+                   << "\tpgs " << p->second.size()
+                   << "\ttarget " << target
+                   << "\tdeviation " << deviation
+                   << dendl;
+    new_osd_deviation[oid] = deviation;
+  }
+  float cur_max_deviation = 0.0;
+  stddev = 0.0;
+  for (auto& [oid, deviation] : new_osd_deviation) {
+    stddev += deviation * deviation;
+    if (fabsf(deviation) > cur_max_deviation)
+      cur_max_deviation = fabsf(deviation);
+  }
+  return cur_max_deviation;
+}
+
+void OSDMap::move_deviation (
+  multimap<float,int>& deviation_osd,
+  int osd,
+  std::optional<float> old_deviation,
+  float new_deviation)
+{
+  //
+  // Reposition osd in deviation_osd.  Equal deviations are kept in osd order,
+  // which is the order calc_deviations builds them in.
+  //
+  if (old_deviation) {
+    auto range = deviation_osd.equal_range(*old_deviation);
+    for (auto p = range.first; p != range.second; ++p) {
+      if (p->second == osd) {
+        deviation_osd.erase(p);
+        break;
+      }
+    }
+  }
+  auto p = deviation_osd.lower_bound(new_deviation);
+  while (p != deviation_osd.end() && p->first == new_deviation &&
+         p->second < osd) {
+    ++p;
+  }
+  deviation_osd.emplace_hint(p, new_deviation, osd);
+}
+
+void OSDMap::get_remapped_osds (
+  const OSDMap& tmp_osd_map,
+  const set<pg_t>& to_unmap,
+  const map<pg_t, mempool::osdmap::vector<pair<int32_t,int32_t>>>& to_upmap,
+  set<int>& osds)
+{
+  //
+  // Collect the osds whose pg counts a candidate change can move: those named
+  // in the pg_upmap_items it drops or replaces, and in the ones it adds.
+  //
+  auto add_items = [&](pg_t pg) {
+    auto p = tmp_osd_map.pg_upmap_items.find(pg);
+    if (p == tmp_osd_map.pg_upmap_items.end())
+      return;
+    for (auto [um_from, um_to] : p->second) {
+      osds.insert(um_from);
+      osds.insert(um_to);
+    }
+  };
+  for (auto& pg : to_unmap) {
+    add_items(pg);
+  }
+  for (auto& [pg, um_items] : to_upmap) {
+    add_items(pg);
+    for (auto [um_from, um_to] : um_items) {
+      osds.insert(um_from);
+      osds.insert(um_to);
+    }
+  }
+}
+
 void OSDMap::fill_overfull_underfull (
   CephContext *cct,
   const std::multimap<float,int>& deviation_osd,
@@ -6330,7 +6499,7 @@ std::default_random_engine OSDMap::get_random_engine(
   // increments seed_set. This is used in order to craete regression test without 
   // random effect on the results. 
   //
-  static std::random_device::result_type seed_set = 0;
+  static std::atomic<std::random_device::result_type> seed_set = 0;
   std::random_device::result_type seed;
   if (p_seed == nullptr) {
     std::random_device rd;
@@ -6497,7 +6666,7 @@ int OSDMap::find_best_remap (
   const vector<int>& orig,
   const vector<int>& out,
   const set<int>& existing,
-  const map<int,float> osd_deviation) 
+  const map<int,float>& osd_deviation)
 {
   //
   // Find the best remap from the suggestions in orig and out - the best remap 
@@ -6523,7 +6692,7 @@ int OSDMap::find_best_remap (
 OSDMap::candidates_t OSDMap::build_candidates(
   CephContext *cct,
   const OSDMap& tmp_osd_map,
-  const set<pg_t> to_skip,
+  const set<pg_t>& to_skip,
   const set<int64_t>& only_pools,
   bool aggressive,
   std::random_device::result_type *p_seed)
@@ -30,6 +30,7 @@
 #include <set>
 #include <map>
 #include <memory>
+#include <optional>
 #include <random>
 
 #include "include/btree_map.h"
@@ -450,6 +451,11 @@ public:
     int get_net_marked_down(const OSDMap *previous) const;
     int identify_osd(uuid_d u) const;
 
+    /// true if applying this may change the mapping of PGs in any pool
+    bool may_remap_all_pgs() const;
+    /// true if applying this may change the mapping of some PG in pool
+    bool may_remap_pool(int64_t pool) const;
+
     void encode_client_old(ceph::buffer::list& bl) const;
     void encode_classic(ceph::buffer::list& bl, uint64_t features) const;
     void encode(ceph::buffer::list& bl, uint64_t features=CEPH_FEATURES_ALL) const;
@@ -1563,7 +1569,8 @@ public:
     int max_iterations,  ///< max iterations to run
     const std::set<int64_t>& pools,        ///< [optional] restrict to pool
     Incremental *pending_inc,
-    std::random_device::result_type *p_seed = nullptr  ///< [optional] for regression tests
+    std::random_device::result_type *p_seed = nullptr,  ///< [optional] for regression tests
+    int *p_iterations = nullptr  ///< [optional] number of iterations run
     );
 
   std::map<uint64_t,std::set<pg_t>> get_pgs_by_osd(
@@ -1575,6 +1582,8 @@ public:
 
 private: // Bunch of internal functions used only by calc_pg_upmaps (result of code refactoring)
 
+  friend class OSDMapTest;
+
   float get_osds_weight(
     CephContext *cct,
     const OSDMap& tmp_osd_map,
@@ -1601,6 +1610,31 @@ private: // Bunch of internal functions used only by calc_pg_upmaps (result of c
     float& stddev
   );  // return current max deviation
 
+  float update_deviations (
+    CephContext *cct,
+    const std::map<int,std::set<pg_t>>& pgs_by_osd,
+    const std::set<int>& changed_osds,
+    const std::map<int,float>& osd_weight,
+    float pgs_per_weight,
+    const std::map<int,float>& osd_deviation,
+    std::map<int,float>& new_osd_deviation,
+    float& stddev
+  );  // return new max deviation
+
+  void move_deviation (
+    std::multimap<float,int>& deviation_osd,
+    int osd,
+    std::optional<float> old_deviation,
+    float new_deviation
+  );
+
+  void get_remapped_osds (
+    const OSDMap& tmp_osd_map,
+    const std::set<pg_t>& to_unmap,
+    const std::map<pg_t, mempool::osdmap::vector<std::pair<int32_t,int32_t>>>& to_upmap,
+    std::set<int>& osds
+  );
+
   void fill_overfull_underfull (
     CephContext *cct,
     const std::multimap<float,int>& deviation_osd,
@@ -1664,13 +1698,13 @@ bool try_drop_remap_underfull(
     const std::vector<int>& orig,
     const std::vector<int>& out,
     const std::set<int>& existing,
-    const std::map<int,float> osd_deviation
+    const std::map<int,float>& osd_deviation
   );
 
   candidates_t build_candidates(
     CephContext *cct,
     const OSDMap& tmp_osd_map,
-    const std::set<pg_t> to_skip,
+    const std::set<pg_t>& to_skip,
     const std::set<int64_t>& only_pools,
     bool aggressive,
     std::random_device::result_type *p_seed
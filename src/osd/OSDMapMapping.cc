@@ -1,6 +1,8 @@
 // -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
 // vim: ts=8 sw=2 sts=2 expandtab
 
+#include <algorithm>
+
 #include "OSDMapMapping.h"
 #include "OSDMap.h"
 
@@ -52,6 +54,7 @@ void OSDMapMapping::update(const OSDMap& osdmap)
     _update_range(osdmap, p.first, 0, p.second.get_pg_num());
   }
   _finish(osdmap);
+  pending.reset(osdmap.get_epoch());
   //_dump();  // for debugging
 }
 
@@ -91,6 +94,183 @@ void OSDMapMapping::_finish(const OSDMap& osdmap)
 {
   _build_rmap(osdmap);
   epoch = osdmap.get_epoch();
+  valid = true;
+}
+
+void OSDMapMapping::note_incremental(const OSDMap& prev,
+				     const OSDMap::Incremental& inc)
+{
+  if (pending.full) {
+    return;
+  }
+  if (prev.get_epoch() != pending.to || inc.epoch != pending.to + 1) {
+    // we missed an epoch
+    pending.full = true;
+    return;
+  }
+  pending.to = inc.epoch;
+  if (inc.fullmap.length() ||
+      inc.crush.length() ||
+      inc.new_max_osd >= 0 ||
+      !inc.new_crush_node_flags.empty() ||
+      !inc.new_device_class_flags.empty() ||
+      inc.change_stretch_mode) {
+    pending.full = true;
+    return;
+  }
+  for (auto& [osd, weight] : inc.new_weight) {
+    if (osd >= prev.get_max_osd()) {
+      pending.full = true;
+      return;
+    }
+    // marking an osd out only moves the pgs crush had placed on it.  any
+    // other reweight may draw pgs from anywhere onto the osd.
+    if (weight == CEPH_OSD_OUT && prev.get_weight(osd) == CEPH_OSD_IN) {
+      pending.out_osds.insert(osd);
+    } else if (weight != prev.get_weight(osd)) {
+      pending.full = true;
+      return;
+    }
+  }
+  for (auto& p : inc.new_state) {
+    pending.osds.insert(p.first);
+  }
+  for (auto& p : inc.new_up_client) {
+    pending.osds.insert(p.first);
+  }
+  // primary affinity only matters to pgs with the osd in their up set
+  for (auto& p : inc.new_primary_affinity) {
+    pending.osds.insert(p.first);
+  }
+  for (auto& p : inc.new_pools) {
+    pending.pools.insert(p.first);
+  }
+  for (auto& p : inc.new_pg_temp) {
+    pending.pgs.insert(p.first);
+  }
+  for (auto& p : inc.new_primary_temp) {
+    pending.pgs.insert(p.first);
+  }
+  for (auto& p : inc.new_pg_upmap) {
+    pending.pgs.insert(p.first);
+  }
+  for (auto& p : inc.new_pg_upmap_items) {
+    pending.pgs.insert(p.first);
+  }
+  for (auto& p : inc.new_pg_upmap_primary) {
+    pending.pgs.insert(p.first);
+  }
+  pending.pgs.insert(inc.old_pg_upmap.begin(), inc.old_pg_upmap.end());
+  pending.pgs.insert(inc.old_pg_upmap_items.begin(),
+		     inc.old_pg_upmap_items.end());
+  pending.pgs.insert(inc.old_pg_upmap_primary.begin(),
+		     inc.old_pg_upmap_primary.end());
+}
+
+// the pgs whose mapping may differ between our tables and osdmap, or
+// false if we have to remap everything
+bool OSDMapMapping::_get_changed_pgs(const OSDMap& osdmap,
+				     vector<pg_t> *pgs) const
+{
+  if (!valid || pending.full ||
+      pending.from != epoch || pending.to != osdmap.get_epoch()) {
+    return false;
+  }
+
+  vector<bool> osd_changed(osdmap.get_max_osd());
+  for (auto osd : pending.osds) {
+    if (osd >= 0 && osd < (int)osd_changed.size()) {
+      osd_changed[osd] = true;
+    }
+  }
+  for (auto osd : pending.out_osds) {
+    if (osd >= 0 && osd < (int)osd_changed.size()) {
+      osd_changed[osd] = true;
+    }
+  }
+  auto changed = [&osd_changed](int32_t osd) {
+    return osd >= 0 && osd < (int32_t)osd_changed.size() && osd_changed[osd];
+  };
+  const bool scan = !pending.osds.empty() || !pending.out_osds.empty();
+  vector<pg_t> explicit_pgs(pending.pgs.begin(), pending.pgs.end());
+  if (!pending.out_osds.empty()) {
+    // crush may have put an osd we just marked out into a raw set that an
+    // upmap rewrote, so it shows up in neither up nor acting
+    osdmap.get_upmap_pgs(&explicit_pgs);
+  }
+
+  for (auto& [poolid, pool] : osdmap.get_pools()) {
+    auto p = pools.find(poolid);
+    if (p == pools.end() ||
+	p->second.pg_num != pool.get_pg_num() ||
+	p->second.size != pool.get_size() ||
+	pending.pools.count(poolid)) {
+      for (unsigned ps = 0; ps < pool.get_pg_num(); ++ps) {
+	pgs->push_back(pg_t(ps, poolid));
+      }
+      continue;
+    }
+    if (!scan) {
+      continue;
+    }
+    const PoolMapping& pm = p->second;
+    for (unsigned ps = 0; ps < pm.pg_num; ++ps) {
+      const int32_t *row = &pm.table[pm.row_size() * ps];
+      const int32_t *acting = row + 4;
+      const int32_t *up = row + 4 + pm.size;
+      // a down or out osd may still sit in the raw set of a pg that has
+      // a hole in its up set
+      bool affected = pm.erasure ?
+	std::find(up, up + row[3], CRUSH_ITEM_NONE) != up + row[3] :
+	row[3] < (int32_t)pm.size;
+      affected = affected ||
+	std::any_of(acting, acting + row[2], changed) ||
+	std::any_of(up, up + row[3], changed);
+      pg_t pgid(ps, poolid);
+      if (affected ||
+	  (!pending.osds.empty() && osdmap.has_pgtemp(pgid))) {
+	pgs->push_back(pgid);
+      }
+    }
+  }
+
+  for (auto& pgid : explicit_pgs) {
+    auto pool = osdmap.get_pg_pool(pgid.pool());
+    if (pool && pgid.ps() < pool->get_pg_num()) {
+      pgs->push_back(pgid);
+    }
+  }
+  // an item may only be mapped by one thread
+  std::sort(pgs->begin(), pgs->end());
+  pgs->erase(std::unique(pgs->begin(), pgs->end()), pgs->end());
+  return true;
+}
+
+std::unique_ptr<OSDMapMapping::MappingJob> OSDMapMapping::start_update(
+  const OSDMap& map,
+  ParallelPGMapper& mapper,
+  unsigned pgs_per_item,
+  bool incremental)
+{
+  vector<pg_t> pgs;
+  bool partial = incremental && _get_changed_pgs(map, &pgs);
+  pending.reset(map.get_epoch());
+  std::unique_ptr<MappingJob> job(new MappingJob(&map, this));
+  num_remapped = pgs.size();
+  if (!partial) {
+    num_remapped = 0;
+    for (auto& [poolid, pool] : map.get_pools()) {
+      num_remapped += pool.get_pg_num();
+    }
+    mapper.queue(job.get(), pgs_per_item, {});
+  } else if (!pgs.empty()) {
+    mapper.queue(job.get(), pgs_per_item, pgs);
+  } else {
+    // nothing moved, but the job still has to complete
+    job->start_one();
+    job->finish_one();
+  }
+  return job;
 }
 
 void OSDMapMapping::_dump()
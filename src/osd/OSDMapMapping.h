@@ -7,14 +7,14 @@
 
 #include <vector>
 #include <map>
+#include <set>
 
 #include "osd/osd_types.h"
+#include "osd/OSDMap.h"
 #include "common/WorkQueue.h"
 #include "common/Clock.h" // for ceph_clock_now()
 #include "common/Cond.h"
 
-class OSDMap;
-
 /// work queue to perform work on batches of pgids on multiple CPUs
 class ParallelPGMapper {
 public:
@@ -258,6 +258,25 @@ private:
   epoch_t epoch = 0;
   uint64_t num_pgs = 0;
 
+  /// changes noted since the last update that let us remap only some pgs
+  struct PendingChanges {
+    epoch_t from = 0;  ///< epoch the changes apply on top of
+    epoch_t to = 0;    ///< epoch of the last incremental noted
+    bool full = true;  ///< something we cannot pin to particular pgs changed
+    std::set<int64_t> pools;     ///< pools to remap entirely
+    std::set<int32_t> osds;      ///< osds whose up/exists state changed
+    std::set<int32_t> out_osds;  ///< osds marked out
+    std::set<pg_t> pgs;          ///< pgs with pg_temp/upmap changes
+
+    void reset(epoch_t e) {
+      *this = PendingChanges();
+      from = to = e;
+      full = false;
+    }
+  } pending;
+  bool valid = false;  ///< the last update ran to completion
+  uint64_t num_remapped = 0;  ///< pgs the last start_update() remapped
+
   void _init_mappings(const OSDMap& osdmap);
   void _update_range(
     const OSDMap& map,
@@ -265,8 +284,10 @@ private:
     unsigned pg_begin, unsigned pg_end);
 
   void _build_rmap(const OSDMap& osdmap);
+  bool _get_changed_pgs(const OSDMap& osdmap, std::vector<pg_t> *pgs) const;
 
   void _start(const OSDMap& osdmap) {
+    valid = false;
     _init_mappings(osdmap);
   }
   void _finish(const OSDMap& osdmap);
@@ -281,7 +302,11 @@ private:
       : Job(osdmap), mapping(m) {
       mapping->_start(*osdmap);
     }
-    void process(const std::vector<pg_t>& pgs) override {}
+    void process(const std::vector<pg_t>& pgs) override {
+      for (auto& pgid : pgs) {
+	mapping->update(*osdmap, pgid);
+      }
+    }
     void process(int64_t pool, unsigned ps_begin, unsigned ps_end) override {
       mapping->_update_range(*osdmap, pool, ps_begin, ps_end);
     }
@@ -334,14 +359,26 @@ public:
 
   void update(const OSDMap& map, pg_t pgid);
 
+  /// record what inc changes relative to prev, ahead of applying it
+  void note_incremental(const OSDMap& prev, const OSDMap::Incremental& inc);
+  /// forget noted changes; the next update remaps every pg
+  void mark_stale() {
+    pending.full = true;
+  }
+
+  /**
+   * remap the pgs of map on mapper's threads
+   *
+   * If every incremental since the last completed update was passed to
+   * note_incremental() and none of them touched crush, weights or other
+   * inputs shared by all pgs, only the pgs that may have moved are
+   * remapped.  Otherwise, or with incremental == false, everything is.
+   */
   std::unique_ptr<MappingJob> start_update(
     const OSDMap& map,
     ParallelPGMapper& mapper,
-    unsigned pgs_per_item) {
-    std::unique_ptr<MappingJob> job(new MappingJob(&map, this));
-    mapper.queue(job.get(), pgs_per_item, {});
-    return job;
-  }
+    unsigned pgs_per_item,
+    bool incremental = true);
 
   epoch_t get_epoch() const {
     return epoch;
@@ -350,6 +387,12 @@ public:
   uint64_t get_num_pgs() const {
     return num_pgs;
   }
+
+  /// how many pgs the last start_update() remapped; all of them unless
+  /// it could narrow the update down to the pgs that may have moved
+  uint64_t get_num_remapped() const {
+    return num_remapped;
+  }
 };
 
 
@@ -123,6 +123,17 @@ void Journaler::_set_layout(file_layout_t const *l)
   fetch_len = layout.get_period() * periods;
 }
 
+void Journaler::set_prefetch_periods(uint64_t periods)
+{
+  lock_guard l(lock);
+  if (!periods) {
+    periods = cct->_conf.get_val<uint64_t>("journaler_prefetch_periods");
+  }
+  // we need at least 2 periods to make progress
+  fetch_len = layout.get_period() * std::max<uint64_t>(periods, 2);
+  ldout(cct, 10) << __func__ << " fetch_len " << fetch_len << dendl;
+}
+
 
 /***************** HEADER *******************/
 
@@ -473,6 +473,8 @@ public:
     read_pos = requested_pos = received_pos = p;
     read_buf.clear();
   }
+  /// read ahead this many striping periods (0 for journaler_prefetch_periods)
+  void set_prefetch_periods(uint64_t periods);
   uint64_t append_entry(bufferlist& bl);
   void set_expire_pos(uint64_t ep) {
       lock_guard l(lock);
@@ -51,6 +51,7 @@
 #include "common/ceph_mutex.h"
 #include "common/ceph_timer.h"
 #include "common/config_obs.h"
+#include "common/sharded_shared_mutex.h"
 #include "common/shunique_lock.h"
 #include "common/snap_types.h" // for class SnapContext
 #include "common/zipkin_trace.h"
@@ -1699,6 +1700,9 @@ class Objecter : public md_config_obs_t, public Dispatcher {
 public:
   using OpSignature = void(boost::system::error_code);
   using OpCompletion = boost::asio::any_completion_handler<OpSignature>;
+  // op submission and completion only take rwlock shared; sharding it
+  // keeps many submitting threads from contending on one cache line.
+  using rwlock_t = ceph::sharded_shared_mutex;
 
   // config observer bits
   std::vector<std::string> get_tracked_keys() const noexcept override;
@@ -1752,25 +1756,31 @@ private:
                : epoch(epoch), up(up), up_primary(up_primary),
                  acting(acting), acting_primary(acting_primary) {}
   };
-  ceph::shared_mutex pg_mapping_lock =
-    ceph::make_shared_mutex("Objecter::pg_mapping_lock");
+  struct pool_pg_mapping_t {
+    /// entries calculated before this epoch are stale
+    epoch_t valid_since = 0;
+    std::vector<pg_mapping_t> pgs;
+  };
+  // looked up by every op; only updated on a miss or a map change
+  mutable ceph::sharded_shared_mutex pg_mapping_lock;
   // pool -> pg mapping
-  std::map<int64_t, std::vector<pg_mapping_t>> pg_mappings;
+  std::map<int64_t, pool_pg_mapping_t> pg_mappings;
 
   // convenient accessors
-  bool lookup_pg_mapping(const pg_t& pg, epoch_t epoch, std::vector<int> *up,
+  bool lookup_pg_mapping(const pg_t& pg, std::vector<int> *up,
                          int *up_primary, std::vector<int> *acting,
                          int *acting_primary) {
     std::shared_lock l{pg_mapping_lock};
     auto it = pg_mappings.find(pg.pool());
     if (it == pg_mappings.end())
       return false;
-    auto& mapping_array = it->second;
+    auto& mapping_array = it->second.pgs;
     if (pg.ps() >= mapping_array.size())
       return false;
-    if (mapping_array[pg.ps()].epoch != epoch) // stale
-      return false;
     auto& pg_mapping = mapping_array[pg.ps()];
+    if (pg_mapping.epoch == 0 ||
+        pg_mapping.epoch < it->second.valid_since) // stale
+      return false;
     *up = pg_mapping.up;
     *up_primary = pg_mapping.up_primary;
     *acting = pg_mapping.acting;
@@ -1779,22 +1789,29 @@ private:
   }
   void update_pg_mapping(const pg_t& pg, pg_mapping_t&& pg_mapping) {
     std::lock_guard l{pg_mapping_lock};
-    auto& mapping_array = pg_mappings[pg.pool()];
+    auto& mapping_array = pg_mappings[pg.pool()].pgs;
     ceph_assert(pg.ps() < mapping_array.size());
     mapping_array[pg.ps()] = std::move(pg_mapping);
   }
-  void prune_pg_mapping(const mempool::osdmap::map<int64_t,pg_pool_t>& pools) {
+  // drop mappings the new map may have changed.  without the incremental
+  // that produced it, everything is considered stale.
+  void prune_pg_mapping(const OSDMap& map,
+                        const OSDMap::Incremental* inc = nullptr) {
     std::lock_guard l{pg_mapping_lock};
-    for (auto& pool : pools) {
-      auto& mapping_array = pg_mappings[pool.first];
+    const bool remap_all = !inc || inc->may_remap_all_pgs();
+    for (auto& pool : map.get_pools()) {
+      auto& mapping = pg_mappings[pool.first];
       size_t pg_num = pool.second.get_pg_num();
-      if (mapping_array.size() != pg_num) {
+      if (mapping.pgs.size() != pg_num) {
         // catch both pg_num increasing & decreasing
-        mapping_array.resize(pg_num);
+        mapping.pgs.resize(pg_num);
+        mapping.valid_since = map.get_epoch();
+      } else if (remap_all || inc->may_remap_pool(pool.first)) {
+        mapping.valid_since = map.get_epoch();
       }
     }
     for (auto it = pg_mappings.begin(); it != pg_mappings.end(); ) {
-      if (!pools.count(it->first)) {
+      if (!map.get_pools().count(it->first)) {
         // pool is gone
         pg_mappings.erase(it++);
         continue;
@@ -1819,8 +1836,7 @@ private:
   version_t last_seen_osdmap_version = 0;
   version_t last_seen_pgmap_version = 0;
 
-  mutable ceph::shared_mutex rwlock =
-	   ceph::make_shared_mutex("Objecter::rwlock");
+  mutable rwlock_t rwlock;
   ceph::timer<ceph::coarse_mono_clock> timer;
 
   PerfCounters* logger = nullptr;
@@ -2352,9 +2368,9 @@ public:
 
   void submit_command(CommandOp *c, ceph_tid_t *ptid);
   int _calc_command_target(CommandOp *c,
-			   ceph::shunique_lock<ceph::shared_mutex> &sul);
+			   ceph::shunique_lock<rwlock_t> &sul);
   void _assign_command_session(CommandOp *c,
-			       ceph::shunique_lock<ceph::shared_mutex> &sul);
+			       ceph::shunique_lock<rwlock_t> &sul);
   void _send_command(CommandOp *c);
   int command_op_cancel(OSDSession *s, ceph_tid_t tid,
 			boost::system::error_code ec);
@@ -2591,7 +2607,7 @@ public:
   bool target_should_be_paused(op_target_t *op);
   int _calc_target(op_target_t *t, bool any_change = false);
   int _map_session(op_target_t *op, OSDSession **s,
-		   ceph::shunique_lock<ceph::shared_mutex>& lc);
+		   ceph::shunique_lock<rwlock_t>& lc);
 
   void _session_op_assign(OSDSession *s, Op *op);
   void _session_op_remove(OSDSession *s, Op *op);
@@ -2600,16 +2616,16 @@ public:
   void _session_command_op_assign(OSDSession *to, CommandOp *op);
   void _session_command_op_remove(OSDSession *from, CommandOp *op);
 
-  int _assign_op_target_session(Op *op, ceph::shunique_lock<ceph::shared_mutex>& lc,
+  int _assign_op_target_session(Op *op, ceph::shunique_lock<rwlock_t>& lc,
 				bool src_session_locked,
 				bool dst_session_locked);
   int _recalc_linger_op_target(LingerOp *op,
-			       ceph::shunique_lock<ceph::shared_mutex>& lc);
+			       ceph::shunique_lock<rwlock_t>& lc);
 
   void _linger_submit(LingerOp *info,
-		      ceph::shunique_lock<ceph::shared_mutex>& sul);
+		      ceph::shunique_lock<rwlock_t>& sul);
   void _send_linger(LingerOp *info,
-		    ceph::shunique_lock<ceph::shared_mutex>& sul);
+		    ceph::shunique_lock<rwlock_t>& sul);
   void _linger_commit(LingerOp *info, boost::system::error_code ec,
 		      ceph::buffer::list& outbl);
   void _linger_reconnect(LingerOp *info, boost::system::error_code ec);
@@ -2648,10 +2664,10 @@ private:
 
   void _kick_requests(OSDSession *session, std::map<uint64_t, LingerOp *>& lresend);
   void _linger_ops_resend(std::map<uint64_t, LingerOp *>& lresend,
-			  std::unique_lock<ceph::shared_mutex>& ul);
+			  std::unique_lock<rwlock_t>& ul);
 
   int _get_session(int osd, OSDSession **session,
-		   ceph::shunique_lock<ceph::shared_mutex>& sul);
+		   ceph::shunique_lock<rwlock_t>& sul);
   void put_session(OSDSession *s);
   void get_session(OSDSession *s);
   void _reopen_session(OSDSession *session);
@@ -2669,9 +2685,9 @@ private:
    * If throttle_op needs to throttle it will unlock client_lock.
    */
   int calc_op_budget(const boost::container::small_vector_base<OSDOp>& ops);
-  void _throttle_op(Op *op, ceph::shunique_lock<ceph::shared_mutex>& sul,
+  void _throttle_op(Op *op, ceph::shunique_lock<rwlock_t>& sul,
 		    int op_size = 0);
-  int _take_op_budget(Op *op, ceph::shunique_lock<ceph::shared_mutex>& sul) {
+  int _take_op_budget(Op *op, ceph::shunique_lock<rwlock_t>& sul) {
     ceph_assert(sul && sul.mutex() == &rwlock);
     int op_budget = calc_op_budget(op->ops);
     if (keep_balanced_budget) {
@@ -2745,7 +2761,7 @@ private:
     std::map<ceph_tid_t, Op*>& need_resend,
     std::list<LingerOp*>& need_resend_linger,
     std::map<ceph_tid_t, CommandOp*>& need_resend_command,
-    ceph::shunique_lock<ceph::shared_mutex>& sul);
+    ceph::shunique_lock<rwlock_t>& sul);
 
   int64_t get_object_hash_position(int64_t pool, const std::string& key,
 				   const std::string& ns);
@@ -2830,10 +2846,10 @@ private:
                              const OSDMap &new_osd_map);
 
   // low-level
-  void _op_submit(Op *op, ceph::shunique_lock<ceph::shared_mutex>& lc,
+  void _op_submit(Op *op, ceph::shunique_lock<rwlock_t>& lc,
 		  ceph_tid_t *ptid);
   void _op_submit_with_budget(Op *op,
-			      ceph::shunique_lock<ceph::shared_mutex>& lc,
+			      ceph::shunique_lock<rwlock_t>& lc,
 			      ceph_tid_t *ptid,
 			      int *ctx_budget = NULL);
   // public interface
@@ -2955,7 +2971,7 @@ public:
 
   void _get_latest_version(epoch_t oldest, epoch_t neweset,
 			   OpCompletion fin,
-			   std::unique_lock<ceph::shared_mutex>&& ul);
+			   std::unique_lock<rwlock_t>&& ul);
 
   /** Get the current set of global op flags */
   int get_global_op_flags() const { return global_op_flags; }
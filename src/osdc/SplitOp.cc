@@ -400,7 +400,7 @@ void debug_op_summary(const std::string &str, Objecter::Op *op, CephContext *cct
 
 
 bool SplitOp::create(Objecter::Op *op, Objecter &objecter,
-  shunique_lock<ceph::shared_mutex>& sul, ceph_tid_t *ptid, int *ctx_budget, CephContext *cct) {
+  shunique_lock<Objecter::rwlock_t>& sul, ceph_tid_t *ptid, int *ctx_budget, CephContext *cct) {
 
   auto &t = op->target;
   const pg_pool_t *pi = objecter.osdmap->get_pg_pool(t.base_oloc.pool);
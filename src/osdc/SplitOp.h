@@ -196,7 +196,7 @@ class SplitOp {
   virtual ~SplitOp() = default;
   void complete();
   static bool create(Objecter::Op *op, Objecter &objecter,
-    shunique_lock<ceph::shared_mutex>& sul, ceph_tid_t *ptid, int *ctx_budget, CephContext *cct);
+    shunique_lock<Objecter::rwlock_t>& sul, ceph_tid_t *ptid, int *ctx_budget, CephContext *cct);
 };
 
 class ECSplitOp : public SplitOp{
@@ -31,6 +31,9 @@
                              max deviation from target [default: 5]
      --upmap-pool <poolname> restrict upmap balancing to 1 or more pools
      --upmap-active          Act like an active balancer, keep applying changes until balanced
+     --upmap-threads <num>   balance up to <num> pools at once; --upmap-max then
+                             limits the changes per pool [default: 1]
+     --upmap-bench           report the time and iterations spent on each pool
      --dump <format>         displays the map in plain text when <format> is 'plain', 'json' if specified format is not supported
      --tree                  displays a tree of the map
      --test-crush [--range-first <first> --range-last <last>] map pgs to acting osds
@@ -0,0 +1,73 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <gtest/gtest.h>
+#include "common/AsyncOpTracker.h"
+#include "include/Context.h"
+
+namespace {
+struct C_Count : public Context {
+  std::atomic<int>& count;
+  explicit C_Count(std::atomic<int>& count) : count(count) {}
+  void finish(int r) override {
+    ++count;
+  }
+};
+} // anonymous namespace
+
+TEST(AsyncOpTracker, wait_without_ops)
+{
+  AsyncOpTracker tracker;
+  std::atomic<int> done = 0;
+  ASSERT_TRUE(tracker.empty());
+  tracker.wait_for_ops(new C_Count(done));
+  ASSERT_EQ(1, done);
+}
+
+TEST(AsyncOpTracker, wait_for_last_op)
+{
+  AsyncOpTracker tracker;
+  std::atomic<int> done = 0;
+  tracker.start_op();
+  tracker.start_op();
+  tracker.wait_for_ops(new C_Count(done));
+  ASSERT_FALSE(tracker.empty());
+  tracker.finish_op();
+  ASSERT_EQ(0, done);
+  tracker.finish_op();
+  ASSERT_EQ(1, done);
+  ASSERT_TRUE(tracker.empty());
+
+  // the waiter is only fired once
+  tracker.start_op();
+  tracker.finish_op();
+  ASSERT_EQ(1, done);
+}
+
+TEST(AsyncOpTracker, concurrent)
+{
+  constexpr int num_threads = 8;
+  constexpr int num_ops = 100000;
+  AsyncOpTracker tracker;
+  std::atomic<int> done = 0;
+  // hold one op so the waiter cannot fire until everybody is done
+  tracker.start_op();
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; i++) {
+    threads.emplace_back([&tracker] {
+      for (int n = 0; n < num_ops; n++) {
+        tracker.start_op();
+        tracker.finish_op();
+      }
+    });
+  }
+  tracker.wait_for_ops(new C_Count(done));
+  for (auto& t : threads) {
+    t.join();
+  }
+  ASSERT_EQ(0, done);
+  tracker.finish_op();
+  ASSERT_EQ(1, done);
+}
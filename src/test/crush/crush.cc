@@ -974,6 +974,28 @@ TEST_F(CRUSHTest, straw2_stddev)
   }
 }
 
+TEST_F(CRUSHTest, hash32_3_batch) {
+  // the batched hash must match the scalar one for every lane, including
+  // the ragged tail that does not fill a vector
+  std::vector<__s32> ids;
+  for (int i = 0; i < 37; ++i) {
+    ids.push_back(i % 2 ? i * 7919 : -1 - i);
+  }
+  std::vector<__u32> out(ids.size());
+  for (__u32 x : {0u, 1u, 12345u, 0xffffffffu}) {
+    for (__u32 r : {0u, 3u, 0x8000u}) {
+      for (unsigned n = 0; n <= ids.size(); ++n) {
+        crush_hash32_3_batch(CRUSH_HASH_RJENKINS1, x, ids.data(), r,
+                             out.data(), n);
+        for (unsigned i = 0; i < n; ++i) {
+          ASSERT_EQ(crush_hash32_3(CRUSH_HASH_RJENKINS1, x, ids[i], r),
+                    out[i]);
+        }
+      }
+    }
+  }
+}
+
 TEST_F(CRUSHTest, straw2_reweight) {
   // when we adjust the weight of an item in a straw2 bucket,
   // we should *only* see movement from or to that item, never
@@ -233,3 +233,52 @@ TEST_F(TestSimplePolicy, test_evict_list_10) {
     m_promoted_lru.erase(m_promoted_lru.begin());
   }
 }
+
+TEST_F(TestSimplePolicy, test_evict_list_second_chance) {
+  uint64_t left_entry_num = m_cache_size - m_promoted_lru.size();
+  for (uint64_t i = 0; i < left_entry_num; i++, ++m_entry_index) {
+    insert_entry_into_promoted_lru(generate_file_name(m_entry_index));
+  }
+  ASSERT_TRUE(0 == m_simple_policy->get_free_size());
+
+  // hits on the oldest entries give them a second chance
+  for (uint64_t i = 0; i < 3; i++) {
+    ASSERT_EQ(OBJ_CACHE_PROMOTED, m_simple_policy->lookup_object(m_promoted_lru[i]));
+  }
+  std::vector<std::string> hit(m_promoted_lru.begin(), m_promoted_lru.begin() + 3);
+  m_promoted_lru.erase(m_promoted_lru.begin(), m_promoted_lru.begin() + 3);
+  m_promoted_lru.insert(m_promoted_lru.end(), hit.begin(), hit.end());
+
+  std::list<std::string> evict_entry_list;
+  m_simple_policy->get_evict_list(&evict_entry_list);
+  ASSERT_TRUE(m_cache_size*0.1 == evict_entry_list.size());
+  for (auto it = evict_entry_list.begin(); it != evict_entry_list.end(); it++) {
+    ASSERT_EQ(m_promoted_lru.front(), *it);
+    m_promoted_lru.erase(m_promoted_lru.begin());
+  }
+  // the entries passed over are now the newest, in the order they were
+  // passed over; TearDown() checks the rest of the LRU order
+}
+
+TEST_F(TestSimplePolicy, test_evict_list_second_chance_once) {
+  uint64_t left_entry_num = m_cache_size - m_promoted_lru.size();
+  for (uint64_t i = 0; i < left_entry_num; i++, ++m_entry_index) {
+    insert_entry_into_promoted_lru(generate_file_name(m_entry_index));
+  }
+  ASSERT_TRUE(0 == m_simple_policy->get_free_size());
+
+  // with every entry hit, each is passed over once and the oldest ones
+  // still go first
+  for (auto& file_name : m_promoted_lru) {
+    ASSERT_EQ(OBJ_CACHE_PROMOTED, m_simple_policy->lookup_object(file_name));
+  }
+
+  std::list<std::string> evict_entry_list;
+  m_simple_policy->get_evict_list(&evict_entry_list);
+  ASSERT_TRUE(m_cache_size*0.1 == evict_entry_list.size());
+  for (auto it = evict_entry_list.begin(); it != evict_entry_list.end(); it++) {
+    ASSERT_EQ(m_promoted_lru.front(), *it);
+    m_promoted_lru.erase(m_promoted_lru.begin());
+  }
+  ASSERT_TRUE(m_cache_size - m_cache_size*0.1 == m_simple_policy->get_promoted_entry_num());
+}
@@ -276,6 +276,12 @@ struct MockJournalerProxy {
   MockFutureProxy append(uint64_t tag_id, const bufferlist &bl) {
     return MockJournaler::get_instance().append(tag_id, bl);
   }
+  void append(uint64_t tag_id, const std::list<bufferlist> &bls,
+              std::list<MockFutureProxy> *futures) {
+    for (auto &bl : bls) {
+      futures->push_back(MockJournaler::get_instance().append(tag_id, bl));
+    }
+  }
 
   void flush(Context *on_safe) {
     MockJournaler::get_instance().flush(on_safe);
@@ -46,6 +46,31 @@ TEST_F(TestJournalRecorder, Append) {
   ASSERT_EQ(0, cond.wait());
 }
 
+TEST_F(TestJournalRecorder, AppendBatch) {
+  std::string oid = get_temp_oid();
+  ASSERT_EQ(0, create(oid, 12, 2));
+  ASSERT_EQ(0, client_register(oid));
+
+  auto metadata = create_metadata(oid);
+  ASSERT_EQ(0, init_metadata(metadata));
+
+  JournalRecorderPtr recorder = create_recorder(oid, metadata);
+
+  std::list<journal::Future> futures;
+  recorder->append(123, {create_payload("payload1"),
+                         create_payload("payload2"),
+                         create_payload("payload3")}, &futures);
+  ASSERT_EQ(3U, futures.size());
+
+  C_SaferCond cond;
+  futures.back().flush(&cond);
+  ASSERT_EQ(0, cond.wait());
+  for (auto& future : futures) {
+    ASSERT_TRUE(future.is_complete());
+    ASSERT_EQ(0, future.get_return_value());
+  }
+}
+
 TEST_F(TestJournalRecorder, AppendKnownOverflow) {
   std::string oid = get_temp_oid();
   ASSERT_EQ(0, create(oid, 12, 2));
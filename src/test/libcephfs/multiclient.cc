@@ -179,3 +179,67 @@ TEST(LibCephFS, MulticlientRevokeCaps) {
   thread1.join();
   thread2.join();
 }
+
+TEST(LibCephFS, MulticlientAsyncUnlinkRevoke) {
+  struct ceph_mount_info *ca, *cb;
+  ASSERT_EQ(ceph_create(&ca, NULL), 0);
+  ASSERT_EQ(ceph_conf_read_file(ca, NULL), 0);
+  ASSERT_EQ(0, ceph_conf_parse_env(ca, NULL));
+  ASSERT_EQ(0, ceph_conf_set(ca, "client_async_dirops", "true"));
+  ASSERT_EQ(ceph_mount(ca, NULL), 0);
+
+  ASSERT_EQ(ceph_create(&cb, NULL), 0);
+  ASSERT_EQ(ceph_conf_read_file(cb, NULL), 0);
+  ASSERT_EQ(0, ceph_conf_parse_env(cb, NULL));
+  ASSERT_EQ(ceph_mount(cb, NULL), 0);
+
+  char dir[64];
+  snprintf(dir, sizeof(dir), "async_unlink.%d", getpid());
+  ASSERT_EQ(0, ceph_mkdir(ca, dir, 0755));
+
+  const int nfiles = 200;
+  char path[128];
+  for (int i = 0; i < nfiles; i++) {
+    snprintf(path, sizeof(path), "%s/f%d", dir, i);
+    int fd = ceph_open(ca, path, O_CREAT|O_RDWR, 0644);
+    ASSERT_LE(0, fd);
+    ceph_close(ca, fd);
+  }
+
+  // once the dir caps are issued, the unlinks are only queued on ca
+  for (int i = 0; i < nfiles; i++) {
+    snprintf(path, sizeof(path), "%s/f%d", dir, i);
+    ASSERT_EQ(0, ceph_unlink(ca, path));
+  }
+
+  // an open fd sees a queued unlink right away
+  struct ceph_statx stx;
+  snprintf(path, sizeof(path), "%s/held", dir);
+  int fd = ceph_open(ca, path, O_CREAT|O_RDWR, 0644);
+  ASSERT_LE(0, fd);
+  ASSERT_EQ(0, ceph_unlink(ca, path));
+  ASSERT_EQ(0, ceph_fstatx(ca, fd, &stx, CEPH_STATX_NLINK, AT_STATX_DONT_SYNC));
+  ASSERT_EQ(0u, stx.stx_nlink);
+  ceph_close(ca, fd);
+
+  // reading the dir from cb revokes ca's caps, which must wait for the queue
+  struct ceph_dir_result *dirp;
+  ASSERT_EQ(0, ceph_opendir(cb, dir, &dirp));
+  int entries = 0;
+  struct dirent *de;
+  while ((de = ceph_readdir(cb, dirp)) != NULL) {
+    if (strcmp(de->d_name, ".") && strcmp(de->d_name, ".."))
+      entries++;
+  }
+  ASSERT_EQ(0, ceph_closedir(cb, dirp));
+  ASSERT_EQ(0, entries);
+
+  for (int i = 0; i < nfiles; i++) {
+    snprintf(path, sizeof(path), "%s/f%d", dir, i);
+    ASSERT_EQ(-ENOENT, ceph_statx(cb, path, &stx, 0, 0));
+  }
+
+  ASSERT_EQ(0, ceph_rmdir(cb, dir));
+  ceph_shutdown(ca);
+  ceph_shutdown(cb);
+}
@@ -0,0 +1,197 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
+// vim: ts=8 sw=2 sts=2 expandtab
+
+/*
+ * Measure the aggregate rate of small ops that many threads can push
+ * through a single librados handle.  All threads share one Rados
+ * instance, and hence one Objecter, so this exercises client-side
+ * locking on the op submission and completion paths rather than OSD
+ * throughput.
+ */
+
+#include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "include/rados/librados.hpp"
+#include "common/ceph_argparse.h"
+#include "common/errno.h"
+
+namespace {
+
+struct Config {
+  std::string pool = "rbd";
+  int threads = 32;
+  int ops_per_thread = 100'000;
+  int depth = 16;
+  int objects = 128;
+  std::string rados_id = "admin";
+};
+
+// bounds the number of ops in flight for one submitting thread
+class Window {
+  std::mutex lock;
+  std::condition_variable cond;
+  int in_flight = 0;
+  const int depth;
+public:
+  explicit Window(int depth) : depth(depth) {}
+  void start() {
+    std::unique_lock l{lock};
+    cond.wait(l, [this] { return in_flight < depth; });
+    ++in_flight;
+  }
+  void finish() {
+    std::lock_guard l{lock};
+    --in_flight;
+    cond.notify_all();
+  }
+  void drain() {
+    std::unique_lock l{lock};
+    cond.wait(l, [this] { return in_flight == 0; });
+  }
+};
+
+struct OpState {
+  Window* window;
+  uint64_t size = 0;
+  time_t mtime = 0;
+};
+
+void op_complete(librados::completion_t c, void* arg)
+{
+  auto op = static_cast<OpState*>(arg);
+  auto window = op->window;
+  delete op;
+  window->finish();
+}
+
+std::atomic<int> errors{0};
+
+void run_thread(librados::IoCtx& ioctx, const Config& conf, int id)
+{
+  Window window{conf.depth};
+  for (int i = 0; i < conf.ops_per_thread; ++i) {
+    auto oid = "op_rate." + std::to_string((id + i) % conf.objects);
+    window.start();
+    auto op = new OpState{&window};
+    auto c = librados::Rados::aio_create_completion(op, op_complete);
+    int r = ioctx.aio_stat(oid, c, &op->size, &op->mtime);
+    c->release();
+    if (r < 0) {
+      // never submitted, so op_complete won't run for it
+      delete op;
+      window.finish();
+      ++errors;
+    }
+  }
+  window.drain();
+}
+
+void usage()
+{
+  Config d;
+  std::cout << "usage: ceph_test_rados_op_rate [options]\n"
+            << "  -p <pool>       pool to use (default " << d.pool << ")\n"
+            << "  -t <threads>    submitting threads (default "
+            << d.threads << ")\n"
+            << "  -n <ops>        ops per thread (default "
+            << d.ops_per_thread << ")\n"
+            << "  -d <depth>      ops in flight per thread (default "
+            << d.depth << ")\n"
+            << "  -o <objects>    number of objects (default "
+            << d.objects << ")\n"
+            << "  --name <id>     rados id (default " << d.rados_id << ")\n";
+}
+
+} // anonymous namespace
+
+int main(int argc, const char** argv)
+{
+  Config conf;
+  auto args = argv_to_vec(argc, argv);
+  for (unsigned i = 0; i < args.size(); ++i) {
+    if (strcmp(args[i], "--help") == 0 || strcmp(args[i], "-h") == 0) {
+      usage();
+      return 0;
+    }
+    if (i + 1 == args.size()) {
+      break;
+    }
+    if (strcmp(args[i], "-p") == 0) {
+      conf.pool = args[++i];
+    } else if (strcmp(args[i], "-t") == 0) {
+      conf.threads = std::max(1, atoi(args[++i]));
+    } else if (strcmp(args[i], "-n") == 0) {
+      conf.ops_per_thread = std::max(1, atoi(args[++i]));
+    } else if (strcmp(args[i], "-d") == 0) {
+      conf.depth = std::max(1, atoi(args[++i]));
+    } else if (strcmp(args[i], "-o") == 0) {
+      conf.objects = std::max(1, atoi(args[++i]));
+    } else if (strcmp(args[i], "--name") == 0) {
+      conf.rados_id = args[++i];
+    }
+  }
+
+  librados::Rados rados;
+  int r = rados.init(conf.rados_id.c_str());
+  if (r < 0) {
+    std::cerr << "init failed: " << cpp_strerror(r) << std::endl;
+    return 1;
+  }
+  rados.conf_parse_argv(argc, argv);
+  rados.conf_parse_env(nullptr);
+  rados.conf_read_file(nullptr);
+  r = rados.connect();
+  if (r < 0) {
+    std::cerr << "connect failed: " << cpp_strerror(r) << std::endl;
+    return 1;
+  }
+  librados::IoCtx ioctx;
+  r = rados.ioctx_create(conf.pool.c_str(), ioctx);
+  if (r < 0) {
+    std::cerr << "opening pool " << conf.pool << " failed: "
+              << cpp_strerror(r) << std::endl;
+    rados.shutdown();
+    return 1;
+  }
+
+  // stat ops are cheap on the OSD, so the client side dominates
+  for (int i = 0; i < conf.objects; ++i) {
+    ioctx.create("op_rate." + std::to_string(i), false);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < conf.threads; ++t) {
+    threads.emplace_back(run_thread, std::ref(ioctx), std::cref(conf), t);
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  auto elapsed = std::chrono::duration<double>(
+    std::chrono::steady_clock::now() - start).count();
+
+  uint64_t total = uint64_t(conf.threads) * conf.ops_per_thread;
+  std::cout << "threads " << conf.threads
+            << " depth " << conf.depth
+            << " ops " << total
+            << " errors " << errors
+            << " elapsed " << elapsed << "s"
+            << " rate " << uint64_t(total / elapsed) << " ops/s"
+            << std::endl;
+
+  for (int i = 0; i < conf.objects; ++i) {
+    ioctx.remove("op_rate." + std::to_string(i));
+  }
+  ioctx.close();
+  rados.shutdown();
+  return errors ? 1 : 0;
+}
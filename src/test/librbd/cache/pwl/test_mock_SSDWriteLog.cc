@@ -756,6 +756,38 @@ TEST_F(TestMockCacheSSDWriteLog, flush_source_user) {
   ASSERT_EQ(0, finish_ctx4.wait());
 }
 
+TEST_F(TestMockCacheSSDWriteLog, coalesce_flush_entries_later_group) {
+  // A and C share a stripe unit; B straddles the unit boundary and is
+  // flushed between them.  Merging C into A would write C's data before B.
+  const uint64_t stripe_unit = 4 << 20;
+  GenericLogEntries entries;
+  entries.push_back(std::make_shared<ssd::WriteLogEntry>(0, 4096));
+  entries.push_back(std::make_shared<DiscardLogEntry>(stripe_unit - 8192,
+                                                      16384));
+  entries.push_back(std::make_shared<ssd::WriteLogEntry>(4096,
+                                                         stripe_unit - 8192));
+
+  std::vector<bufferlist *> read_bls;
+  read_bls.push_back(new bufferlist);
+  read_bls.back()->append(std::string(4096, 'a'));
+  read_bls.push_back(new bufferlist);
+  read_bls.back()->append(std::string(stripe_unit - 8192, 'c'));
+
+  std::list<MockSSDWriteLog::FlushGroup> groups;
+  MockSSDWriteLog::coalesce_flush_entries(stripe_unit, entries, read_bls,
+                                          &groups);
+
+  ASSERT_EQ(3U, groups.size());
+  auto it = groups.begin();
+  for (auto &log_entry : entries) {
+    ASSERT_EQ(1U, it->log_entries.size());
+    ASSERT_EQ(log_entry, it->log_entries.front());
+    ASSERT_EQ(log_entry->ram_entry.image_offset_bytes, it->offset);
+    ASSERT_EQ(log_entry->ram_entry.write_bytes, it->length);
+    ++it;
+  }
+}
+
 } // namespace pwl
 } // namespace cache
 } // namespace librbd
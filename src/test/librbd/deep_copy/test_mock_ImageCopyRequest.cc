@@ -45,6 +45,22 @@ MockTestImageCtx* MockTestImageCtx::s_instance = nullptr;
 
 namespace deep_copy {
 
+// only moves when a test advances it
+struct MockClock {
+  typedef ceph::mono_clock::time_point time_point;
+  static time_point s_now;
+  static time_point now() {
+    return s_now;
+  }
+};
+
+MockClock::time_point MockClock::s_now;
+
+template <>
+struct TypeTraits<librbd::MockTestImageCtx> {
+  typedef MockClock Clock;
+};
+
 template <>
 struct ObjectCopyRequest<librbd::MockTestImageCtx> {
   static ObjectCopyRequest* s_instance;
@@ -201,6 +217,25 @@ public:
     return true;
   }
 
+  bool object_copy_sent(MockObjectCopyRequest &mock_object_copy_request,
+                        uint64_t object_num) {
+    std::lock_guard locker{mock_object_copy_request.lock};
+    return mock_object_copy_request.object_contexts.count(object_num) > 0;
+  }
+
+  // completes in this thread, so whatever the completion sends next has
+  // been sent by the time this returns
+  bool complete_object_copy_now(MockObjectCopyRequest &mock_object_copy_request,
+                                uint64_t object_num) {
+    Context *object_ctx = nullptr;
+    if (!complete_object_copy(mock_object_copy_request, object_num,
+                              &object_ctx, 0)) {
+      return false;
+    }
+    object_ctx->complete(0);
+    return true;
+  }
+
   SnapMap wait_for_snap_map(MockObjectCopyRequest &mock_object_copy_request) {
     std::unique_lock locker{mock_object_copy_request.lock};
     while (mock_object_copy_request.snap_map == nullptr) {
@@ -612,6 +647,109 @@ TEST_F(TestMockDeepCopyImageCopyRequest, RestartPartialSync) {
   ASSERT_EQ(0, ctx.wait());
 }
 
+TEST_F(TestMockDeepCopyImageCopyRequest, AdaptiveConcurrencyGrow) {
+  librados::snap_t snap_id_end;
+  ASSERT_EQ(0, create_snap("copy", &snap_id_end));
+
+  uint64_t object_count = 12;
+
+  librbd::MockTestImageCtx mock_src_image_ctx(*m_src_image_ctx);
+  librbd::MockTestImageCtx mock_dst_image_ctx(*m_dst_image_ctx);
+  mock_src_image_ctx.config.set_val("rbd_concurrent_management_ops", "2");
+  mock_src_image_ctx.config.set_val("rbd_deep_copy_max_concurrent_ops", "6");
+  MockObjectCopyRequest mock_object_copy_request;
+
+  MockDiffRequest mock_diff_request;
+  expect_diff_send(mock_diff_request, {}, -EINVAL);
+  expect_get_image_size(mock_src_image_ctx,
+                        object_count * (1 << m_src_image_ctx->order));
+  expect_get_image_size(mock_src_image_ctx, 0);
+
+  EXPECT_CALL(mock_object_copy_request, send()).Times(object_count);
+
+  librbd::deep_copy::NoOpHandler no_op;
+  C_SaferCond ctx;
+  auto request = new MockImageCopyRequest(&mock_src_image_ctx,
+                                          &mock_dst_image_ctx,
+                                          0, snap_id_end, 0, false, boost::none,
+                                          m_snap_seqs, &no_op, &ctx);
+  request->send();
+
+  // first window: a slow baseline at two at a time, kept as is
+  ASSERT_EQ(m_snap_map, wait_for_snap_map(mock_object_copy_request));
+  MockClock::s_now += 100ms;
+  ASSERT_TRUE(complete_object_copy_now(mock_object_copy_request, 0));
+  ASSERT_TRUE(complete_object_copy_now(mock_object_copy_request, 1));
+  ASSERT_TRUE(object_copy_sent(mock_object_copy_request, 3));
+  ASSERT_FALSE(object_copy_sent(mock_object_copy_request, 4));
+
+  // second window: the same concurrency, much faster, so it grows
+  MockClock::s_now += 10ms;
+  ASSERT_TRUE(complete_object_copy_now(mock_object_copy_request, 2));
+  ASSERT_TRUE(complete_object_copy_now(mock_object_copy_request, 3));
+  ASSERT_TRUE(object_copy_sent(mock_object_copy_request, 7));
+  ASSERT_FALSE(object_copy_sent(mock_object_copy_request, 8));
+
+  for (uint64_t i = 4; i < object_count; ++i) {
+    ASSERT_TRUE(complete_object_copy_now(mock_object_copy_request, i));
+  }
+  ASSERT_EQ(0, ctx.wait());
+}
+
+TEST_F(TestMockDeepCopyImageCopyRequest, AdaptiveConcurrencyBackOff) {
+  librados::snap_t snap_id_end;
+  ASSERT_EQ(0, create_snap("copy", &snap_id_end));
+
+  uint64_t object_count = 12;
+
+  librbd::MockTestImageCtx mock_src_image_ctx(*m_src_image_ctx);
+  librbd::MockTestImageCtx mock_dst_image_ctx(*m_dst_image_ctx);
+  mock_src_image_ctx.config.set_val("rbd_concurrent_management_ops", "2");
+  mock_src_image_ctx.config.set_val("rbd_deep_copy_max_concurrent_ops", "6");
+  MockObjectCopyRequest mock_object_copy_request;
+
+  MockDiffRequest mock_diff_request;
+  expect_diff_send(mock_diff_request, {}, -EINVAL);
+  expect_get_image_size(mock_src_image_ctx,
+                        object_count * (1 << m_src_image_ctx->order));
+  expect_get_image_size(mock_src_image_ctx, 0);
+
+  EXPECT_CALL(mock_object_copy_request, send()).Times(object_count);
+
+  librbd::deep_copy::NoOpHandler no_op;
+  C_SaferCond ctx;
+  auto request = new MockImageCopyRequest(&mock_src_image_ctx,
+                                          &mock_dst_image_ctx,
+                                          0, snap_id_end, 0, false, boost::none,
+                                          m_snap_seqs, &no_op, &ctx);
+  request->send();
+
+  // a slow baseline, then a faster window that grows to four at a time
+  ASSERT_EQ(m_snap_map, wait_for_snap_map(mock_object_copy_request));
+  MockClock::s_now += 100ms;
+  ASSERT_TRUE(complete_object_copy_now(mock_object_copy_request, 0));
+  ASSERT_TRUE(complete_object_copy_now(mock_object_copy_request, 1));
+  MockClock::s_now += 10ms;
+  ASSERT_TRUE(complete_object_copy_now(mock_object_copy_request, 2));
+  ASSERT_TRUE(complete_object_copy_now(mock_object_copy_request, 3));
+  ASSERT_TRUE(object_copy_sent(mock_object_copy_request, 7));
+
+  // four at a time turns out much slower: back to two
+  MockClock::s_now += 500ms;
+  for (uint64_t i = 4; i < 8; ++i) {
+    ASSERT_TRUE(complete_object_copy_now(mock_object_copy_request, i));
+  }
+  ASSERT_TRUE(object_copy_sent(mock_object_copy_request, 10));
+  ASSERT_FALSE(object_copy_sent(mock_object_copy_request, 11));
+  ASSERT_TRUE(complete_object_copy_now(mock_object_copy_request, 8));
+  ASSERT_FALSE(object_copy_sent(mock_object_copy_request, 11));
+
+  for (uint64_t i = 9; i < object_count; ++i) {
+    ASSERT_TRUE(complete_object_copy_now(mock_object_copy_request, i));
+  }
+  ASSERT_EQ(0, ctx.wait());
+}
+
 TEST_F(TestMockDeepCopyImageCopyRequest, Cancel) {
   std::string max_ops_str;
   ASSERT_EQ(0, _rados.conf_get("rbd_concurrent_management_ops", max_ops_str));
@@ -0,0 +1,445 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
+// vim: ts=8 sw=2 sts=2 expandtab
+
+#include "test/librbd/test_mock_fixture.h"
+#include "test/librbd/test_support.h"
+#include "test/librbd/mock/MockImageCtx.h"
+#include "test/librbd/mock/MockExclusiveLock.h"
+#include "include/rbd/librbd.hpp"
+#include "librbd/io/ImageDispatchSpec.h"
+#include "librbd/io/ReadaheadImageDispatch.h"
+
+namespace librbd {
+namespace {
+
+struct MockTestImageCtx : public MockImageCtx {
+  MockTestImageCtx(ImageCtx &image_ctx) : MockImageCtx(image_ctx) {
+  }
+};
+
+} // anonymous namespace
+
+namespace util {
+
+inline ImageCtx *get_image_ctx(MockTestImageCtx *image_ctx) {
+  return image_ctx->image_ctx;
+}
+
+} // namespace util
+} // namespace librbd
+
+#include "librbd/io/ReadaheadImageDispatch.cc"
+
+namespace librbd {
+namespace io {
+
+using ::testing::_;
+using ::testing::InSequence;
+using ::testing::Invoke;
+using ::testing::Return;
+
+struct TestMockIoReadaheadImageDispatch : public TestMockFixture {
+  typedef ReadaheadImageDispatch<librbd::MockTestImageCtx> MockReadaheadImageDispatch;
+
+  // a small area size stops readahead after the first prefetch
+  void init_image_ctx(MockTestImageCtx &mock_image_ctx,
+                      MockExclusiveLock &mock_exclusive_lock,
+                      bool lock_owner, uint64_t area_size = 16384) {
+    // readahead after two sequential reads
+    mock_image_ctx.config.set_val_or_die("rbd_readahead_trigger_requests",
+                                         "2");
+    mock_image_ctx.exclusive_lock = &mock_exclusive_lock;
+
+    EXPECT_CALL(mock_exclusive_lock, is_lock_owner())
+      .WillRepeatedly(Return(lock_owner));
+    EXPECT_CALL(mock_image_ctx, get_area_size(ImageArea::DATA))
+      .WillRepeatedly(Return(area_size));
+    EXPECT_CALL(mock_image_ctx.readahead, inc_pending())
+      .WillRepeatedly(Return());
+    EXPECT_CALL(mock_image_ctx.readahead, dec_pending())
+      .WillRepeatedly(Return());
+  }
+
+  void expect_prefetch(MockTestImageCtx &mock_image_ctx,
+                       uint64_t offset, uint64_t length,
+                       ImageDispatchSpec** spec) {
+    EXPECT_CALL(*mock_image_ctx.io_image_dispatcher, send(_))
+      .WillOnce(Invoke([offset, length, spec](ImageDispatchSpec* s) {
+                  EXPECT_EQ(IMAGE_DISPATCH_LAYER_READAHEAD, s->dispatch_layer);
+                  EXPECT_EQ(Extents({{offset, length}}), s->image_extents);
+                  *spec = s;
+                }));
+  }
+
+  void complete_prefetch(ImageDispatchSpec* spec, char c) {
+    auto aio_comp = spec->aio_comp;
+    auto& read = std::get<ImageDispatchSpec::Read>(spec->request);
+    auto image_extents = spec->image_extents;
+
+    spec->dispatch_result = DISPATCH_RESULT_COMPLETE;
+    aio_comp->read_result = std::move(read.read_result);
+    aio_comp->read_result.set_image_extents(image_extents);
+    aio_comp->set_request_count(1);
+
+    auto req_comp = new ReadResult::C_ImageReadRequest(
+      aio_comp, 0, image_extents);
+    req_comp->bl.append(std::string(image_extents.front().second, c));
+    req_comp->complete(0);
+  }
+
+  bool read(MockTestImageCtx &mock_image_ctx,
+            MockReadaheadImageDispatch &dispatch, AioCompletion* aio_comp,
+            uint64_t offset, uint64_t length, ReadResult* read_result,
+            DispatchResult* dispatch_result, Context* on_dispatched) {
+    std::atomic<uint32_t> image_dispatch_flags = 0;
+    Context* on_finish = nullptr;
+    return dispatch.read(
+      aio_comp, {{offset, length}}, std::move(*read_result),
+      mock_image_ctx.get_data_io_context(), 0, 0, {}, 0,
+      &image_dispatch_flags, dispatch_result, &on_finish, on_dispatched);
+  }
+
+  // reads that do not hit the buffers
+  void read_miss(MockTestImageCtx &mock_image_ctx,
+                 MockReadaheadImageDispatch &dispatch,
+                 uint64_t offset, uint64_t length) {
+    ReadResult read_result;
+    DispatchResult dispatch_result;
+    ASSERT_FALSE(read(mock_image_ctx, dispatch, nullptr, offset, length,
+                      &read_result, &dispatch_result, nullptr));
+  }
+
+  void read_hit(MockTestImageCtx &mock_image_ctx,
+                MockReadaheadImageDispatch &dispatch,
+                uint64_t offset, uint64_t length, char c) {
+    C_SaferCond aio_comp_ctx;
+    auto aio_comp = AioCompletion::create_and_start(
+      &aio_comp_ctx, mock_image_ctx.image_ctx, AIO_TYPE_READ);
+    bufferlist bl;
+    ReadResult read_result{&bl};
+    DispatchResult dispatch_result;
+    ASSERT_TRUE(read(mock_image_ctx, dispatch, aio_comp, offset, length,
+                     &read_result, &dispatch_result, nullptr));
+    ASSERT_EQ(DISPATCH_RESULT_COMPLETE, dispatch_result);
+    ASSERT_EQ((int)length, aio_comp_ctx.wait());
+
+    bufferlist expected_bl;
+    expected_bl.append(std::string(length, c));
+    ASSERT_TRUE(expected_bl.contents_equal(bl));
+  }
+
+  void write(MockReadaheadImageDispatch &dispatch, uint64_t offset,
+             uint64_t length) {
+    std::atomic<uint32_t> image_dispatch_flags = 0;
+    DispatchResult dispatch_result;
+    C_SaferCond cond;
+    Context* on_finish = &cond;
+    bufferlist bl;
+    bl.append(std::string(length, '1'));
+    ASSERT_FALSE(dispatch.write(nullptr, {{offset, length}}, std::move(bl), 0,
+                                {}, 0, &image_dispatch_flags,
+                                &dispatch_result, &on_finish, nullptr));
+    ASSERT_NE(on_finish, &cond);
+    on_finish->complete(0);
+    ASSERT_EQ(0, cond.wait());
+  }
+
+  void shut_down(MockReadaheadImageDispatch &dispatch) {
+    C_SaferCond ctx;
+    dispatch.shut_down(&ctx);
+    ASSERT_EQ(0, ctx.wait());
+  }
+};
+
+TEST_F(TestMockIoReadaheadImageDispatch, SequentialStream) {
+  librbd::ImageCtx *ictx;
+  ASSERT_EQ(0, open_image(m_image_name, &ictx));
+
+  MockTestImageCtx mock_image_ctx(*ictx);
+  MockExclusiveLock mock_exclusive_lock;
+  init_image_ctx(mock_image_ctx, mock_exclusive_lock, true, ictx->size);
+  MockReadaheadImageDispatch dispatch(&mock_image_ctx);
+
+  InSequence seq;
+  ImageDispatchSpec* spec1 = nullptr;
+  ImageDispatchSpec* spec2 = nullptr;
+  expect_prefetch(mock_image_ctx, 8192, 8192, &spec1);
+  expect_prefetch(mock_image_ctx, 16384, 16384, &spec2);
+
+  read_miss(mock_image_ctx, dispatch, 0, 4096);
+  read_miss(mock_image_ctx, dispatch, 4096, 4096);
+  ASSERT_TRUE(spec1 != nullptr);
+  complete_prefetch(spec1, 'a');
+
+  // served from the buffer, which also extends the readahead window
+  read_hit(mock_image_ctx, dispatch, 8192, 4096, 'a');
+  ASSERT_TRUE(spec2 != nullptr);
+  complete_prefetch(spec2, 'b');
+
+  read_hit(mock_image_ctx, dispatch, 12288, 4096, 'a');
+  read_hit(mock_image_ctx, dispatch, 16384, 4096, 'b');
+
+  shut_down(dispatch);
+}
+
+TEST_F(TestMockIoReadaheadImageDispatch, InterleavedStreams) {
+  librbd::ImageCtx *ictx;
+  ASSERT_EQ(0, open_image(m_image_name, &ictx));
+
+  MockTestImageCtx mock_image_ctx(*ictx);
+  MockExclusiveLock mock_exclusive_lock;
+  init_image_ctx(mock_image_ctx, mock_exclusive_lock, true, ictx->size);
+  MockReadaheadImageDispatch dispatch(&mock_image_ctx);
+
+  InSequence seq;
+  ImageDispatchSpec* spec1 = nullptr;
+  ImageDispatchSpec* spec2 = nullptr;
+  expect_prefetch(mock_image_ctx, 8192, 8192, &spec1);
+  expect_prefetch(mock_image_ctx, (1 << 20) + 12288, 8192, &spec2);
+
+  // each reader is tracked as its own stream
+  read_miss(mock_image_ctx, dispatch, 0, 4096);
+  read_miss(mock_image_ctx, dispatch, 1 << 20, 4096);
+  read_miss(mock_image_ctx, dispatch, 4096, 4096);
+  read_miss(mock_image_ctx, dispatch, (1 << 20) + 4096, 4096);
+  read_miss(mock_image_ctx, dispatch, (1 << 20) + 8192, 4096);
+  ASSERT_TRUE(spec1 != nullptr);
+  ASSERT_TRUE(spec2 != nullptr);
+  complete_prefetch(spec1, 'a');
+  complete_prefetch(spec2, 'b');
+
+  read_hit(mock_image_ctx, dispatch, 8192, 2048, 'a');
+  read_hit(mock_image_ctx, dispatch, (1 << 20) + 12288, 2048, 'b');
+
+  shut_down(dispatch);
+}
+
+TEST_F(TestMockIoReadaheadImageDispatch, BufferConsumed) {
+  librbd::ImageCtx *ictx;
+  ASSERT_EQ(0, open_image(m_image_name, &ictx));
+
+  MockTestImageCtx mock_image_ctx(*ictx);
+  MockExclusiveLock mock_exclusive_lock;
+  init_image_ctx(mock_image_ctx, mock_exclusive_lock, true);
+  MockReadaheadImageDispatch dispatch(&mock_image_ctx);
+
+  InSequence seq;
+  ImageDispatchSpec* spec = nullptr;
+  expect_prefetch(mock_image_ctx, 8192, 8192, &spec);
+
+  read_miss(mock_image_ctx, dispatch, 0, 4096);
+  read_miss(mock_image_ctx, dispatch, 4096, 4096);
+  ASSERT_TRUE(spec != nullptr);
+  complete_prefetch(spec, 'a');
+
+  // data is handed out once: the head of the buffer is consumed by the
+  // first read and the rest by the second
+  read_hit(mock_image_ctx, dispatch, 8192, 2048, 'a');
+  read_miss(mock_image_ctx, dispatch, 8192, 2048);
+  read_hit(mock_image_ctx, dispatch, 10240, 6144, 'a');
+  read_miss(mock_image_ctx, dispatch, 12288, 4096);
+
+  shut_down(dispatch);
+}
+
+TEST_F(TestMockIoReadaheadImageDispatch, WaitForPrefetch) {
+  librbd::ImageCtx *ictx;
+  ASSERT_EQ(0, open_image(m_image_name, &ictx));
+
+  MockTestImageCtx mock_image_ctx(*ictx);
+  MockExclusiveLock mock_exclusive_lock;
+  init_image_ctx(mock_image_ctx, mock_exclusive_lock, true);
+  MockReadaheadImageDispatch dispatch(&mock_image_ctx);
+
+  InSequence seq;
+  ImageDispatchSpec* spec = nullptr;
+  expect_prefetch(mock_image_ctx, 8192, 8192, &spec);
+
+  read_miss(mock_image_ctx, dispatch, 0, 4096);
+  read_miss(mock_image_ctx, dispatch, 4096, 4096);
+  ASSERT_TRUE(spec != nullptr);
+
+  C_SaferCond aio_comp_ctx;
+  auto aio_comp = AioCompletion::create_and_start(
+    &aio_comp_ctx, ictx, AIO_TYPE_READ);
+  bufferlist bl;
+  ReadResult read_result{&bl};
+  DispatchResult dispatch_result;
+  ASSERT_TRUE(read(mock_image_ctx, dispatch, aio_comp, 8192, 4096,
+                   &read_result, &dispatch_result, nullptr));
+  ASSERT_EQ(DISPATCH_RESULT_CONTINUE, dispatch_result);
+
+  complete_prefetch(spec, 'a');
+  ASSERT_EQ(DISPATCH_RESULT_COMPLETE, dispatch_result);
+  ASSERT_EQ(4096, aio_comp_ctx.wait());
+
+  bufferlist expected_bl;
+  expected_bl.append(std::string(4096, 'a'));
+  ASSERT_TRUE(expected_bl.contents_equal(bl));
+
+  shut_down(dispatch);
+}
+
+TEST_F(TestMockIoReadaheadImageDispatch, InvalidateOnWrite) {
+  librbd::ImageCtx *ictx;
+  ASSERT_EQ(0, open_image(m_image_name, &ictx));
+
+  MockTestImageCtx mock_image_ctx(*ictx);
+  MockExclusiveLock mock_exclusive_lock;
+  init_image_ctx(mock_image_ctx, mock_exclusive_lock, true);
+  MockReadaheadImageDispatch dispatch(&mock_image_ctx);
+
+  InSequence seq;
+  ImageDispatchSpec* spec = nullptr;
+  expect_prefetch(mock_image_ctx, 8192, 8192, &spec);
+
+  read_miss(mock_image_ctx, dispatch, 0, 4096);
+  read_miss(mock_image_ctx, dispatch, 4096, 4096);
+  ASSERT_TRUE(spec != nullptr);
+  complete_prefetch(spec, 'a');
+
+  write(dispatch, 12288, 512);
+  read_miss(mock_image_ctx, dispatch, 8192, 4096);
+
+  shut_down(dispatch);
+}
+
+TEST_F(TestMockIoReadaheadImageDispatch, InvalidateOnDiscard) {
+  librbd::ImageCtx *ictx;
+  ASSERT_EQ(0, open_image(m_image_name, &ictx));
+
+  MockTestImageCtx mock_image_ctx(*ictx);
+  MockExclusiveLock mock_exclusive_lock;
+  init_image_ctx(mock_image_ctx, mock_exclusive_lock, true);
+  MockReadaheadImageDispatch dispatch(&mock_image_ctx);
+
+  InSequence seq;
+  ImageDispatchSpec* spec = nullptr;
+  expect_prefetch(mock_image_ctx, 8192, 8192, &spec);
+
+  read_miss(mock_image_ctx, dispatch, 0, 4096);
+  read_miss(mock_image_ctx, dispatch, 4096, 4096);
+  ASSERT_TRUE(spec != nullptr);
+
+  // the read waits for the prefetch, which is invalidated in the meantime
+  C_SaferCond on_dispatched;
+  ReadResult read_result;
+  DispatchResult dispatch_result;
+  ASSERT_TRUE(read(mock_image_ctx, dispatch, nullptr, 8192, 4096,
+                   &read_result, &dispatch_result, &on_dispatched));
+
+  std::atomic<uint32_t> image_dispatch_flags = 0;
+  DispatchResult discard_dispatch_result;
+  C_SaferCond cond;
+  Context* on_finish = &cond;
+  ASSERT_FALSE(dispatch.discard(nullptr, {{8192, 4096}}, 0, {}, 0,
+                                &image_dispatch_flags,
+                                &discard_dispatch_result, &on_finish,
+                                nullptr));
+  on_finish->complete(0);
+  ASSERT_EQ(0, cond.wait());
+
+  complete_prefetch(spec, 'a');
+  ASSERT_EQ(0, on_dispatched.wait());
+  ASSERT_EQ(DISPATCH_RESULT_CONTINUE, dispatch_result);
+
+  shut_down(dispatch);
+}
+
+TEST_F(TestMockIoReadaheadImageDispatch, InvalidateCache) {
+  librbd::ImageCtx *ictx;
+  ASSERT_EQ(0, open_image(m_image_name, &ictx));
+
+  MockTestImageCtx mock_image_ctx(*ictx);
+  MockExclusiveLock mock_exclusive_lock;
+  init_image_ctx(mock_image_ctx, mock_exclusive_lock, true);
+  MockReadaheadImageDispatch dispatch(&mock_image_ctx);
+
+  InSequence seq;
+  ImageDispatchSpec* spec = nullptr;
+  expect_prefetch(mock_image_ctx, 8192, 8192, &spec);
+
+  read_miss(mock_image_ctx, dispatch, 0, 4096);
+  read_miss(mock_image_ctx, dispatch, 4096, 4096);
+  ASSERT_TRUE(spec != nullptr);
+  complete_prefetch(spec, 'a');
+
+  ASSERT_FALSE(dispatch.invalidate_cache(nullptr));
+  read_miss(mock_image_ctx, dispatch, 8192, 4096);
+
+  shut_down(dispatch);
+}
+
+TEST_F(TestMockIoReadaheadImageDispatch, InvalidateCacheDuringPrefetch) {
+  librbd::ImageCtx *ictx;
+  ASSERT_EQ(0, open_image(m_image_name, &ictx));
+
+  MockTestImageCtx mock_image_ctx(*ictx);
+  MockExclusiveLock mock_exclusive_lock;
+  init_image_ctx(mock_image_ctx, mock_exclusive_lock, true);
+  MockReadaheadImageDispatch dispatch(&mock_image_ctx);
+
+  InSequence seq;
+  ImageDispatchSpec* spec = nullptr;
+  expect_prefetch(mock_image_ctx, 8192, 8192, &spec);
+
+  read_miss(mock_image_ctx, dispatch, 0, 4096);
+  read_miss(mock_image_ctx, dispatch, 4096, 4096);
+  ASSERT_TRUE(spec != nullptr);
+
+  // data prefetched before the lock was released is not served after
+  ASSERT_FALSE(dispatch.invalidate_cache(nullptr));
+  complete_prefetch(spec, 'a');
+  read_miss(mock_image_ctx, dispatch, 8192, 4096);
+
+  shut_down(dispatch);
+}
+
+TEST_F(TestMockIoReadaheadImageDispatch, InvalidateCacheDuringRead) {
+  librbd::ImageCtx *ictx;
+  ASSERT_EQ(0, open_image(m_image_name, &ictx));
+
+  MockTestImageCtx mock_image_ctx(*ictx);
+  MockExclusiveLock mock_exclusive_lock;
+  init_image_ctx(mock_image_ctx, mock_exclusive_lock, true);
+  MockReadaheadImageDispatch dispatch(&mock_image_ctx);
+
+  EXPECT_CALL(*mock_image_ctx.io_image_dispatcher, send(_)).Times(0);
+
+  read_miss(mock_image_ctx, dispatch, 0, 4096);
+
+  // the lock is released right after the read found us the owner: the
+  // read must not start a stream behind the invalidation, or the next
+  // read would continue it and prefetch
+  EXPECT_CALL(mock_exclusive_lock, is_lock_owner())
+    .WillOnce(Invoke([&dispatch]() {
+                EXPECT_FALSE(dispatch.invalidate_cache(nullptr));
+                return true;
+              }))
+    .RetiresOnSaturation();
+  read_miss(mock_image_ctx, dispatch, 4096, 4096);
+  read_miss(mock_image_ctx, dispatch, 8192, 4096);
+
+  shut_down(dispatch);
+}
+
+TEST_F(TestMockIoReadaheadImageDispatch, NotLockOwner) {
+  librbd::ImageCtx *ictx;
+  ASSERT_EQ(0, open_image(m_image_name, &ictx));
+
+  MockTestImageCtx mock_image_ctx(*ictx);
+  MockExclusiveLock mock_exclusive_lock;
+  init_image_ctx(mock_image_ctx, mock_exclusive_lock, false);
+  MockReadaheadImageDispatch dispatch(&mock_image_ctx);
+
+  EXPECT_CALL(*mock_image_ctx.io_image_dispatcher, send(_)).Times(0);
+
+  for (uint64_t offset = 0; offset < 65536; offset += 4096) {
+    read_miss(mock_image_ctx, dispatch, offset, 4096);
+  }
+
+  shut_down(dispatch);
+}
+
+} // namespace io
+} // namespace librbd
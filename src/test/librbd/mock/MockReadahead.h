@@ -14,6 +14,8 @@ namespace librbd {
 struct MockReadahead {
   MOCK_METHOD1(set_max_readahead_size, void(uint64_t));
   MOCK_METHOD1(wait_for_pending, void(Context *));
+  MOCK_METHOD0(inc_pending, void());
+  MOCK_METHOD0(dec_pending, void());
 };
 
 } // namespace librbd
@@ -135,6 +135,39 @@ public:
     expect.WillOnce(Return(r));
   }
 
+  void add_snapshot(MockObjectMapImageCtx &mock_image_ctx, uint64_t snap_id,
+                    const cls::rbd::SnapshotNamespace& snap_namespace) {
+    mock_image_ctx.snap_info.insert(
+      {snap_id, {"snap", snap_namespace,
+                 mock_image_ctx.image_ctx->size, {}, 0, 0, {}}});
+  }
+
+  void refresh_snapshot(MockObjectMapImageCtx &mock_image_ctx,
+                        ceph::BitVector<2> &on_disk_object_map,
+                        bool cached) {
+    InSequence seq;
+    expect_get_image_size(mock_image_ctx, TEST_SNAP_ID,
+                          mock_image_ctx.image_ctx->size);
+    if (!cached) {
+      expect_object_map_load(mock_image_ctx, &on_disk_object_map,
+                             TEST_SNAP_ID, 0);
+    }
+    expect_get_image_size(mock_image_ctx, TEST_SNAP_ID,
+                          mock_image_ctx.image_ctx->size);
+    if (cached) {
+      expect_op_work_queue(mock_image_ctx);
+    }
+
+    C_SaferCond ctx;
+    ceph::shared_mutex object_map_lock = ceph::make_shared_mutex("lock");
+    ceph::BitVector<2> object_map;
+    MockRefreshRequest *req = new MockRefreshRequest(
+      mock_image_ctx, &object_map_lock, &object_map, TEST_SNAP_ID, &ctx);
+    req->send();
+    ASSERT_EQ(0, ctx.wait());
+    ASSERT_EQ(on_disk_object_map, object_map);
+  }
+
   void init_object_map(MockObjectMapImageCtx &mock_image_ctx,
                        ceph::BitVector<2> *object_map) {
     uint64_t num_objs = Striper::get_num_objects(
@@ -206,6 +239,88 @@ TEST_F(TestMockObjectMapRefreshRequest, SuccessSnapshot) {
   ASSERT_EQ(on_disk_object_map, object_map);
 }
 
+TEST_F(TestMockObjectMapRefreshRequest, SuccessSnapshotCached) {
+  REQUIRE_FEATURE(RBD_FEATURE_OBJECT_MAP);
+
+  librbd::ImageCtx *ictx;
+  ASSERT_EQ(0, open_image(m_image_name, &ictx));
+
+  MockObjectMapImageCtx mock_image_ctx(*ictx);
+  MockObjectMapImageCtx mock_child_image_ctx(*ictx);
+  mock_image_ctx.child = &mock_child_image_ctx;
+  add_snapshot(mock_image_ctx, TEST_SNAP_ID,
+               cls::rbd::UserSnapshotNamespace{});
+
+  ceph::BitVector<2> on_disk_object_map;
+  init_object_map(mock_image_ctx, &on_disk_object_map);
+
+  refresh_snapshot(mock_image_ctx, on_disk_object_map, false);
+  // second load is served from the snapshot cache
+  refresh_snapshot(mock_image_ctx, on_disk_object_map, true);
+}
+
+TEST_F(TestMockObjectMapRefreshRequest, SuccessSnapshotNotParent) {
+  REQUIRE_FEATURE(RBD_FEATURE_OBJECT_MAP);
+
+  librbd::ImageCtx *ictx;
+  ASSERT_EQ(0, open_image(m_image_name, &ictx));
+
+  MockObjectMapImageCtx mock_image_ctx(*ictx);
+  add_snapshot(mock_image_ctx, TEST_SNAP_ID,
+               cls::rbd::UserSnapshotNamespace{});
+
+  ceph::BitVector<2> on_disk_object_map;
+  init_object_map(mock_image_ctx, &on_disk_object_map);
+
+  refresh_snapshot(mock_image_ctx, on_disk_object_map, false);
+  refresh_snapshot(mock_image_ctx, on_disk_object_map, false);
+}
+
+TEST_F(TestMockObjectMapRefreshRequest, SuccessSnapshotIncompleteMirror) {
+  REQUIRE_FEATURE(RBD_FEATURE_OBJECT_MAP);
+
+  librbd::ImageCtx *ictx;
+  ASSERT_EQ(0, open_image(m_image_name, &ictx));
+
+  MockObjectMapImageCtx mock_image_ctx(*ictx);
+  MockObjectMapImageCtx mock_child_image_ctx(*ictx);
+  mock_image_ctx.child = &mock_child_image_ctx;
+  add_snapshot(mock_image_ctx, TEST_SNAP_ID,
+               cls::rbd::UserSnapshotNamespace{});
+  add_snapshot(mock_image_ctx, TEST_SNAP_ID + 1,
+               cls::rbd::MirrorSnapshotNamespace{
+                 cls::rbd::MIRROR_SNAPSHOT_STATE_NON_PRIMARY, {}, "peer uuid",
+                 1});
+
+  ceph::BitVector<2> on_disk_object_map;
+  init_object_map(mock_image_ctx, &on_disk_object_map);
+
+  // rbd-mirror may still be writing into the snapshot
+  refresh_snapshot(mock_image_ctx, on_disk_object_map, false);
+  refresh_snapshot(mock_image_ctx, on_disk_object_map, false);
+}
+
+TEST_F(TestMockObjectMapRefreshRequest, SuccessSnapshotMigrationTarget) {
+  REQUIRE_FEATURE(RBD_FEATURE_OBJECT_MAP);
+
+  librbd::ImageCtx *ictx;
+  ASSERT_EQ(0, open_image(m_image_name, &ictx));
+
+  MockObjectMapImageCtx mock_image_ctx(*ictx);
+  MockObjectMapImageCtx mock_child_image_ctx(*ictx);
+  mock_image_ctx.child = &mock_child_image_ctx;
+  mock_image_ctx.migration_info = {
+    ictx->md_ctx.get_id(), "", "source", "source id", "", {}, 0, false};
+  add_snapshot(mock_image_ctx, TEST_SNAP_ID,
+               cls::rbd::UserSnapshotNamespace{});
+
+  ceph::BitVector<2> on_disk_object_map;
+  init_object_map(mock_image_ctx, &on_disk_object_map);
+
+  refresh_snapshot(mock_image_ctx, on_disk_object_map, false);
+  refresh_snapshot(mock_image_ctx, on_disk_object_map, false);
+}
+
 TEST_F(TestMockObjectMapRefreshRequest, LoadError) {
   REQUIRE_FEATURE(RBD_FEATURE_OBJECT_MAP);
 
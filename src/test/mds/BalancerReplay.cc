@@ -0,0 +1,116 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
+// vim: ts=8 sw=2 sts=2 expandtab
+
+#include "BalancerReplay.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+#include <vector>
+
+#include "mds/Mantle.h"
+
+namespace balancer_replay {
+
+void load_trace(std::istream& in, trace_t* trace)
+{
+  static const std::string tag = "trace epoch ";
+
+  std::string line;
+  while (std::getline(in, line)) {
+    auto pos = line.find(tag);
+    if (pos == std::string::npos) {
+      continue;
+    }
+    std::istringstream ss(line.substr(pos + tag.size()));
+    int epoch;
+    std::string who;
+    if (!(ss >> epoch >> who) || who.compare(0, 4, "mds.") != 0) {
+      continue;
+    }
+    auto& ranks = (*trace)[epoch];
+    mds_rank_t rank = atoi(who.c_str() + 4);
+    if (ranks.count(rank)) {
+      continue;  // every rank logs the load of every rank
+    }
+    auto& metrics = ranks[rank];
+    std::string kv;
+    while (ss >> kv) {
+      auto eq = kv.find('=');
+      if (eq != std::string::npos) {
+        metrics[kv.substr(0, eq)] = atof(kv.c_str() + eq + 1);
+      }
+    }
+  }
+}
+
+int replay(const Config& conf, const trace_t& trace, const std::string& script,
+           Result* res)
+{
+  std::map<mds_rank_t, double> shift;
+  // (exporter, importer) -> last epoch load moved that way
+  std::map<std::pair<mds_rank_t, mds_rank_t>, int> last_move;
+
+  for (const auto& [epoch, ranks] : trace) {
+    // skip epochs some rank's heartbeat is missing from
+    mds_rank_t size = ranks.size();
+    if (ranks.empty() || ranks.rbegin()->first != size - 1) {
+      continue;
+    }
+
+    std::vector<metrics_t> metrics;
+    for (const auto& [rank, m] : ranks) {
+      metrics.push_back(m);
+      auto& load = metrics.back()[conf.metric];
+      load = std::max(0.0, load + shift[rank]);
+    }
+
+    double max = 0, total = 0;
+    for (auto& m : metrics) {
+      max = std::max(max, m[conf.metric]);
+      total += m[conf.metric];
+    }
+    res->epochs++;
+    if (total > 0) {
+      res->imbalance += max / (total / size);
+    }
+
+    for (mds_rank_t whoami = 0; whoami < size; whoami++) {
+      Mantle mantle;
+      std::map<mds_rank_t, double> targets;
+      int r = mantle.balance(script, whoami, metrics, targets);
+      if (r < 0) {
+        return r;
+      }
+      for (auto [target, amount] : targets) {
+        if (target == whoami || target < 0 || target >= size || amount <= 0) {
+          continue;
+        }
+        auto back = last_move.find({target, whoami});
+        int since = back == last_move.end() ? -1 : epoch - back->second;
+        if (since >= 0 && since < conf.hold) {
+          res->held++;
+          continue;
+        }
+        auto& have = metrics[whoami][conf.metric];
+        amount = std::min(amount, have);
+        if (amount <= 0) {
+          continue;
+        }
+        have -= amount;
+        metrics[target][conf.metric] += amount;
+        shift[whoami] -= amount;
+        shift[target] += amount;
+        last_move[{whoami, target}] = epoch;
+        res->migrations++;
+        res->moved += amount;
+        if (since >= 0 && since < conf.window) {
+          res->pingpongs++;
+        }
+      }
+    }
+  }
+  return 0;
+}
+
+} // namespace balancer_replay
@@ -0,0 +1,54 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
+// vim: ts=8 sw=2 sts=2 expandtab
+
+/*
+ * Replay the per-epoch rank loads that MDBalancer logs at
+ * debug_mds_balancer >= 5 ("trace epoch <n> mds.<rank> name=value ...")
+ * through a Mantle balancer policy, so that policies can be compared
+ * offline against a recorded workload.
+ *
+ * The trace is taken as the load that would have arrived with no
+ * balancing at all.  Whatever a policy moves off a rank is subtracted
+ * from that rank's metric for the rest of the replay and added to the
+ * importer's; every other metric is replayed as recorded.
+ */
+
+#ifndef CEPH_TEST_MDS_BALANCER_REPLAY_H
+#define CEPH_TEST_MDS_BALANCER_REPLAY_H
+
+#include <istream>
+#include <map>
+#include <string>
+
+#include "include/cephfs/types.h"
+
+namespace balancer_replay {
+
+typedef std::map<std::string, double> metrics_t;
+// epoch -> rank -> metrics
+typedef std::map<int, std::map<mds_rank_t, metrics_t>> trace_t;
+
+struct Config {
+  std::string metric = "auth.meta_load";
+  int hold = 0;    // refuse to move load back within this many epochs
+  int window = 5;  // count a move back within this many epochs as ping-pong
+};
+
+struct Result {
+  int epochs = 0;
+  int migrations = 0;
+  double moved = 0;
+  int pingpongs = 0;
+  int held = 0;
+  double imbalance = 0;  // sum over epochs of max / mean rank load
+};
+
+// read the trace lines out of an MDS log, ignoring everything else
+void load_trace(std::istream& in, trace_t* trace);
+
+int replay(const Config& conf, const trace_t& trace, const std::string& script,
+           Result* res);
+
+} // namespace balancer_replay
+
+#endif
@@ -0,0 +1,105 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
+// vim: ts=8 sw=2 sts=2 expandtab
+
+#include <cerrno>
+#include <sstream>
+
+#include "BalancerReplay.h"
+
+#include "gtest/gtest.h"
+
+using namespace balancer_replay;
+
+// move half of the difference to the other rank of two
+static const std::string halve_policy =
+  "local other = 1 - whoami\n"
+  "local mine = mds[whoami][\"auth.meta_load\"]\n"
+  "local theirs = mds[other][\"auth.meta_load\"]\n"
+  "local targets = {}\n"
+  "if mine > theirs then targets[other] = (mine - theirs) / 2 end\n"
+  "return targets\n";
+
+static trace_t parse(const std::string& log)
+{
+  std::istringstream in(log);
+  trace_t trace;
+  load_trace(in, &trace);
+  return trace;
+}
+
+TEST(BalancerReplay, LoadTrace)
+{
+  auto trace = parse(
+    "2024-01-01 mds.0.bal handle_heartbeat unrelated line\n"
+    "2024-01-01 mds.0.bal handle_heartbeat trace epoch 3 mds.0"
+    " auth.meta_load=10 queue_len=2\n"
+    "2024-01-01 mds.0.bal handle_heartbeat trace epoch 3 mds.1"
+    " auth.meta_load=4\n"
+    // the same epoch logged again by another rank is ignored
+    "2024-01-01 mds.1.bal handle_heartbeat trace epoch 3 mds.0"
+    " auth.meta_load=99\n"
+    "2024-01-01 mds.1.bal handle_heartbeat trace epoch 4 mds.1"
+    " auth.meta_load=7\n");
+
+  ASSERT_EQ(2u, trace.size());
+  ASSERT_EQ(2u, trace[3].size());
+  ASSERT_EQ(10, trace[3][0]["auth.meta_load"]);
+  ASSERT_EQ(2, trace[3][0]["queue_len"]);
+  ASSERT_EQ(4, trace[3][1]["auth.meta_load"]);
+  ASSERT_EQ(1u, trace[4].size());
+  ASSERT_EQ(7, trace[4][1]["auth.meta_load"]);
+}
+
+TEST(BalancerReplay, MovesLoad)
+{
+  auto trace = parse(
+    "trace epoch 1 mds.0 auth.meta_load=100\n"
+    "trace epoch 1 mds.1 auth.meta_load=0\n"
+    "trace epoch 2 mds.0 auth.meta_load=100\n"
+    "trace epoch 2 mds.1 auth.meta_load=0\n"
+    // mds.0 is missing, so the epoch is skipped
+    "trace epoch 3 mds.1 auth.meta_load=0\n");
+
+  Config conf;
+  Result res;
+  ASSERT_EQ(0, replay(conf, trace, halve_policy, &res));
+  ASSERT_EQ(2, res.epochs);
+  ASSERT_EQ(1, res.migrations);
+  ASSERT_EQ(50, res.moved);
+  ASSERT_EQ(0, res.pingpongs);
+  // 100/0 before the move, 50/50 after it
+  ASSERT_DOUBLE_EQ(3.0, res.imbalance);
+}
+
+TEST(BalancerReplay, PingPong)
+{
+  // the load follows the subtree back, so the policy chases it
+  auto trace = parse(
+    "trace epoch 1 mds.0 auth.meta_load=100\n"
+    "trace epoch 1 mds.1 auth.meta_load=0\n"
+    "trace epoch 2 mds.0 auth.meta_load=0\n"
+    "trace epoch 2 mds.1 auth.meta_load=100\n");
+
+  Config conf;
+  Result res;
+  ASSERT_EQ(0, replay(conf, trace, halve_policy, &res));
+  ASSERT_EQ(2, res.migrations);
+  ASSERT_EQ(1, res.pingpongs);
+  ASSERT_EQ(0, res.held);
+
+  conf.hold = 3;
+  res = Result();
+  ASSERT_EQ(0, replay(conf, trace, halve_policy, &res));
+  ASSERT_EQ(1, res.migrations);
+  ASSERT_EQ(0, res.pingpongs);
+  ASSERT_EQ(1, res.held);
+}
+
+TEST(BalancerReplay, BadPolicy)
+{
+  auto trace = parse(
+    "trace epoch 1 mds.0 auth.meta_load=100\n");
+
+  Result res;
+  ASSERT_EQ(-EINVAL, replay(Config(), trace, "return 1", &res));
+}
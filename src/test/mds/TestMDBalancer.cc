@@ -0,0 +1,66 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
+// vim: ts=8 sw=2 sts=2 expandtab
+
+#include "mds/MDBalancer.h"
+
+#include "gtest/gtest.h"
+
+using namespace std::chrono_literals;
+
+TEST(ReexportHold, HoldsUntilTrimmed)
+{
+  ReexportHold hold;
+  auto start = ReexportHold::clock::zero();
+  dirfrag_t a(0x1000, frag_t());
+  dirfrag_t b(0x1001, frag_t());
+
+  hold.add(a, start);
+  hold.add(b, start + 5s);
+  ASSERT_TRUE(hold.is_held(a));
+  ASSERT_TRUE(hold.is_held(b));
+  ASSERT_FALSE(hold.is_held(dirfrag_t(0x1002, frag_t())));
+
+  hold.trim(start + 9s, 10s);
+  ASSERT_EQ(2u, hold.size());
+  ASSERT_TRUE(hold.is_held(a));
+
+  hold.trim(start + 10s, 10s);
+  ASSERT_EQ(1u, hold.size());
+  ASSERT_FALSE(hold.is_held(a));
+  ASSERT_TRUE(hold.is_held(b));
+
+  hold.trim(start + 15s, 10s);
+  ASSERT_EQ(0u, hold.size());
+  ASSERT_FALSE(hold.is_held(b));
+}
+
+TEST(ReexportHold, ReimportRestartsHold)
+{
+  ReexportHold hold;
+  auto start = ReexportHold::clock::zero();
+  dirfrag_t a(0x1000, frag_t());
+
+  hold.add(a, start);
+  hold.add(a, start + 8s);
+  hold.trim(start + 12s, 10s);
+  ASSERT_TRUE(hold.is_held(a));
+}
+
+TEST(ReexportHold, HoldsFragmentsOfImport)
+{
+  ReexportHold hold;
+  auto start = ReexportHold::clock::zero();
+  frag_t left = frag_t().make_child(0, 1);
+  frag_t right = frag_t().make_child(1, 1);
+
+  // an import split after it arrived is still held, piece by piece
+  hold.add(dirfrag_t(0x1000, frag_t()), start);
+  ASSERT_TRUE(hold.is_held(dirfrag_t(0x1000, left)));
+  ASSERT_TRUE(hold.is_held(dirfrag_t(0x1000, right.make_child(0, 1))));
+
+  // but importing one fragment does not hold its siblings or its parent
+  hold.add(dirfrag_t(0x2000, left), start);
+  ASSERT_TRUE(hold.is_held(dirfrag_t(0x2000, left)));
+  ASSERT_FALSE(hold.is_held(dirfrag_t(0x2000, right)));
+  ASSERT_FALSE(hold.is_held(dirfrag_t(0x2000, frag_t())));
+}
@@ -0,0 +1,124 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
+// vim: ts=8 sw=2 sts=2 expandtab
+
+/*
+ * Compare Mantle balancer policies against the load trace in an MDS log;
+ * see BalancerReplay.h.
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "common/ceph_argparse.h"
+#include "common/errno.h"
+#include "global/global_init.h"
+#include "BalancerReplay.h"
+
+using namespace balancer_replay;
+
+namespace {
+
+int load_file(const std::string& path, std::string* out)
+{
+  std::ifstream in(path);
+  if (!in) {
+    return -errno;
+  }
+  std::stringstream ss;
+  ss << in.rdbuf();
+  *out = ss.str();
+  return 0;
+}
+
+void usage()
+{
+  Config d;
+  std::cout << "usage: ceph_test_mds_balancer_replay [options] <mds log> <balancer.lua>...\n"
+            << "  --metric <name>  load the policies move between ranks (default "
+            << d.metric << ")\n"
+            << "  --hold <n>       refuse to move load back within n epochs (default "
+            << d.hold << ")\n"
+            << "  --window <n>     count moves back within n epochs as ping-pong (default "
+            << d.window << ")\n";
+}
+
+} // anonymous namespace
+
+int main(int argc, const char** argv)
+{
+  auto args = argv_to_vec(argc, argv);
+  if (args.empty()) {
+    usage();
+    return 1;
+  }
+  auto cct = global_init(nullptr, args, CEPH_ENTITY_TYPE_CLIENT,
+                         CODE_ENVIRONMENT_UTILITY,
+                         CINIT_FLAG_NO_DEFAULT_CONFIG_FILE);
+  common_init_finish(g_ceph_context);
+
+  Config conf;
+  std::vector<std::string> files;
+  for (unsigned i = 0; i < args.size(); ++i) {
+    if (strcmp(args[i], "--help") == 0 || strcmp(args[i], "-h") == 0) {
+      usage();
+      return 0;
+    } else if (strcmp(args[i], "--metric") == 0 && i + 1 < args.size()) {
+      conf.metric = args[++i];
+    } else if (strcmp(args[i], "--hold") == 0 && i + 1 < args.size()) {
+      conf.hold = std::max(0, atoi(args[++i]));
+    } else if (strcmp(args[i], "--window") == 0 && i + 1 < args.size()) {
+      conf.window = std::max(0, atoi(args[++i]));
+    } else {
+      files.push_back(args[i]);
+    }
+  }
+  if (files.size() < 2) {
+    usage();
+    return 1;
+  }
+
+  trace_t trace;
+  std::ifstream log(files[0]);
+  if (!log) {
+    std::cerr << "reading " << files[0] << " failed: " << cpp_strerror(errno)
+              << std::endl;
+    return 1;
+  }
+  load_trace(log, &trace);
+  int r;
+
+  int ret = 0;
+  for (unsigned i = 1; i < files.size(); ++i) {
+    std::string script;
+    r = load_file(files[i], &script);
+    if (r < 0) {
+      std::cerr << "reading " << files[i] << " failed: " << cpp_strerror(r)
+                << std::endl;
+      ret = 1;
+      continue;
+    }
+    Result res;
+    r = replay(conf, trace, script, &res);
+    if (r < 0) {
+      std::cerr << "policy " << files[i] << " failed: " << cpp_strerror(r)
+                << std::endl;
+      ret = 1;
+      continue;
+    }
+    std::cout << "policy " << files[i]
+              << " epochs " << res.epochs
+              << " migrations " << res.migrations
+              << " moved " << res.moved
+              << " ping-pongs " << res.pingpongs
+              << " held " << res.held
+              << " imbalance " << (res.epochs ? res.imbalance / res.epochs : 0)
+              << std::endl;
+  }
+  return ret;
+}
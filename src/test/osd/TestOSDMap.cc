@@ -318,6 +318,33 @@ public:
     job.wait();
     tp.stop();
   }
+  // calc_pg_upmaps internals, for the tests below
+  float calc_deviations(const map<int,set<pg_t>>& pgs_by_osd,
+                        const map<int,float>& osd_weight,
+                        float pgs_per_weight,
+                        map<int,float>& osd_deviation,
+                        multimap<float,int>& deviation_osd,
+                        float& stddev) {
+    return osdmap.calc_deviations(g_ceph_context, pgs_by_osd, osd_weight,
+                                  pgs_per_weight, osd_deviation,
+                                  deviation_osd, stddev);
+  }
+  float update_deviations(const map<int,set<pg_t>>& pgs_by_osd,
+                          const set<int>& changed_osds,
+                          const map<int,float>& osd_weight,
+                          float pgs_per_weight,
+                          const map<int,float>& osd_deviation,
+                          map<int,float>& new_osd_deviation,
+                          float& stddev) {
+    return osdmap.update_deviations(g_ceph_context, pgs_by_osd, changed_osds,
+                                    osd_weight, pgs_per_weight, osd_deviation,
+                                    new_osd_deviation, stddev);
+  }
+  void move_deviation(multimap<float,int>& deviation_osd, int osd,
+                      std::optional<float> old_deviation,
+                      float new_deviation) {
+    osdmap.move_deviation(deviation_osd, osd, old_deviation, new_deviation);
+  }
   void set_primary_affinity_all(float pa) {
     for (uint i = 0 ; i < get_num_osds() ; i++) {
       osdmap.set_primary_affinity(i, int(pa * CEPH_OSD_MAX_PRIMARY_AFFINITY));
@@ -612,6 +639,247 @@ TEST_F(OSDMapTest, PrimaryTempRespected) {
   EXPECT_EQ(acting_primary, acting_osds[1]);
 }
 
+TEST_F(OSDMapTest, IncrementalMayRemap) {
+  set_up_map();
+
+  {
+    // nothing placement related
+    OSDMap::Incremental inc(osdmap.get_epoch() + 1);
+    inc.new_up_thru[0] = osdmap.get_epoch();
+    inc.new_blocklist[entity_addr_t()] = utime_t();
+    EXPECT_FALSE(inc.may_remap_all_pgs());
+    EXPECT_FALSE(inc.may_remap_pool(my_rep_pool));
+    EXPECT_FALSE(inc.may_remap_pool(my_ec_pool));
+  }
+  {
+    // a pg_temp only affects its own pool
+    pg_t pgid = osdmap.raw_pg_to_pg(pg_t(0, my_rep_pool));
+    OSDMap::Incremental inc(osdmap.get_epoch() + 1);
+    inc.new_pg_temp[pgid] = mempool::osdmap::vector<int>({0, 1, 2});
+    EXPECT_FALSE(inc.may_remap_all_pgs());
+    EXPECT_TRUE(inc.may_remap_pool(my_rep_pool));
+    EXPECT_FALSE(inc.may_remap_pool(my_ec_pool));
+  }
+  {
+    // and so does removing an upmap
+    pg_t pgid = osdmap.raw_pg_to_pg(pg_t(0, my_ec_pool));
+    OSDMap::Incremental inc(osdmap.get_epoch() + 1);
+    inc.old_pg_upmap_items.insert(pgid);
+    EXPECT_FALSE(inc.may_remap_all_pgs());
+    EXPECT_FALSE(inc.may_remap_pool(my_rep_pool));
+    EXPECT_TRUE(inc.may_remap_pool(my_ec_pool));
+  }
+  {
+    // osd state changes affect everybody
+    OSDMap::Incremental inc(osdmap.get_epoch() + 1);
+    inc.new_weight[0] = CEPH_OSD_OUT;
+    EXPECT_TRUE(inc.may_remap_all_pgs());
+  }
+}
+
+TEST_F(OSDMapTest, IncrementalMapping) {
+  set_up_map(12);
+  ThreadPool tp(g_ceph_context, "IncrementalMapping::tp", "mapping_tp", 4);
+  ParallelPGMapper mapper(g_ceph_context, &tp);
+  tp.start();
+
+  auto apply = [this](OSDMap::Incremental& inc) {
+    mapping.note_incremental(osdmap, inc);
+    osdmap.apply_incremental(inc);
+  };
+  // whatever got remapped, the result must match a full calculation
+  auto update_and_check = [&](bool partial) {
+    auto job = mapping.start_update(osdmap, mapper, 16);
+    job->wait();
+    ASSERT_EQ(osdmap.get_epoch(), mapping.get_epoch());
+    uint64_t total = 0;
+    for (auto& [poolid, pool] : osdmap.get_pools()) {
+      total += pool.get_pg_num();
+    }
+    if (partial) {
+      ASSERT_LT(mapping.get_num_remapped(), total);
+    } else {
+      ASSERT_EQ(total, mapping.get_num_remapped());
+    }
+    for (auto& [poolid, pool] : osdmap.get_pools()) {
+      for (unsigned ps = 0; ps < pool.get_pg_num(); ++ps) {
+	pg_t pgid(ps, poolid);
+	vector<int> up, acting, up2, acting2;
+	int up_primary, acting_primary, up_primary2, acting_primary2;
+	osdmap.pg_to_up_acting_osds(pgid, &up, &up_primary,
+				    &acting, &acting_primary);
+	mapping.get(pgid, &up2, &up_primary2, &acting2, &acting_primary2);
+	ASSERT_EQ(up, up2) << pgid;
+	ASSERT_EQ(up_primary, up_primary2) << pgid;
+	ASSERT_EQ(acting, acting2) << pgid;
+	ASSERT_EQ(acting_primary, acting_primary2) << pgid;
+      }
+    }
+  };
+  update_and_check(false);
+
+  {
+    // osd down
+    OSDMap::Incremental inc(osdmap.get_epoch() + 1);
+    inc.new_state[0] = CEPH_OSD_UP;
+    apply(inc);
+    update_and_check(true);
+  }
+  {
+    // osd out
+    OSDMap::Incremental inc(osdmap.get_epoch() + 1);
+    inc.new_weight[1] = CEPH_OSD_OUT;
+    apply(inc);
+    update_and_check(true);
+  }
+  {
+    // several epochs at once: a pg_temp, an upmap, and osd.0 back up
+    pg_t pgid(0, my_rep_pool);
+    vector<int> up;
+    osdmap.pg_to_up_osds(pgid, &up, nullptr);
+    OSDMap::Incremental inc(osdmap.get_epoch() + 1);
+    inc.new_pg_temp[pgid] = mempool::osdmap::vector<int>(up.rbegin(),
+							 up.rend());
+    apply(inc);
+
+    pgid = pg_t(1, my_rep_pool);
+    osdmap.pg_to_up_osds(pgid, &up, nullptr);
+    int to = 2;
+    while (std::find(up.begin(), up.end(), to) != up.end()) {
+      ++to;
+    }
+    OSDMap::Incremental inc2(osdmap.get_epoch() + 1);
+    inc2.new_pg_upmap_items[pgid] =
+      mempool::osdmap::vector<pair<int32_t,int32_t>>({{up[0], to}});
+    apply(inc2);
+
+    OSDMap::Incremental inc3(osdmap.get_epoch() + 1);
+    entity_addrvec_t addrs;
+    addrs.v.push_back(entity_addr_t());
+    inc3.new_up_client[0] = addrs;
+    apply(inc3);
+    update_and_check(true);
+  }
+  {
+    // pg_num change
+    OSDMap::Incremental inc(osdmap.get_epoch() + 1);
+    pg_pool_t pool = *osdmap.get_pg_pool(my_rep_pool);
+    pool.set_pg_num(pool.get_pg_num() * 2);
+    pool.set_pgp_num(pool.get_pgp_num() * 2);
+    inc.new_pools[my_rep_pool] = pool;
+    apply(inc);
+    update_and_check(true);
+    // just that pool
+    ASSERT_EQ(pool.get_pg_num(), mapping.get_num_remapped());
+  }
+  {
+    // an incremental we did not see forces a full rebuild
+    OSDMap::Incremental inc(osdmap.get_epoch() + 1);
+    inc.new_weight[3] = CEPH_OSD_OUT;
+    osdmap.apply_incremental(inc);
+    OSDMap::Incremental inc2(osdmap.get_epoch() + 1);
+    inc2.new_state[4] = CEPH_OSD_UP;
+    apply(inc2);
+    update_and_check(false);
+  }
+  {
+    // so does a reweight
+    OSDMap::Incremental inc(osdmap.get_epoch() + 1);
+    inc.new_weight[1] = CEPH_OSD_IN;
+    apply(inc);
+    update_and_check(false);
+  }
+  tp.stop();
+}
+
+TEST_F(OSDMapTest, IncrementalDeviations) {
+  // calc_pg_upmaps only recounts the osds a candidate change touches; that
+  // has to give exactly what recounting every osd gives
+  std::mt19937 rng(42);
+  const int num_osds = 24;
+  map<int,float> osd_weight;
+  float total_weight = 0;
+  for (int osd = 0; osd < num_osds; ++osd) {
+    osd_weight[osd] = std::uniform_int_distribution<int>(1, 4)(rng) * 0.5;
+    total_weight += osd_weight[osd];
+  }
+  // leave a few osds without pgs, so that changes add them
+  map<int,set<pg_t>> pgs_by_osd;
+  const unsigned num_pgs = 1024;
+  std::uniform_int_distribution<int> pick_osd(0, num_osds - 1);
+  for (unsigned ps = 0; ps < num_pgs; ++ps) {
+    int osd;
+    do {
+      osd = pick_osd(rng);
+    } while (osd < 3);
+    pgs_by_osd[osd].insert(pg_t(ps, my_rep_pool));
+  }
+  float pgs_per_weight = num_pgs / total_weight;
+
+  map<int,float> osd_deviation;
+  multimap<float,int> deviation_osd;
+  float stddev;
+  calc_deviations(pgs_by_osd, osd_weight, pgs_per_weight,
+                  osd_deviation, deviation_osd, stddev);
+
+  for (int i = 0; i < 1000; ++i) {
+    auto temp_pgs_by_osd = pgs_by_osd;
+    set<int> changed_osds;
+    int moves = std::uniform_int_distribution<int>(1, 4)(rng);
+    for (int m = 0; m < moves; ++m) {
+      int from = pick_osd(rng);
+      int to = pick_osd(rng);
+      auto p = temp_pgs_by_osd.find(from);
+      if (p == temp_pgs_by_osd.end() || p->second.empty()) {
+        continue;
+      }
+      auto pg = *p->second.begin();
+      p->second.erase(p->second.begin());
+      temp_pgs_by_osd[to].insert(pg);
+      changed_osds.insert(from);
+      changed_osds.insert(to);
+    }
+    // an osd whose count does not actually change
+    changed_osds.insert(pick_osd(rng));
+
+    map<int,float> new_osd_deviation;
+    float new_stddev;
+    float max_deviation = update_deviations(
+      temp_pgs_by_osd, changed_osds, osd_weight, pgs_per_weight,
+      osd_deviation, new_osd_deviation, new_stddev);
+    auto new_deviation_osd = deviation_osd;
+    for (auto osd : changed_osds) {
+      auto t = temp_pgs_by_osd.find(osd);
+      if (t == temp_pgs_by_osd.end()) {
+        continue;
+      }
+      auto d = osd_deviation.find(osd);
+      move_deviation(new_deviation_osd, osd,
+                     d != osd_deviation.end() ?
+                       std::optional<float>(d->second) : std::nullopt,
+                     new_osd_deviation.at(osd));
+    }
+
+    map<int,float> full_osd_deviation;
+    multimap<float,int> full_deviation_osd;
+    float full_stddev;
+    float full_max_deviation = calc_deviations(
+      temp_pgs_by_osd, osd_weight, pgs_per_weight,
+      full_osd_deviation, full_deviation_osd, full_stddev);
+    ASSERT_EQ(full_osd_deviation, new_osd_deviation) << "iteration " << i;
+    ASSERT_EQ(full_deviation_osd, new_deviation_osd) << "iteration " << i;
+    ASSERT_EQ(full_max_deviation, max_deviation) << "iteration " << i;
+    ASSERT_EQ(full_stddev, new_stddev) << "iteration " << i;
+
+    // like the optimizer, keep some changes and drop the others
+    if (rng() % 2) {
+      pgs_by_osd.swap(temp_pgs_by_osd);
+      osd_deviation.swap(new_osd_deviation);
+      deviation_osd.swap(new_deviation_osd);
+    }
+  }
+}
+
 TEST_F(OSDMapTest, CleanTemps) {
   set_up_map();
 
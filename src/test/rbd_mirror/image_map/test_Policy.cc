@@ -4,6 +4,7 @@
 #include "include/Context.h"
 #include "test/rbd_mirror/test_fixture.h"
 #include "tools/rbd_mirror/image_map/Types.h"
+#include "tools/rbd_mirror/image_map/LoadPolicy.h"
 #include "tools/rbd_mirror/image_map/SimplePolicy.h"
 #include "include/stringify.h"
 #include "common/Thread.h"
@@ -28,6 +29,8 @@ public:
 
     if (policy_type == "none" || policy_type == "simple") {
       m_policy = image_map::SimplePolicy::create(m_local_io_ctx);
+    } else if (policy_type == "load") {
+      m_policy = image_map::LoadPolicy::create(m_local_io_ctx);
     } else {
       ceph_abort();
     }
@@ -372,6 +375,54 @@ TEST_F(TestImageMapPolicy, InitialInstanceUpdate) {
   ASSERT_FALSE(m_policy->finish_action(global_image_id, 0));
 }
 
+TEST_F(TestImageMapPolicy, ShuffleImageByLoad) {
+  delete m_policy;
+  m_policy = image_map::LoadPolicy::create(m_local_io_ctx);
+  m_policy->init({});
+
+  auto instance_id = stringify(m_local_io_ctx.get_instance_id());
+  std::set<std::string> shuffle_global_image_ids;
+  m_policy->add_instances({instance_id}, &shuffle_global_image_ids);
+  ASSERT_TRUE(shuffle_global_image_ids.empty());
+
+  std::set<std::string> global_image_ids {
+    "global id 1", "global id 2", "global id 3", "global id 4"
+  };
+  for (auto const &global_image_id : global_image_ids) {
+    map_image(global_image_id);
+  }
+
+  // without reported loads images are spread evenly
+  m_policy->add_instances({"9876"}, &shuffle_global_image_ids);
+  ASSERT_EQ(std::set<std::string>({"global id 3", "global id 4"}),
+            shuffle_global_image_ids);
+  for (auto const &global_image_id : shuffle_global_image_ids) {
+    shuffle_image(global_image_id);
+
+    LookupInfo info = m_policy->lookup(global_image_id);
+    ASSERT_EQ("9876", info.instance_id);
+  }
+
+  // the busy local instance gives up one of its images
+  m_policy->update_image_loads(instance_id, {{"global id 1", 1000},
+                                             {"global id 2", 1000}});
+  m_policy->update_image_loads("9876", {{"global id 3", 10},
+                                        {"global id 4", 10}});
+
+  shuffle_global_image_ids.clear();
+  m_policy->add_instances({}, &shuffle_global_image_ids);
+  ASSERT_EQ(std::set<std::string>({"global id 2"}), shuffle_global_image_ids);
+  shuffle_image("global id 2");
+
+  LookupInfo info = m_policy->lookup("global id 2");
+  ASSERT_EQ("9876", info.instance_id);
+
+  // balanced within the allowed imbalance
+  shuffle_global_image_ids.clear();
+  m_policy->add_instances({}, &shuffle_global_image_ids);
+  ASSERT_TRUE(shuffle_global_image_ids.empty());
+}
+
 } // namespace image_map
 } // namespace mirror
 } // namespace rbd
@@ -211,6 +211,7 @@ struct ReplayStatusFormatter<librbd::MockTestImageCtx> {
 
   MOCK_METHOD1(handle_entry_processed, void(uint64_t));
   MOCK_METHOD2(get_or_send_update, bool(std::string *description, Context *on_finish));
+  MOCK_METHOD2(get_load, void(uint64_t*, uint64_t*));
 };
 
 template<>
@@ -104,6 +104,7 @@ struct ImageReplayer<librbd::MockTestImageCtx> {
   MOCK_METHOD1(set_finished, void(bool));
 
   MOCK_CONST_METHOD0(get_health_state, image_replayer::HealthState());
+  MOCK_METHOD2(get_load, bool(uint64_t*, uint64_t*));
 };
 
 ImageReplayer<librbd::MockTestImageCtx>* ImageReplayer<librbd::MockTestImageCtx>::s_instance = nullptr;
@@ -299,12 +300,13 @@ TEST_F(TestMockInstanceReplayer, RemoveFinishedImage) {
   // remove finished image replayer
   EXPECT_CALL(mock_image_replayer, get_health_state()).WillOnce(
     Return(image_replayer::HEALTH_STATE_OK));
+  EXPECT_CALL(mock_image_replayer, get_load(_, _)).WillOnce(Return(false));
   EXPECT_CALL(mock_image_replayer, is_stopped()).WillOnce(Return(true));
   EXPECT_CALL(mock_image_replayer, is_blocklisted()).WillOnce(Return(false));
   EXPECT_CALL(mock_image_replayer, is_finished()).WillOnce(Return(true));
   EXPECT_CALL(mock_image_replayer, destroy());
   EXPECT_CALL(mock_service_daemon,
-              add_or_update_namespace_attribute(_, _, _, _)).Times(3);
+              add_or_update_namespace_attribute(_, _, _, _)).Times(5);
 
   ASSERT_TRUE(start_image_replayers_ctx != nullptr);
   start_image_replayers_ctx->complete(0);
@@ -73,6 +73,8 @@ struct ImageMap<librbd::MockTestImageCtx> {
 
   MOCK_METHOD1(update_instances_added, void(const std::vector<std::string>&));
   MOCK_METHOD1(update_instances_removed, void(const std::vector<std::string>&));
+  MOCK_METHOD2(update_image_loads, void(const std::string&,
+                                        const leader_watcher::ImageLoads&));
 
   MOCK_METHOD3(update_images_mock, void(const std::string&,
                                         const std::set<std::string>&,
@@ -113,6 +115,7 @@ struct InstanceReplayer<librbd::MockTestImageCtx> {
   MOCK_METHOD1(stop, void(Context *));
 
   MOCK_METHOD2(print_status, void(Formatter*, std::stringstream*));
+  MOCK_METHOD1(get_image_loads, void(leader_watcher::ImageLoads*));
 
   MOCK_METHOD1(add_peer, void(const Peer<librbd::MockTestImageCtx>&));
 
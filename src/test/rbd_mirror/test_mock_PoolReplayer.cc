@@ -168,6 +168,10 @@ struct NamespaceReplayer<librbd::MockTestImageCtx> {
   MOCK_METHOD1(handle_update_leader, void(const std::string &));
   MOCK_METHOD1(handle_instances_added, void(const std::vector<std::string> &));
   MOCK_METHOD1(handle_instances_removed, void(const std::vector<std::string> &));
+  MOCK_METHOD2(handle_image_loads, void(const std::string &,
+                                        const leader_watcher::ImageLoads &));
+
+  MOCK_METHOD1(get_image_loads, void(leader_watcher::ImageLoads*));
 
   MOCK_METHOD1(print_status, void(Formatter*));
   MOCK_METHOD0(start, void());
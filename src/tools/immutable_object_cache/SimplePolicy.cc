@@ -4,8 +4,6 @@
 #include "common/debug.h"
 #include "SimplePolicy.h"
 
-#include <shared_mutex> // for std::shared_lock
-
 #define dout_context g_ceph_context
 #define dout_subsys ceph_subsys_immutable_obj_cache
 #undef dout_prefix
@@ -31,19 +29,22 @@ SimplePolicy::SimplePolicy(CephContext *cct, uint64_t cache_size,
 SimplePolicy::~SimplePolicy() {
   ldout(cct, 20) << dendl;
 
-  for (auto it : m_cache_map) {
-    Entry* entry = (it.second);
-    delete entry;
+  for (auto& shard : m_shards) {
+    for (auto it : shard.cache_map) {
+      Entry* entry = (it.second);
+      delete entry;
+    }
   }
 }
 
 cache_status_t SimplePolicy::alloc_entry(std::string file_name) {
   ldout(cct, 20) << "alloc entry for: " << file_name << dendl;
 
-  std::unique_lock wlocker{m_cache_map_lock};
+  auto& shard = get_shard(file_name);
+  std::unique_lock locker{shard.lock};
 
   // cache hit when promoting
-  if (m_cache_map.find(file_name) != m_cache_map.end()) {
+  if (shard.cache_map.find(file_name) != shard.cache_map.end()) {
     ldout(cct, 20) << "object is under promoting: " << file_name << dendl;
     return OBJ_CACHE_SKIP;
   }
@@ -52,8 +53,9 @@ cache_status_t SimplePolicy::alloc_entry(std::string file_name) {
       (inflight_ops < m_max_inflight_ops)) {
     Entry* entry = new Entry();
     ceph_assert(entry != nullptr);
-    m_cache_map[file_name] = entry;
-    wlocker.unlock();
+    shard.cache_map[file_name] = entry;
+    ++m_entry_count;
+    locker.unlock();
     update_status(file_name, OBJ_CACHE_SKIP);
     return OBJ_CACHE_NONE;  // start promotion request
   }
@@ -65,12 +67,13 @@ cache_status_t SimplePolicy::alloc_entry(std::string file_name) {
 cache_status_t SimplePolicy::lookup_object(std::string file_name) {
   ldout(cct, 20) << "lookup: " << file_name << dendl;
 
-  std::shared_lock rlocker{m_cache_map_lock};
+  auto& shard = get_shard(file_name);
+  std::unique_lock locker{shard.lock};
 
-  auto entry_it = m_cache_map.find(file_name);
+  auto entry_it = shard.cache_map.find(file_name);
   // simply promote on first lookup
-  if (entry_it == m_cache_map.end()) {
-      rlocker.unlock();
+  if (entry_it == shard.cache_map.end()) {
+      locker.unlock();
       return alloc_entry(file_name);
   }
 
@@ -78,7 +81,7 @@ cache_status_t SimplePolicy::lookup_object(std::string file_name) {
 
   if (entry->status == OBJ_CACHE_PROMOTED || entry->status == OBJ_CACHE_DNE) {
     // bump pos in lru on hit
-    m_promoted_lru.lru_touch(entry);
+    entry->referenced = true;
   }
 
   return entry->status;
@@ -89,14 +92,15 @@ void SimplePolicy::update_status(std::string file_name,
   ldout(cct, 20) << "update status for: " << file_name
                  << " new status = " << new_status << dendl;
 
-  std::unique_lock locker{m_cache_map_lock};
+  auto& shard = get_shard(file_name);
+  std::unique_lock locker{shard.lock};
 
-  auto entry_it = m_cache_map.find(file_name);
-  if (entry_it == m_cache_map.end()) {
+  auto entry_it = shard.cache_map.find(file_name);
+  if (entry_it == shard.cache_map.end()) {
     return;
   }
 
-  ceph_assert(entry_it != m_cache_map.end());
+  ceph_assert(entry_it != shard.cache_map.end());
   Entry* entry = entry_it->second;
 
   // to promote
@@ -110,7 +114,10 @@ void SimplePolicy::update_status(std::string file_name,
   // promoting done
   if (entry->status == OBJ_CACHE_SKIP && (new_status== OBJ_CACHE_PROMOTED ||
                                           new_status== OBJ_CACHE_DNE)) {
-    m_promoted_lru.lru_insert_top(entry);
+    {
+      std::lock_guard lru_locker{m_lru_lock};
+      m_promoted_lru.lru_insert_top(entry);
+    }
     entry->status = new_status;
     entry->size = size;
     m_cache_size += entry->size;
@@ -124,7 +131,8 @@ void SimplePolicy::update_status(std::string file_name,
     entry->file_name = "";
     entry->status = new_status;
 
-    m_cache_map.erase(entry_it);
+    shard.cache_map.erase(entry_it);
+    --m_entry_count;
     inflight_ops--;
     delete entry;
     return;
@@ -135,12 +143,16 @@ void SimplePolicy::update_status(std::string file_name,
       new_status== OBJ_CACHE_NONE) {
     // mark this entry as free
     uint64_t size = entry->size;
+    {
+      std::lock_guard lru_locker{m_lru_lock};
+      m_promoted_lru.lru_remove(entry);
+    }
     entry->file_name = "";
     entry->size = 0;
     entry->status = new_status;
 
-    m_promoted_lru.lru_remove(entry);
-    m_cache_map.erase(entry_it);
+    shard.cache_map.erase(entry_it);
+    --m_entry_count;
     m_cache_size -= size;
     delete entry;
     return;
@@ -158,9 +170,10 @@ int SimplePolicy::evict_entry(std::string file_name) {
 cache_status_t SimplePolicy::get_status(std::string file_name) {
   ldout(cct, 20) << file_name << dendl;
 
-  std::shared_lock locker{m_cache_map_lock};
-  auto entry_it = m_cache_map.find(file_name);
-  if (entry_it == m_cache_map.end()) {
+  auto& shard = get_shard(file_name);
+  std::lock_guard locker{shard.lock};
+  auto entry_it = shard.cache_map.find(file_name);
+  if (entry_it == shard.cache_map.end()) {
     return OBJ_CACHE_NONE;
   }
 
@@ -170,18 +183,26 @@ cache_status_t SimplePolicy::get_status(std::string file_name) {
 void SimplePolicy::get_evict_list(std::list<std::string>* obj_list) {
   ldout(cct, 20) << dendl;
 
-  std::unique_lock locker{m_cache_map_lock};
+  std::lock_guard locker{m_lru_lock};
   // check free ratio, pop entries from LRU
   if ((double)m_cache_size > m_max_cache_size * m_watermark) {
     // TODO(dehao): make this configurable
-    int evict_num = m_cache_map.size() * 0.1;
-    for (int i = 0; i < evict_num; i++) {
+    int evict_num = m_entry_count * 0.1;
+    // entries hit since they were last considered are moved back to the
+    // top once, so this is bounded by the LRU size plus evict_num
+    uint64_t max_scan = m_promoted_lru.lru_get_size() + evict_num;
+    for (int i = 0; i < evict_num && max_scan > 0; max_scan--) {
       Entry* entry = reinterpret_cast<Entry*>(m_promoted_lru.lru_expire());
       if (entry == nullptr) {
+        break;
+      }
+      if (entry->referenced.exchange(false)) {
+        m_promoted_lru.lru_insert_top(entry);
         continue;
       }
       std::string file_name = entry->file_name;
       obj_list->push_back(file_name);
+      i++;
     }
   }
 }
@@ -193,20 +214,24 @@ uint64_t SimplePolicy::get_free_size() {
 
 uint64_t SimplePolicy::get_promoting_entry_num() {
   uint64_t index = 0;
-  std::shared_lock rlocker{m_cache_map_lock};
-  for (auto it : m_cache_map) {
-    if (it.second->status == OBJ_CACHE_SKIP) {
-      index++;
+  for (auto& shard : m_shards) {
+    std::lock_guard locker{shard.lock};
+    for (auto it : shard.cache_map) {
+      if (it.second->status == OBJ_CACHE_SKIP) {
+        index++;
+      }
     }
   }
   return index;
 }
 
 uint64_t SimplePolicy::get_promoted_entry_num() {
+  std::lock_guard locker{m_lru_lock};
   return m_promoted_lru.lru_get_size();
 }
 
 std::string SimplePolicy::get_evict_entry() {
+  std::lock_guard locker{m_lru_lock};
   Entry* entry = reinterpret_cast<Entry*>(m_promoted_lru.lru_get_next_expire());
   if (entry == nullptr) {
     return "";
@@ -9,6 +9,8 @@
 #include "include/lru.h"
 #include "Policy.h"
 
+#include <array>
+#include <atomic>
 #include <unordered_map>
 #include <string>
 
@@ -46,6 +48,20 @@ class SimplePolicy : public Policy {
     Entry() : status(OBJ_CACHE_NONE) {}
     std::string file_name;
     uint64_t size;
+
+    // set on cache hits instead of moving the entry in the LRU, the
+    // entry is given a second chance when it reaches the LRU tail
+    std::atomic<bool> referenced = false;
+  };
+
+  // lookups only lock the shard holding the object, the LRU lock is
+  // only taken when entries are promoted or evicted
+  static constexpr size_t SHARD_COUNT = 32;
+
+  struct Shard {
+    ceph::mutex lock = ceph::make_mutex(
+      "rbd::cache::SimplePolicy::Shard::lock");
+    std::unordered_map<std::string, Entry*> cache_map;
   };
 
   CephContext* cct;
@@ -54,13 +70,18 @@ class SimplePolicy : public Policy {
   uint64_t m_max_cache_size;
   std::atomic<uint64_t> inflight_ops = 0;
 
-  std::unordered_map<std::string, Entry*> m_cache_map;
-  ceph::shared_mutex m_cache_map_lock =
-    ceph::make_shared_mutex("rbd::cache::SimplePolicy::m_cache_map_lock");
+  std::array<Shard, SHARD_COUNT> m_shards;
+  std::atomic<uint64_t> m_entry_count = 0;
 
   std::atomic<uint64_t> m_cache_size;
 
+  ceph::mutex m_lru_lock =
+    ceph::make_mutex("rbd::cache::SimplePolicy::m_lru_lock");
   LRU m_promoted_lru;
+
+  Shard& get_shard(const std::string& file_name) {
+    return m_shards[std::hash<std::string>{}(file_name) % SHARD_COUNT];
+  }
 };
 
 }  // namespace immutable_obj_cache
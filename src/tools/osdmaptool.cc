@@ -26,6 +26,8 @@
 #include "mon/health_check.h"
 #include <time.h>
 #include <algorithm>
+#include <atomic>
+#include <thread>
 #include <unordered_map>
 
 #include "global/global_init.h"
@@ -67,6 +69,9 @@ void usage()
   cout << "                           max deviation from target [default: 5]" << std::endl;
   cout << "   --upmap-pool <poolname> restrict upmap balancing to 1 or more pools" << std::endl;
   cout << "   --upmap-active          Act like an active balancer, keep applying changes until balanced" << std::endl;
+  cout << "   --upmap-threads <num>   balance up to <num> pools at once; --upmap-max then" << std::endl;
+  cout << "                           limits the changes per pool [default: 1]" << std::endl;
+  cout << "   --upmap-bench           report the time and iterations spent on each pool" << std::endl;
   cout << "   --dump <format>         displays the map in plain text when <format> is 'plain', 'json' if specified format is not supported" << std::endl;
   cout << "   --tree                  displays a tree of the map" << std::endl;
   cout << "   --test-crush [--range-first <first> --range-last <last>] map pgs to acting osds" << std::endl;
@@ -182,6 +187,8 @@ int main(int argc, const char **argv)
   int upmap_max = 10;
   int upmap_deviation = 5;
   bool upmap_active = false;
+  int upmap_threads = 1;
+  bool upmap_bench = false;
   std::set<std::string> upmap_pools;
   std::random_device::result_type upmap_seed;
   std::random_device::result_type *upmap_p_seed = nullptr;
@@ -222,6 +229,7 @@ int main(int argc, const char **argv)
 	read = true;
     } else if (ceph_argparse_witharg(args, i, &upmap_max, err, "--upmap-max", (char*)NULL)) {
     } else if (ceph_argparse_witharg(args, i, &upmap_deviation, err, "--upmap-deviation", (char*)NULL)) {
+    } else if (ceph_argparse_witharg(args, i, &upmap_threads, err, "--upmap-threads", (char*)NULL)) {
     } else if (ceph_argparse_witharg(args, i, (int *)&upmap_seed, err, "--upmap-seed", (char*)NULL)) {
       upmap_p_seed = &upmap_seed;
     } else if (ceph_argparse_witharg(args, i, &val, "--upmap-pool", (char*)NULL)) {
@@ -236,6 +244,8 @@ int main(int argc, const char **argv)
       createsimple = true;
     } else if (ceph_argparse_flag(args, i, "--upmap-active", (char*)NULL)) {
       upmap_active = true;
+    } else if (ceph_argparse_flag(args, i, "--upmap-bench", (char*)NULL)) {
+      upmap_bench = true;
     } else if (ceph_argparse_flag(args, i, "--health", (char*)NULL)) {
       health = true;
     } else if (ceph_argparse_flag(args, i, "--with-default-pool", (char*)NULL)) {
@@ -318,6 +328,10 @@ int main(int argc, const char **argv)
     cerr << me << ": too many arguments" << std::endl;
     usage();
   }
+  if (upmap_threads < 1) {
+    cerr << me << ": upmap-threads must be >= 1" << std::endl;
+    exit(1);
+  }
   if (upmap_deviation < 1) {
     cerr << me << ": upmap-deviation must be >= 1" << std::endl;
     usage();
@@ -619,25 +633,90 @@ int main(int argc, const char **argv)
       struct timespec begin, end;
       r = clock_gettime(CLOCK_MONOTONIC, &begin);
       assert(r == 0);
-      for (auto& i: pools) {
-        set<int64_t> one_pool;
-        one_pool.insert(i);
-        //TODO: Josh: Add a function on the seed for multiple iterations. 
-        int did = osdmap.calc_pg_upmaps(
+      struct pool_result_t {
+        int did = 0;
+        int iterations = 0;
+        float elapsed_time = 0;
+      };
+      vector<pool_result_t> results(pools.size());
+      auto calc_pool = [&](size_t n, int max,
+                           OSDMap::Incremental *inc,
+                           std::random_device::result_type *p_seed) {
+        struct timespec pool_begin, pool_end;
+        clock_gettime(CLOCK_MONOTONIC, &pool_begin);
+        auto& result = results[n];
+        result.did = osdmap.calc_pg_upmaps(
           g_ceph_context, upmap_deviation,
-          left, one_pool,
-          &pending_inc, upmap_p_seed);
-        total_did += did;
-        left -= did;
-        if (left <= 0)
-          break;
-        if (upmap_p_seed != nullptr) {
-          *upmap_p_seed += 13;
+          max, {pools[n]},
+          inc, p_seed, &result.iterations);
+        clock_gettime(CLOCK_MONOTONIC, &pool_end);
+        result.elapsed_time = (pool_end.tv_sec - pool_begin.tv_sec) +
+          1.0e-9*(pool_end.tv_nsec - pool_begin.tv_nsec);
+        return result.did;
+      };
+      if (upmap_threads > 1) {
+        // pools are balanced independently of each other, so each worker
+        // takes the next pool and collects its changes in its own
+        // incremental
+        vector<OSDMap::Incremental> pool_incs;
+        vector<std::random_device::result_type> pool_seeds;
+        for (size_t n = 0; n < pools.size(); ++n) {
+          pool_incs.emplace_back(osdmap.get_epoch()+1);
+          pool_seeds.push_back(upmap_p_seed ? *upmap_p_seed + 13 * n : 0);
+        }
+        std::atomic<size_t> next_pool = 0;
+        vector<std::thread> workers;
+        for (int t = 0; t < std::min<int>(upmap_threads, pools.size()); ++t) {
+          workers.emplace_back([&] {
+            for (size_t n = next_pool++; n < pools.size(); n = next_pool++) {
+              calc_pool(n, upmap_max, &pool_incs[n],
+                        upmap_p_seed ? &pool_seeds[n] : nullptr);
+            }
+          });
+        }
+        for (auto& w : workers) {
+          w.join();
+        }
+        for (size_t n = 0; n < pools.size(); ++n) {
+          auto& inc = pool_incs[n];
+          pending_inc.old_pg_upmap_items.insert(
+            inc.old_pg_upmap_items.begin(), inc.old_pg_upmap_items.end());
+          pending_inc.new_pg_upmap_items.insert(
+            inc.new_pg_upmap_items.begin(), inc.new_pg_upmap_items.end());
+          total_did += results[n].did;
+        }
+      } else {
+        for (size_t n = 0; n < pools.size(); ++n) {
+          //TODO: Josh: Add a function on the seed for multiple iterations. 
+          int did = calc_pool(n, left, &pending_inc, upmap_p_seed);
+          total_did += did;
+          left -= did;
+          if (left <= 0)
+            break;
+          if (upmap_p_seed != nullptr) {
+            *upmap_p_seed += 13;
+          }
         }
       }
       r = clock_gettime(CLOCK_MONOTONIC, &end);
       assert(r == 0);
-      cout << "prepared " << total_did << "/" << upmap_max  << " changes" << std::endl;
+      if (upmap_bench) {
+        for (size_t n = 0; n < pools.size(); ++n) {
+          auto& result = results[n];
+          if (result.iterations == 0)
+            continue;
+          cout << "pool " << osdmap.get_pool_name(pools[n])
+               << " changes " << result.did
+               << " iterations " << result.iterations
+               << " in " << result.elapsed_time << " secs ("
+               << result.iterations / std::max(result.elapsed_time, 1.0e-9f)
+               << " iterations/sec)" << std::endl;
+        }
+      }
+      if (upmap_threads > 1)
+        cout << "prepared " << total_did << "/" << upmap_max << " changes per pool" << std::endl;
+      else
+        cout << "prepared " << total_did << "/" << upmap_max  << " changes" << std::endl;
       float elapsed_time = (end.tv_sec - begin.tv_sec) + 1.0e-9*(end.tv_nsec - begin.tv_nsec);
       if (upmap_active)
         cout << "Time elapsed " << elapsed_time << " secs" << std::endl;
@@ -13,6 +13,7 @@
 #include <atomic>
 #include <chrono>
 #include <iostream>
+#include <sys/resource.h>
 #include <boost/accumulators/accumulators.hpp>
 #include <boost/accumulators/statistics/stats.hpp>
 #include <boost/accumulators/statistics/rolling_sum.hpp>
@@ -21,6 +22,17 @@
 using namespace std::chrono;
 
 static std::atomic<bool> terminating;
+
+static double get_process_cpu_time()
+{
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) < 0) {
+    return 0;
+  }
+  return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+    (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000000.0;
+}
+
 static void handle_signal(int signum)
 {
   ceph_assert(signum == SIGINT || signum == SIGTERM);
@@ -301,6 +313,7 @@ int do_bench(librbd::Image& image, io_type_t io_type,
   std::cout << std::endl;
 
   coarse_mono_time start = coarse_mono_clock::now();
+  double start_cpu = get_process_cpu_time();
   std::chrono::duration<double> last = std::chrono::duration<double>::zero();
   uint64_t ios = 0;
 
@@ -447,6 +460,9 @@ int do_bench(librbd::Image& image, io_type_t io_type,
 
   coarse_mono_time now = coarse_mono_clock::now();
   std::chrono::duration<double> elapsed = now - start;
+  // all librbd and librados threads live in this process, so this is the
+  // client side cost of the IO
+  double cpu = get_process_cpu_time() - start_cpu;
 
   std::cout << "elapsed: " << (int)elapsed.count() << "   "
             << "ops: " << ios << "   "
@@ -454,6 +470,10 @@ int do_bench(librbd::Image& image, io_type_t io_type,
             << "bytes/sec: " << byte_u_t((double)off / elapsed.count()) << "/s"
             << std::endl;
 
+  std::cout << "client cpu: " << cpu << "s   "
+            << "cpu/op: " << (ios ? cpu * 1000000 / ios : 0) << "us"
+            << std::endl;
+
   if (io_type == IO_TYPE_RW) {
   std::cout << "read_ops: " << read_ops << "   "
             << "read_ops/sec: " << (double)read_ops / elapsed.count() << "   "
@@ -10,6 +10,7 @@
 #include "tools/rbd_mirror/Threads.h"
 
 #include "ImageMap.h"
+#include "image_map/LoadPolicy.h"
 #include "image_map/LoadRequest.h"
 #include "image_map/SimplePolicy.h"
 #include "image_map/UpdateRequest.h"
@@ -489,6 +490,29 @@ void ImageMap<I>::update_instances_removed(
   schedule_update_task();
 }
 
+template <typename I>
+void ImageMap<I>::update_image_loads(
+    const std::string &instance_id,
+    const leader_watcher::ImageLoads &image_loads) {
+  std::lock_guard locker{m_lock};
+  if (m_shutting_down) {
+    return;
+  }
+
+  dout(20) << "instance_id=" << instance_id << ", "
+           << "images=" << image_loads.size() << dendl;
+
+  // the backlog is weighed as if it is to be drained within a minute
+  std::map<std::string, uint64_t> loads;
+  for (auto& [global_image_id, image_load] : image_loads) {
+    loads[global_image_id] = image_load.bytes_per_second +
+                             image_load.backlog_bytes / 60;
+  }
+
+  // applied by the next (idle) rebalance
+  m_policy->update_image_loads(instance_id, loads);
+}
+
 template <typename I>
 void ImageMap<I>::update_images(const std::string &mirror_uuid,
                                 std::set<std::string> &&added_global_image_ids,
@@ -531,6 +555,8 @@ void ImageMap<I>::init(Context *on_finish) {
 
   if (policy_type == "none" || policy_type == "simple") {
     m_policy.reset(image_map::SimplePolicy::create(m_ioctx));
+  } else if (policy_type == "load") {
+    m_policy.reset(image_map::LoadPolicy::create(m_ioctx));
   } else {
     ceph_abort(); // not really needed as such, but catch it.
   }
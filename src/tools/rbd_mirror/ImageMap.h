@@ -15,6 +15,7 @@
 
 #include "image_map/Policy.h"
 #include "image_map/Types.h"
+#include "leader_watcher/Types.h"
 
 namespace librbd { class ImageCtx; }
 
@@ -49,6 +50,10 @@ public:
   void update_instances_added(const std::vector<std::string> &instances);
   void update_instances_removed(const std::vector<std::string> &instances);
 
+  // update the observed load of the images replayed by an instance
+  void update_image_loads(const std::string &instance_id,
+                          const leader_watcher::ImageLoads &image_loads);
+
 private:
   struct C_NotifyInstance;
 
@@ -269,6 +269,22 @@ image_replayer::HealthState ImageReplayer<I>::get_health_state() const {
   return image_replayer::HEALTH_STATE_ERROR;
 }
 
+template <typename I>
+bool ImageReplayer<I>::get_load(uint64_t* bytes_per_second,
+                                uint64_t* backlog_bytes) {
+  {
+    std::lock_guard locker{m_lock};
+    if (m_state != STATE_REPLAYING || m_replayer == nullptr) {
+      return false;
+    }
+    m_in_flight_op_tracker.start_op();
+  }
+
+  bool r = m_replayer->get_load(bytes_per_second, backlog_bytes);
+  m_in_flight_op_tracker.finish_op();
+  return r;
+}
+
 template <typename I>
 void ImageReplayer<I>::add_peer(const Peer<I>& peer) {
   dout(10) << "peer=" << peer << dendl;
@@ -91,6 +91,7 @@ public:
   }
 
   image_replayer::HealthState get_health_state() const;
+  bool get_load(uint64_t* bytes_per_second, uint64_t* backlog_bytes);
 
   void add_peer(const Peer<ImageCtxT>& peer);
 
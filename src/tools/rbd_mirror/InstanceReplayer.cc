@@ -27,6 +27,8 @@ namespace {
 const std::string SERVICE_DAEMON_ASSIGNED_COUNT_KEY("image_assigned_count");
 const std::string SERVICE_DAEMON_WARNING_COUNT_KEY("image_warning_count");
 const std::string SERVICE_DAEMON_ERROR_COUNT_KEY("image_error_count");
+const std::string SERVICE_DAEMON_BYTES_PER_SECOND_KEY("image_bytes_per_second");
+const std::string SERVICE_DAEMON_BACKLOG_BYTES_KEY("image_backlog_bytes");
 
 } // anonymous namespace
 
@@ -299,6 +301,21 @@ void InstanceReplayer<I>::stop(Context *on_finish)
   gather_ctx->activate();
 }
 
+template <typename I>
+void InstanceReplayer<I>::get_image_loads(
+    leader_watcher::ImageLoads *image_loads) {
+  dout(20) << dendl;
+
+  std::lock_guard locker{m_lock};
+  for (auto &[global_image_id, image_replayer] : m_image_replayers) {
+    leader_watcher::ImageLoad image_load;
+    if (image_replayer->get_load(&image_load.bytes_per_second,
+                                 &image_load.backlog_bytes)) {
+      (*image_loads)[global_image_id] = image_load;
+    }
+  }
+}
+
 template <typename I>
 void InstanceReplayer<I>::restart()
 {
@@ -379,6 +396,8 @@ void InstanceReplayer<I>::start_image_replayers(
   uint64_t image_count = 0;
   uint64_t warning_count = 0;
   uint64_t error_count = 0;
+  uint64_t bytes_per_second = 0;
+  uint64_t backlog_bytes = 0;
   for (auto it = m_image_replayers.begin();
        it != m_image_replayers.end();) {
     auto current_it(it);
@@ -392,6 +411,14 @@ void InstanceReplayer<I>::start_image_replayers(
       ++error_count;
     }
 
+    uint64_t image_bytes_per_second;
+    uint64_t image_backlog_bytes;
+    if (current_it->second->get_load(&image_bytes_per_second,
+                                     &image_backlog_bytes)) {
+      bytes_per_second += image_bytes_per_second;
+      backlog_bytes += image_backlog_bytes;
+    }
+
     start_image_replayer(current_it->second);
   }
 
@@ -404,6 +431,12 @@ void InstanceReplayer<I>::start_image_replayers(
   m_service_daemon->add_or_update_namespace_attribute(
     m_local_io_ctx.get_id(), m_local_io_ctx.get_namespace(),
     SERVICE_DAEMON_ERROR_COUNT_KEY, error_count);
+  m_service_daemon->add_or_update_namespace_attribute(
+    m_local_io_ctx.get_id(), m_local_io_ctx.get_namespace(),
+    SERVICE_DAEMON_BYTES_PER_SECOND_KEY, bytes_per_second);
+  m_service_daemon->add_or_update_namespace_attribute(
+    m_local_io_ctx.get_id(), m_local_io_ctx.get_namespace(),
+    SERVICE_DAEMON_BACKLOG_BYTES_KEY, backlog_bytes);
 }
 
 template <typename I>
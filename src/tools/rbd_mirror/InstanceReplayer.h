@@ -11,6 +11,7 @@
 #include "common/Formatter.h"
 #include "common/ceph_mutex.h"
 #include "tools/rbd_mirror/Types.h"
+#include "tools/rbd_mirror/leader_watcher/Types.h"
 
 namespace journal { struct CacheManagerHandler; }
 
@@ -72,6 +73,7 @@ public:
   void release_all(Context *on_finish);
 
   void print_status(Formatter *f);
+  void get_image_loads(leader_watcher::ImageLoads *image_loads);
   void start();
   void stop();
   void restart();
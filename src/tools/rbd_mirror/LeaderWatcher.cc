@@ -927,14 +927,47 @@ void LeaderWatcher<I>::handle_notify_heartbeat(int r) {
            << m_heartbeat_response.timeouts.size() << " timed out" << dendl;
 
   std::vector<std::string> instance_ids;
+  std::map<std::string, ImageLoads> instance_image_loads;
   for (auto &it: m_heartbeat_response.acks) {
     uint64_t notifier_id = it.first.gid;
-    instance_ids.push_back(stringify(notifier_id));
+    auto instance_id = stringify(notifier_id);
+    instance_ids.push_back(instance_id);
+
+    // older instances ack with an empty payload
+    if (it.second.length() == 0) {
+      continue;
+    }
+    HeartbeatAck heartbeat_ack;
+    try {
+      auto iter = it.second.cbegin();
+      decode(heartbeat_ack, iter);
+    } catch (const buffer::error &err) {
+      derr << "error decoding heartbeat ack from " << instance_id << ": "
+           << err.what() << dendl;
+      continue;
+    }
+    instance_image_loads[instance_id] = std::move(heartbeat_ack.image_loads);
   }
   if (!instance_ids.empty()) {
     m_instances->acked(instance_ids);
   }
 
+  // deliver the image loads outside of the locks -- the next heartbeat
+  // will not be sent until the listener has processed them
+  m_timer_op_tracker.start_op();
+  auto ctx = new LambdaContext(
+    [this, instance_image_loads=std::move(instance_image_loads)]
+    (int r) mutable {
+      m_listener->get_image_loads(&instance_image_loads[m_instance_id]);
+      for (auto &[instance_id, loads] : instance_image_loads) {
+        m_listener->handle_image_loads(instance_id, loads);
+      }
+
+      std::scoped_lock locker{m_threads->timer_lock, m_lock};
+      m_timer_op_tracker.finish_op();
+    });
+  m_work_queue->queue(ctx, 0);
+
   schedule_timer_task("heartbeat", 1, true,
                       &LeaderWatcher<I>::notify_heartbeat, false);
 }
@@ -947,6 +980,8 @@ void LeaderWatcher<I>::handle_heartbeat(Context *on_notify_ack) {
     std::scoped_lock locker{m_threads->timer_lock, m_lock};
     if (is_leader(m_lock)) {
       dout(5) << "got another leader heartbeat, ignoring" << dendl;
+      on_notify_ack->complete(0);
+      return;
     } else if (!m_locker.cookie.empty()) {
       cancel_timer_task();
       m_acquire_attempts = 0;
@@ -954,6 +989,12 @@ void LeaderWatcher<I>::handle_heartbeat(Context *on_notify_ack) {
     }
   }
 
+  // report the loads of the local images to the leader
+  HeartbeatAck heartbeat_ack;
+  m_listener->get_image_loads(&heartbeat_ack.image_loads);
+  encode(heartbeat_ack,
+         static_cast<C_NotifyAck*>(on_notify_ack)->out);
+
   on_notify_ack->complete(0);
 }
 
@@ -278,6 +278,31 @@ void NamespaceReplayer<I>::handle_instances_removed(
   m_image_map->update_instances_removed(instance_ids);
 }
 
+template <typename I>
+void NamespaceReplayer<I>::handle_image_loads(
+    const std::string &instance_id,
+    const leader_watcher::ImageLoads &image_loads) {
+  dout(20) << "instance_id=" << instance_id << ", "
+           << "images=" << image_loads.size() << dendl;
+
+  std::lock_guard locker{m_lock};
+
+  if (!m_image_map) {
+    return;
+  }
+
+  m_image_map->update_image_loads(instance_id, image_loads);
+}
+
+template <typename I>
+void NamespaceReplayer<I>::get_image_loads(
+    leader_watcher::ImageLoads *image_loads) {
+  dout(20) << dendl;
+
+  std::lock_guard locker{m_lock};
+  m_instance_replayer->get_image_loads(image_loads);
+}
+
 template <typename I>
 void NamespaceReplayer<I>::init_local_status_updater() {
   dout(10) << dendl;
@@ -90,7 +90,10 @@ public:
   void handle_update_leader(const std::string &leader_instance_id);
   void handle_instances_added(const std::vector<std::string> &instance_ids);
   void handle_instances_removed(const std::vector<std::string> &instance_ids);
+  void handle_image_loads(const std::string &instance_id,
+                          const leader_watcher::ImageLoads &image_loads);
 
+  void get_image_loads(leader_watcher::ImageLoads *image_loads);
   void print_status(Formatter *f);
   void start();
   void stop();
@@ -1081,6 +1081,33 @@ void PoolReplayer<I>::handle_instances_removed(
   }
 }
 
+template <typename I>
+void PoolReplayer<I>::get_image_loads(
+    leader_watcher::ImageLoads *image_loads) {
+  dout(20) << dendl;
+
+  std::lock_guard locker{m_lock};
+  for (auto &it : m_namespace_replayers) {
+    it.second->get_image_loads(image_loads);
+  }
+}
+
+template <typename I>
+void PoolReplayer<I>::handle_image_loads(
+    const std::string &instance_id,
+    const leader_watcher::ImageLoads &image_loads) {
+  dout(20) << "instance_id=" << instance_id << dendl;
+
+  std::lock_guard locker{m_lock};
+  if (!m_leader_watcher->is_leader()) {
+    return;
+  }
+
+  for (auto &it : m_namespace_replayers) {
+    it.second->handle_image_loads(instance_id, image_loads);
+  }
+}
+
 template <typename I>
 void PoolReplayer<I>::handle_remote_pool_meta_updated(
     const RemotePoolMeta& remote_pool_meta) {
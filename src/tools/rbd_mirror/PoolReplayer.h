@@ -119,6 +119,9 @@ private:
 
   void handle_instances_added(const std::vector<std::string> &instance_ids);
   void handle_instances_removed(const std::vector<std::string> &instance_ids);
+  void get_image_loads(leader_watcher::ImageLoads *image_loads);
+  void handle_image_loads(const std::string &instance_id,
+                          const leader_watcher::ImageLoads &image_loads);
 
   // sync version, executed in the caller thread
   template <typename L>
@@ -271,6 +274,16 @@ private:
       m_pool_replayer->handle_instances_removed(instance_ids);
     }
 
+    void get_image_loads(leader_watcher::ImageLoads *image_loads) override {
+      m_pool_replayer->get_image_loads(image_loads);
+    }
+
+    void handle_image_loads(
+        const std::string &instance_id,
+        const leader_watcher::ImageLoads &image_loads) override {
+      m_pool_replayer->handle_image_loads(instance_id, image_loads);
+    }
+
   private:
     PoolReplayer *m_pool_replayer;
   } m_leader_listener;
@@ -0,0 +1,161 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
+// vim: ts=8 sw=2 sts=2 expandtab
+
+#include "common/debug.h"
+#include "common/errno.h"
+
+#include "LoadPolicy.h"
+
+#include <algorithm>
+#include <vector>
+
+#define dout_context g_ceph_context
+#define dout_subsys ceph_subsys_rbd_mirror
+#undef dout_prefix
+#define dout_prefix *_dout << "rbd::mirror::image_map::LoadPolicy: " << this \
+                           << " " << __func__ << ": "
+namespace rbd {
+namespace mirror {
+namespace image_map {
+
+LoadPolicy::LoadPolicy(librados::IoCtx &ioctx)
+  : Policy(ioctx),
+    m_cct(reinterpret_cast<CephContext *>(ioctx.cct())) {
+}
+
+uint64_t LoadPolicy::get_default_image_load() {
+  auto& image_loads = Policy::get_image_loads();
+
+  uint64_t total_load = 0;
+  for (auto& [global_image_id, image_load] : image_loads) {
+    total_load += image_load;
+  }
+  if (total_load == 0) {
+    // no load reported yet -- weigh all images equally
+    return 1;
+  }
+  return std::max<uint64_t>(1, total_load / image_loads.size());
+}
+
+uint64_t LoadPolicy::get_image_load(const std::string &global_image_id,
+                                    uint64_t default_image_load) {
+  auto& image_loads = Policy::get_image_loads();
+  auto it = image_loads.find(global_image_id);
+  if (it == image_loads.end()) {
+    return default_image_load;
+  }
+  return it->second;
+}
+
+uint64_t LoadPolicy::get_instance_load(
+    const std::set<std::string> &global_image_ids,
+    uint64_t default_image_load) {
+  uint64_t instance_load = 0;
+  for (auto& global_image_id : global_image_ids) {
+    instance_load += get_image_load(global_image_id, default_image_load);
+  }
+  return instance_load;
+}
+
+void LoadPolicy::do_shuffle_add_instances(
+    const InstanceToImageMap& map, size_t image_count,
+    std::set<std::string> *remap_global_image_ids) {
+  double imbalance = m_cct->_conf.get_val<double>(
+    "rbd_mirror_image_policy_load_imbalance");
+  uint64_t default_image_load = get_default_image_load();
+
+  std::map<std::string, uint64_t> instance_loads;
+  uint64_t total_load = 0;
+  for (auto const &instance : map) {
+    if (Policy::is_dead_instance(instance.first)) {
+      continue;
+    }
+    auto instance_load = get_instance_load(instance.second,
+                                           default_image_load);
+    instance_loads[instance.first] = instance_load;
+    total_load += instance_load;
+  }
+  ceph_assert(!instance_loads.empty());
+
+  uint64_t average_load = total_load / instance_loads.size();
+  uint64_t high_load = static_cast<uint64_t>(average_load * (1 + imbalance));
+  dout(5) << "average load=" << average_load << ", "
+          << "high load=" << high_load << dendl;
+
+  auto least_loaded = [&instance_loads]() {
+    return std::min_element(
+      instance_loads.begin(), instance_loads.end(),
+      [](auto& lhs, auto& rhs) { return lhs.second < rhs.second; });
+  };
+
+  for (auto const &instance : map) {
+    auto load_it = instance_loads.find(instance.first);
+    if (load_it == instance_loads.end() || load_it->second <= high_load) {
+      continue;
+    }
+
+    // move the busiest images first to minimize the number of remaps
+    std::vector<std::pair<uint64_t, std::string>> images;
+    for (auto& global_image_id : instance.second) {
+      images.emplace_back(get_image_load(global_image_id, default_image_load),
+                          global_image_id);
+    }
+    std::sort(images.rbegin(), images.rend());
+
+    auto& load = load_it->second;
+    for (auto& [image_load, global_image_id] : images) {
+      if (load <= average_load) {
+        break;
+      }
+
+      // the image will be mapped to the least loaded instance -- skip
+      // it if that would only shift the imbalance elsewhere
+      auto min_it = least_loaded();
+      if (min_it == load_it || image_load >= load - min_it->second) {
+        continue;
+      }
+
+      if (Policy::is_image_shuffling(global_image_id)) {
+        load -= image_load;
+        min_it->second += image_load;
+      } else if (Policy::can_shuffle_image(global_image_id)) {
+        load -= image_load;
+        min_it->second += image_load;
+        remap_global_image_ids->emplace(global_image_id);
+      }
+    }
+
+    dout(10) << "instance_id=" << instance.first << ", "
+             << "projected load=" << load << dendl;
+  }
+}
+
+std::string LoadPolicy::do_map(const InstanceToImageMap& map,
+                               const std::string &global_image_id) {
+  uint64_t default_image_load = get_default_image_load();
+
+  auto min_it = map.end();
+  uint64_t min_load = 0;
+  for (auto it = map.begin(); it != map.end(); ++it) {
+    ceph_assert(it->second.find(global_image_id) == it->second.end());
+    if (Policy::is_dead_instance(it->first)) {
+      continue;
+    }
+
+    auto load = get_instance_load(it->second, default_image_load);
+    if (min_it == map.end() || load < min_load ||
+        (load == min_load && it->second.size() < min_it->second.size())) {
+      min_it = it;
+      min_load = load;
+    }
+  }
+
+  ceph_assert(min_it != map.end());
+  dout(20) << "global_image_id=" << global_image_id << " maps to instance_id="
+           << min_it->first << ", load=" << min_load << dendl;
+  return min_it->first;
+}
+
+} // namespace image_map
+} // namespace mirror
+} // namespace rbd
@@ -0,0 +1,52 @@
+// -*- mode:C++; tab-width:8; c-basic-offset:2; indent-tabs-mode:nil -*-
+// vim: ts=8 sw=2 sts=2 expandtab
+
+#ifndef CEPH_RBD_MIRROR_IMAGE_MAP_LOAD_POLICY_H
+#define CEPH_RBD_MIRROR_IMAGE_MAP_LOAD_POLICY_H
+
+#include "Policy.h"
+
+namespace rbd {
+namespace mirror {
+namespace image_map {
+
+/**
+ * Map images to instances based upon the replication load reported by
+ * the instances.  Images are mapped to the least loaded instance and
+ * images are shuffled off an instance once its load exceeds the average
+ * by more than rbd_mirror_image_policy_load_imbalance.  Images without
+ * a reported load are assumed to carry the average image load, so this
+ * degrades to SimplePolicy until loads are known.
+ */
+class LoadPolicy : public Policy {
+public:
+  static LoadPolicy *create(librados::IoCtx &ioctx) {
+    return new LoadPolicy(ioctx);
+  }
+
+protected:
+  LoadPolicy(librados::IoCtx &ioctx);
+
+  std::string do_map(const InstanceToImageMap& map,
+                     const std::string &global_image_id) override;
+
+  void do_shuffle_add_instances(
+      const InstanceToImageMap& map, size_t image_count,
+      std::set<std::string> *remap_global_image_ids) override;
+
+private:
+  CephContext *m_cct;
+
+  uint64_t get_default_image_load();
+  uint64_t get_image_load(const std::string &global_image_id,
+                          uint64_t default_image_load);
+  uint64_t get_instance_load(const std::set<std::string> &global_image_ids,
+                             uint64_t default_image_load);
+
+};
+
+} // namespace image_map
+} // namespace mirror
+} // namespace rbd
+
+#endif // CEPH_RBD_MIRROR_IMAGE_MAP_LOAD_POLICY_H
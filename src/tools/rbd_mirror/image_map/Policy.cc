@@ -271,6 +271,26 @@ bool Policy::finish_action(const std::string &global_image_id, int r) {
   return pending_action;
 }
 
+void Policy::update_image_loads(
+    const std::string &instance_id,
+    const std::map<std::string, uint64_t> &image_loads) {
+  dout(20) << "instance_id=" << instance_id << dendl;
+
+  std::unique_lock map_lock{m_map_lock};
+  auto map_it = m_map.find(instance_id);
+  if (map_it == m_map.end()) {
+    return;
+  }
+
+  // ignore stale reports for images that have since been remapped
+  for (auto& global_image_id : map_it->second) {
+    auto it = image_loads.find(global_image_id);
+    if (it != image_loads.end()) {
+      m_image_loads[global_image_id] = it->second;
+    }
+  }
+}
+
 void Policy::execute_policy_action(
     const std::string& global_image_id, ImageState* image_state,
     StateTransition::PolicyAction policy_action) {
@@ -289,6 +309,7 @@ void Policy::execute_policy_action(
       ceph_assert(image_state->instance_id == UNMAPPED_INSTANCE_ID);
       ceph_assert(!image_state->next_state);
       m_image_states.erase(global_image_id);
+      m_image_loads.erase(global_image_id);
     }
     break;
   }
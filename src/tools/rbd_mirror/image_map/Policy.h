@@ -49,8 +49,19 @@ public:
   ActionType start_action(const std::string &global_image_id);
   bool finish_action(const std::string &global_image_id, int r);
 
+  // record the observed load (in bytes per second) of the images
+  // replayed by an instance
+  void update_image_loads(const std::string &instance_id,
+                          const std::map<std::string, uint64_t> &image_loads);
+
 protected:
   typedef std::map<std::string, std::set<std::string> > InstanceToImageMap;
+  typedef std::map<std::string, uint64_t> ImageLoads;
+
+  const ImageLoads &get_image_loads() const {
+    ceph_assert(ceph_mutex_is_locked(m_map_lock));
+    return m_image_loads;
+  }
 
   bool is_dead_instance(const std::string instance_id) {
     ceph_assert(ceph_mutex_is_locked(m_map_lock));
@@ -96,6 +107,7 @@ private:
 
   ImageStates m_image_states;
   std::set<std::string> m_dead_instances;
+  ImageLoads m_image_loads;
 
   bool m_initial_update = true;
 
@@ -4,6 +4,7 @@
 #ifndef RBD_MIRROR_IMAGE_REPLAYER_REPLAYER_H
 #define RBD_MIRROR_IMAGE_REPLAYER_REPLAYER_H
 
+#include <cstdint>
 #include <string>
 
 struct Context;
@@ -25,6 +26,12 @@ struct Replayer {
   virtual bool get_replay_status(std::string* description,
                                  Context* on_finish) = 0;
 
+  // recent replication rate and data still to be replicated, used to
+  // balance images across instances
+  virtual bool get_load(uint64_t* bytes_per_second, uint64_t* backlog_bytes) {
+    return false;
+  }
+
   virtual bool is_replaying() const = 0;
   virtual bool is_resync_requested() const = 0;
 
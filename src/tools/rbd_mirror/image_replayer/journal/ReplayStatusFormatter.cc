@@ -60,6 +60,22 @@ void ReplayStatusFormatter<I>::handle_entry_processed(uint32_t bytes) {
   m_entries_per_second(1);
 }
 
+template <typename I>
+void ReplayStatusFormatter<I>::get_load(uint64_t *bytes_per_second,
+                                        uint64_t *backlog_bytes) {
+  m_bytes_per_second(0);
+  m_entries_per_second(0);
+  auto bytes = m_bytes_per_second.get_average();
+  auto entries = m_entries_per_second.get_average();
+
+  // the backlog is only known in entries: assume recent entry sizes
+  *bytes_per_second = bytes;
+  *backlog_bytes = 0;
+  if (m_entries_behind_master > 0 && entries > 0) {
+    *backlog_bytes = m_entries_behind_master * (bytes / entries);
+  }
+}
+
 template <typename I>
 bool ReplayStatusFormatter<I>::get_or_send_update(std::string *description,
 						  Context *on_finish) {
@@ -38,6 +38,7 @@ public:
   void handle_entry_processed(uint32_t bytes);
 
   bool get_or_send_update(std::string *description, Context *on_finish);
+  void get_load(uint64_t *bytes_per_second, uint64_t *backlog_bytes);
 
 private:
   Journaler *m_journaler;
@@ -249,6 +249,18 @@ bool Replayer<I>::get_replay_status(std::string* description,
                                                        on_finish);
 }
 
+template <typename I>
+bool Replayer<I>::get_load(uint64_t* bytes_per_second,
+                           uint64_t* backlog_bytes) {
+  std::unique_lock locker{m_lock};
+  if (m_replay_status_formatter == nullptr) {
+    return false;
+  }
+
+  m_replay_status_formatter->get_load(bytes_per_second, backlog_bytes);
+  return true;
+}
+
 template <typename I>
 void Replayer<I>::init_remote_journaler() {
   dout(10) << dendl;
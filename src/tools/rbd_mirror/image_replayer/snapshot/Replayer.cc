@@ -362,6 +362,21 @@ bool Replayer<I>::is_remote_primary() {
   return false;
 }
 
+template <typename I>
+bool Replayer<I>::get_load(uint64_t* bytes_per_second,
+                           uint64_t* backlog_bytes) {
+  std::unique_lock locker{m_lock};
+  if (m_state != STATE_REPLAYING && m_state != STATE_IDLE) {
+    return false;
+  }
+
+  m_bytes_per_second(0);
+  *bytes_per_second = m_bytes_per_second.get_average();
+  *backlog_bytes = boost::accumulators::rolling_mean(m_bytes_per_snapshot) *
+                   m_pending_snapshots;
+  return true;
+}
+
 template <typename I>
 void Replayer<I>::load_local_image_meta() {
   dout(10) << dendl;
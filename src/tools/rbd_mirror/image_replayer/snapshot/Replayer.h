@@ -73,6 +73,7 @@ public:
   void flush(Context* on_finish) override;
 
   bool get_replay_status(std::string* description, Context* on_finish) override;
+  bool get_load(uint64_t* bytes_per_second, uint64_t* backlog_bytes) override;
 
   bool is_replaying() const override {
     std::unique_lock locker{m_lock};
@@ -59,6 +59,56 @@ private:
 
 } // anonymous namespace
 
+void ImageLoad::encode(bufferlist &bl) const {
+  ENCODE_START(1, 1, bl);
+  encode(bytes_per_second, bl);
+  encode(backlog_bytes, bl);
+  ENCODE_FINISH(bl);
+}
+
+void ImageLoad::decode(bufferlist::const_iterator &iter) {
+  DECODE_START(1, iter);
+  decode(bytes_per_second, iter);
+  decode(backlog_bytes, iter);
+  DECODE_FINISH(iter);
+}
+
+void ImageLoad::dump(Formatter *f) const {
+  f->dump_unsigned("bytes_per_second", bytes_per_second);
+  f->dump_unsigned("backlog_bytes", backlog_bytes);
+}
+
+void HeartbeatAck::encode(bufferlist &bl) const {
+  ENCODE_START(1, 1, bl);
+  encode(image_loads, bl);
+  ENCODE_FINISH(bl);
+}
+
+void HeartbeatAck::decode(bufferlist::const_iterator &iter) {
+  DECODE_START(1, iter);
+  decode(image_loads, iter);
+  DECODE_FINISH(iter);
+}
+
+void HeartbeatAck::dump(Formatter *f) const {
+  f->open_array_section("image_loads");
+  for (auto &[global_image_id, image_load] : image_loads) {
+    f->open_object_section("image_load");
+    f->dump_string("global_image_id", global_image_id);
+    image_load.dump(f);
+    f->close_section();
+  }
+  f->close_section();
+}
+
+std::list<HeartbeatAck> HeartbeatAck::generate_test_instances() {
+  std::list<HeartbeatAck> o;
+  o.push_back(HeartbeatAck());
+  o.push_back(HeartbeatAck());
+  o.back().image_loads["global image id"] = {4096, 1 << 20};
+  return o;
+}
+
 void HeartbeatPayload::encode(bufferlist &bl) const {
 }
 
@@ -7,6 +7,7 @@
 #include "include/int_types.h"
 #include "include/buffer_fwd.h"
 #include "include/encoding.h"
+#include <map>
 #include <string>
 #include <variant>
 #include <vector>
@@ -19,6 +20,32 @@ namespace rbd {
 namespace mirror {
 namespace leader_watcher {
 
+struct ImageLoad {
+  uint64_t bytes_per_second = 0;
+  uint64_t backlog_bytes = 0;
+
+  void encode(bufferlist &bl) const;
+  void decode(bufferlist::const_iterator &iter);
+  void dump(Formatter *f) const;
+};
+
+WRITE_CLASS_ENCODER(ImageLoad);
+
+// global image id -> load of the images replayed by an instance
+typedef std::map<std::string, ImageLoad> ImageLoads;
+
+struct HeartbeatAck {
+  ImageLoads image_loads;
+
+  void encode(bufferlist &bl) const;
+  void decode(bufferlist::const_iterator &iter);
+  void dump(Formatter *f) const;
+
+  static std::list<HeartbeatAck> generate_test_instances();
+};
+
+WRITE_CLASS_ENCODER(HeartbeatAck);
+
 struct Listener {
   typedef std::vector<std::string> InstanceIds;
 
@@ -33,6 +60,14 @@ struct Listener {
 
   virtual void handle_instances_added(const InstanceIds& instance_ids) = 0;
   virtual void handle_instances_removed(const InstanceIds& instance_ids) = 0;
+
+  // loads of the local images are reported to the leader along with
+  // heartbeat acks
+  virtual void get_image_loads(ImageLoads *image_loads) {
+  }
+  virtual void handle_image_loads(const std::string &instance_id,
+                                  const ImageLoads &image_loads) {
+  }
 };
 
 enum NotifyOp : uint32_t {
@@ -49,6 +49,7 @@
 #include <iostream>
 #include <memory>
 #include <regex>
+#include <vector>
 #include <boost/algorithm/string/predicate.hpp>
 #include <boost/lexical_cast.hpp>
 
@@ -101,6 +102,7 @@ struct Config {
   int max_part = 255;
   int io_timeout = -1;
   int reattach_timeout = 30;
+  int num_connections = 1;
 
   bool exclusive = false;
   bool notrim = false;
@@ -157,6 +159,8 @@ static void usage()
             << "  --encryption-passphrase-file  Path of file containing passphrase for unlocking image encryption\n"
             << "  --exclusive                   Forbid writes by other clients\n"
             << "  --notrim                      Turn off trim/discard\n"
+            << "  --num-connections <count>     Number of connections to the device\n"
+            << "                                (default: " << Config().num_connections << ")\n"
             << "  --io-timeout <sec>            Set nbd IO timeout\n"
             << "  --max_part <limit>            Override for module param max_part\n"
             << "  --nbds_max <limit>            Override for module param nbds_max\n"
@@ -187,6 +191,12 @@ static EventSocket terminate_event_sock;
 
 #define RBD_NBD_BLKSIZE 512UL
 
+#ifndef NBD_FLAG_CAN_MULTI_CONN
+#define NBD_FLAG_CAN_MULTI_CONN (1 << 8)
+#endif
+
+#define RBD_NBD_MAX_CONNECTIONS 64
+
 #define HELP_INFO 1
 #define VERSION_INFO 2
 
@@ -208,17 +218,15 @@ public:
   uint64_t quiesce_watch_handle = 0;
 
 private:
-  int fd;
+  std::vector<int> fds;
   librbd::Image &image;
   Config *cfg;
 
 public:
-  NBDServer(int fd, librbd::Image& image, Config *cfg)
-    : fd(fd)
+  NBDServer(const std::vector<int>& fds, librbd::Image& image, Config *cfg)
+    : fds(fds)
     , image(image)
     , cfg(cfg)
-    , reader_thread(*this, &NBDServer::reader_entry)
-    , writer_thread(*this, &NBDServer::writer_entry)
     , quiesce_thread(*this, &NBDServer::quiesce_entry)
   {
     std::vector<librbd::config_option_t> options;
@@ -245,10 +253,12 @@ private:
   std::atomic<bool> terminated = { false };
   std::atomic<bool> allow_internal_flush = { false };
 
+  struct Connection;
+
   struct IOContext
   {
     xlist<IOContext*>::item item;
-    NBDServer *server = nullptr;
+    Connection *conn = nullptr;
     struct nbd_request request;
     struct nbd_reply reply;
     bufferlist data;
@@ -261,62 +271,134 @@ private:
 
   friend std::ostream &operator<<(std::ostream &os, const IOContext &ctx);
 
+  class ThreadHelper : public Thread
+  {
+  public:
+    typedef void (NBDServer::*entry_func)();
+  private:
+    NBDServer &server;
+    entry_func func;
+  public:
+    ThreadHelper(NBDServer &_server, entry_func _func)
+      :server(_server)
+      ,func(_func)
+    {}
+  protected:
+    void* entry() override
+    {
+      (server.*func)();
+      return NULL;
+    }
+  };
+
+  class ConnectionThreadHelper : public Thread
+  {
+  public:
+    typedef void (NBDServer::*entry_func)(Connection *conn);
+  private:
+    NBDServer &server;
+    Connection *conn;
+    entry_func func;
+  public:
+    ConnectionThreadHelper(NBDServer &_server, Connection *_conn,
+                           entry_func _func)
+      :server(_server)
+      ,conn(_conn)
+      ,func(_func)
+    {}
+  protected:
+    void* entry() override
+    {
+      (server.*func)(conn);
+      return NULL;
+    }
+  };
+
+  /*
+   * Each socket handed to the kernel is served by its own reader/writer
+   * thread pair and tracks its own in-flight requests, so that the
+   * connections (which the kernel maps to separate hardware queues) do
+   * not serialize on a common lock.  All of them feed the same image.
+   */
+  struct Connection
+  {
+    NBDServer *server;
+    int fd;
+    ceph::mutex lock = ceph::make_mutex("NBDServer::Connection::Locker");
+    ceph::condition_variable cond;
+    xlist<IOContext*> io_pending;
+    xlist<IOContext*> io_finished;
+    bool terminated = false;
+
+    ConnectionThreadHelper reader_thread;
+    ConnectionThreadHelper writer_thread;
+
+    Connection(NBDServer *server, int fd)
+      : server(server)
+      , fd(fd)
+      , reader_thread(*server, this, &NBDServer::reader_entry)
+      , writer_thread(*server, this, &NBDServer::writer_entry)
+    {}
+  };
+
+  std::vector<std::unique_ptr<Connection>> connections;
+
   ceph::mutex lock = ceph::make_mutex("NBDServer::Locker");
   ceph::condition_variable cond;
-  xlist<IOContext*> io_pending;
-  xlist<IOContext*> io_finished;
 
   void io_start(IOContext *ctx)
   {
-    std::lock_guard l{lock};
-    io_pending.push_back(&ctx->item);
+    Connection *conn = ctx->conn;
+    std::lock_guard l{conn->lock};
+    conn->io_pending.push_back(&ctx->item);
   }
 
   void io_finish(IOContext *ctx)
   {
-    std::lock_guard l{lock};
+    Connection *conn = ctx->conn;
+    std::lock_guard l{conn->lock};
     ceph_assert(ctx->item.is_on_list());
     ctx->item.remove_myself();
-    io_finished.push_back(&ctx->item);
-    cond.notify_all();
+    conn->io_finished.push_back(&ctx->item);
+    conn->cond.notify_all();
   }
 
-  IOContext *wait_io_finish()
+  IOContext *wait_io_finish(Connection *conn)
   {
-    std::unique_lock l{lock};
-    cond.wait(l, [this] {
-                   return !io_finished.empty() ||
-                          (io_pending.empty() && terminated);
-                 });
+    std::unique_lock l{conn->lock};
+    conn->cond.wait(l, [conn] {
+                         return !conn->io_finished.empty() ||
+                                (conn->io_pending.empty() && conn->terminated);
+                       });
 
-    if (io_finished.empty())
+    if (conn->io_finished.empty())
       return NULL;
 
-    IOContext *ret = io_finished.front();
-    io_finished.pop_front();
+    IOContext *ret = conn->io_finished.front();
+    conn->io_finished.pop_front();
 
     return ret;
   }
 
-  void wait_clean()
+  void wait_clean(Connection *conn)
   {
-    std::unique_lock l{lock};
-    cond.wait(l, [this] { return io_pending.empty(); });
+    std::unique_lock l{conn->lock};
+    conn->cond.wait(l, [conn] { return conn->io_pending.empty(); });
 
-    while(!io_finished.empty()) {
-      std::unique_ptr<IOContext> free_ctx(io_finished.front());
-      io_finished.pop_front();
+    while(!conn->io_finished.empty()) {
+      std::unique_ptr<IOContext> free_ctx(conn->io_finished.front());
+      conn->io_finished.pop_front();
     }
   }
 
-  void assert_clean()
+  void assert_clean(Connection *conn)
   {
-    std::unique_lock l{lock};
+    std::unique_lock l{conn->lock};
 
-    ceph_assert(!reader_thread.is_started());
-    ceph_assert(!writer_thread.is_started());
-    ceph_assert(io_pending.empty());
-    ceph_assert(io_finished.empty());
+    ceph_assert(!conn->reader_thread.is_started());
+    ceph_assert(!conn->writer_thread.is_started());
+    ceph_assert(conn->io_pending.empty());
+    ceph_assert(conn->io_finished.empty());
   }
 
   static void aio_callback(librbd::completion_t cb, void *arg)
@@ -349,23 +431,23 @@ private:
     } else {
       ctx->reply.error = native_to_big<uint32_t>(0);
     }
-    ctx->server->io_finish(ctx);
+    ctx->conn->server->io_finish(ctx);
 
     aio_completion->release();
   }
 
-  void reader_entry()
+  void reader_entry(Connection *conn)
   {
     struct pollfd poll_fds[2];
     memset(poll_fds, 0, sizeof(struct pollfd) * 2);
-    poll_fds[0].fd = fd;
+    poll_fds[0].fd = conn->fd;
     poll_fds[0].events = POLLIN;
     poll_fds[1].fd = terminate_event_fd;
     poll_fds[1].events = POLLIN;
 
     while (true) {
       std::unique_ptr<IOContext> ctx(new IOContext());
-      ctx->server = this;
+      ctx->conn = conn;
 
       dout(20) << __func__ << ": waiting for nbd request" << dendl;
 
@@ -389,7 +471,7 @@ private:
         continue;
       }
 
-      r = safe_read_exact(fd, &ctx->request, sizeof(struct nbd_request));
+      r = safe_read_exact(conn->fd, &ctx->request, sizeof(struct nbd_request));
       if (r < 0) {
 	derr << "failed to read nbd request header: " << cpp_strerror(r)
 	     << dendl;
@@ -419,14 +501,15 @@ private:
 	  dout(0) << "disconnect request received" << dendl;
           goto signal;
         case NBD_CMD_WRITE:
-          bufferptr ptr(ctx->request.len);
-	  r = safe_read_exact(fd, ptr.c_str(), ctx->request.len);
+          // page aligned so the data can be handed to librbd as is
+          bufferptr ptr = buffer::create_page_aligned(ctx->request.len);
+	  r = safe_read_exact(conn->fd, ptr.c_str(), ctx->request.len);
           if (r < 0) {
 	    derr << *ctx << ": failed to read nbd request data: "
 		 << cpp_strerror(r) << dendl;
             goto error;
 	  }
-          ctx->data.push_back(ptr);
+          ctx->data.push_back(std::move(ptr));
           break;
       }
 
@@ -462,6 +545,12 @@ error:
       }
     }
 signal:
+    {
+      std::lock_guard l{conn->lock};
+      conn->terminated = true;
+      conn->cond.notify_all();
+    }
+
     std::lock_guard l{lock};
     terminated = true;
     cond.notify_all();
@@ -472,11 +561,11 @@ signal:
     dout(20) << __func__ << ": terminated" << dendl;
   }
 
-  void writer_entry()
+  void writer_entry(Connection *conn)
   {
     while (true) {
       dout(20) << __func__ << ": waiting for io request" << dendl;
-      std::unique_ptr<IOContext> ctx(wait_io_finish());
+      std::unique_ptr<IOContext> ctx(wait_io_finish(conn));
       if (!ctx) {
 	dout(20) << __func__ << ": no io requests, terminating" << dendl;
         goto done;
@@ -484,26 +573,25 @@ signal:
 
       dout(20) << __func__ << ": got: " << *ctx << dendl;
 
-      int r = safe_write(fd, &ctx->reply, sizeof(struct nbd_reply));
+      // send the reply header and the read data with a single writev
+      bufferlist bl;
+      bl.append(reinterpret_cast<const char*>(&ctx->reply),
+                sizeof(struct nbd_reply));
+      if (ctx->command == NBD_CMD_READ && ctx->reply.error == htonl(0)) {
+        bl.claim_append(ctx->data);
+      }
+      int r = bl.write_fd(conn->fd);
       if (r < 0) {
-	derr << *ctx << ": failed to write reply header: " << cpp_strerror(r)
+	derr << *ctx << ": failed to write reply: " << cpp_strerror(r)
 	     << dendl;
         goto error;
       }
-      if (ctx->command == NBD_CMD_READ && ctx->reply.error == htonl(0)) {
-	r = ctx->data.write_fd(fd);
-        if (r < 0) {
-	  derr << *ctx << ": failed to write replay data: " << cpp_strerror(r)
-	       << dendl;
-          goto error;
-	}
-      }
       dout(20) << *ctx << ": finish" << dendl;
     }
   error:
-    wait_clean();
+    wait_clean(conn);
   done:
-    ::shutdown(fd, SHUT_RDWR);
+    ::shutdown(conn->fd, SHUT_RDWR);
 
     dout(20) << __func__ << ": terminated" << dendl;
   }
@@ -583,25 +671,7 @@ signal:
     dout(20) << __func__ << ": terminated" << dendl;
   }
 
-  class ThreadHelper : public Thread
-  {
-  public:
-    typedef void (NBDServer::*entry_func)();
-  private:
-    NBDServer &server;
-    entry_func func;
-  public:
-    ThreadHelper(NBDServer &_server, entry_func _func)
-      :server(_server)
-      ,func(_func)
-    {}
-  protected:
-    void* entry() override
-    {
-      (server.*func)();
-      return NULL;
-    }
-  } reader_thread, writer_thread, quiesce_thread;
+  ThreadHelper quiesce_thread;
 
   bool started = false;
   bool quiesce = false;
@@ -620,8 +690,12 @@ public:
                                         EVENT_SOCKET_TYPE_EVENTFD);
       ceph_assert(r >= 0);
 
-      reader_thread.create("rbd_reader");
-      writer_thread.create("rbd_writer");
+      for (size_t i = 0; i < fds.size(); i++) {
+        auto conn = std::make_unique<Connection>(this, fds[i]);
+        conn->reader_thread.create(("rbd_reader_" + stringify(i)).c_str());
+        conn->writer_thread.create(("rbd_writer_" + stringify(i)).c_str());
+        connections.push_back(std::move(conn));
+      }
       if (cfg->quiesce) {
         quiesce_thread.create("rbd_quiesce");
       }
@@ -666,13 +740,18 @@ public:
 
       terminate_event_sock.notify();
 
-      reader_thread.join();
-      writer_thread.join();
+      for (auto& conn : connections) {
+        conn->reader_thread.join();
+        conn->writer_thread.join();
+      }
       if (cfg->quiesce) {
         quiesce_thread.join();
       }
 
-      assert_clean();
+      for (auto& conn : connections) {
+        assert_clean(conn.get());
+      }
+      connections.clear();
 
       close(terminate_event_fd);
       started = false;
@@ -1122,8 +1201,8 @@ static int parse_nbd_index(const std::string& devpath)
   return index;
 }
 
-static int try_ioctl_setup(Config *cfg, int fd, uint64_t size,
-                           uint64_t blksize, uint64_t flags)
+static int try_ioctl_setup(Config *cfg, const std::vector<int>& fds,
+                           uint64_t size, uint64_t blksize, uint64_t flags)
 {
   int index = 0, r;
 
@@ -1154,7 +1233,7 @@ static int try_ioctl_setup(Config *cfg, int fd, uint64_t size,
         goto done;
       }
 
-      r = ioctl(nbd, NBD_SET_SOCK, fd);
+      r = ioctl(nbd, NBD_SET_SOCK, fds[0]);
       if (r < 0) {
         close(nbd);
         ++index;
@@ -1177,7 +1256,7 @@ static int try_ioctl_setup(Config *cfg, int fd, uint64_t size,
       goto done;
     }
 
-    r = ioctl(nbd, NBD_SET_SOCK, fd);
+    r = ioctl(nbd, NBD_SET_SOCK, fds[0]);
     if (r < 0) {
       r = -errno;
       cerr << "rbd-nbd: the device " << cfg->devpath << " is busy" << std::endl;
@@ -1186,6 +1265,16 @@ static int try_ioctl_setup(Config *cfg, int fd, uint64_t size,
     }
   }
 
+  for (size_t i = 1; i < fds.size(); i++) {
+    r = ioctl(nbd, NBD_SET_SOCK, fds[i]);
+    if (r < 0) {
+      r = -errno;
+      cerr << "rbd-nbd: failed to add connection: " << cpp_strerror(r)
+           << std::endl;
+      goto close_nbd;
+    }
+  }
+
   r = ioctl(nbd, NBD_SET_BLKSIZE, blksize);
   if (r < 0) {
     r = -errno;
@@ -1400,8 +1489,9 @@ static int netlink_connect_cb(struct nl_msg *msg, void *arg)
   return NL_OK;
 }
 
-static int netlink_connect(Config *cfg, struct nl_sock *sock, int nl_id, int fd,
-                           uint64_t size, uint64_t flags, bool reconnect)
+static int netlink_connect(Config *cfg, struct nl_sock *sock, int nl_id,
+                           const std::vector<int>& fds, uint64_t size,
+                           uint64_t flags, bool reconnect)
 {
   struct nlattr *sock_attr;
   struct nlattr *sock_opt;
@@ -1456,14 +1546,16 @@ static int netlink_connect(Config *cfg, struct nl_sock *sock, int nl_id, int fd,
     goto free_msg;
   }
 
-  sock_opt = nla_nest_start(msg, NBD_SOCK_ITEM);
-  if (!sock_opt) {
-    cerr << "rbd-nbd: Could not init sock in netlink message." << std::endl;
-    goto free_msg;
-  }
+  for (auto fd : fds) {
+    sock_opt = nla_nest_start(msg, NBD_SOCK_ITEM);
+    if (!sock_opt) {
+      cerr << "rbd-nbd: Could not init sock in netlink message." << std::endl;
+      goto free_msg;
+    }
 
-  NLA_PUT_U32(msg, NBD_SOCK_FD, fd);
-  nla_nest_end(msg, sock_opt);
+    NLA_PUT_U32(msg, NBD_SOCK_FD, fd);
+    nla_nest_end(msg, sock_opt);
+  }
   nla_nest_end(msg, sock_attr);
 
   ret = nl_send_sync(sock, msg);
@@ -1482,8 +1574,8 @@ free_msg:
   return -EIO;
 }
 
-static int try_netlink_setup(Config *cfg, int fd, uint64_t size, uint64_t flags,
-                             bool reconnect)
+static int try_netlink_setup(Config *cfg, const std::vector<int>& fds,
+                             uint64_t size, uint64_t flags, bool reconnect)
 {
   struct nl_sock *sock;
   int nl_id, ret;
@@ -1497,7 +1589,7 @@ static int try_netlink_setup(Config *cfg, int fd, uint64_t size, uint64_t flags,
 
   dout(10) << "netlink interface supported." << dendl;
 
-  ret = netlink_connect(cfg, sock, nl_id, fd, size, flags, reconnect);
+  ret = netlink_connect(cfg, sock, nl_id, fds, size, flags, reconnect);
   netlink_cleanup(sock);
 
   if (ret != 0)
@@ -1553,11 +1645,12 @@ static void handle_signal(int signum)
   terminate_event_sock.notify();
 }
 
-static NBDServer *start_server(int fd, librbd::Image& image, Config *cfg)
+static NBDServer *start_server(const std::vector<int>& fds,
+                               librbd::Image& image, Config *cfg)
 {
   NBDServer *server;
 
-  server = new NBDServer(fd, image, cfg);
+  server = new NBDServer(fds, image, cfg);
   server->start();
 
   init_async_signal_handler();
@@ -1683,7 +1776,9 @@ static int do_map(int argc, const char *argv[], Config *cfg, bool reconnect)
   unsigned long blksize = RBD_NBD_BLKSIZE;
   bool use_netlink = true;
 
-  int fd[2];
+  // one socketpair per connection, the kernel gets the client ends
+  std::vector<int> client_fds;
+  std::vector<int> server_fds;
 
   librbd::image_info_t info;
 
@@ -1724,9 +1819,14 @@ static int do_map(int argc, const char *argv[], Config *cfg, bool reconnect)
   common_init_finish(g_ceph_context);
   global_init_chdir(g_ceph_context);
 
-  if (socketpair(AF_UNIX, SOCK_STREAM, 0, fd) == -1) {
-    r = -errno;
-    goto close_ret;
+  for (int i = 0; i < cfg->num_connections; i++) {
+    int fd[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM, 0, fd) == -1) {
+      r = -errno;
+      goto close_fd;
+    }
+    client_fds.push_back(fd[0]);
+    server_fds.push_back(fd[1]);
   }
 
   r = rados.init_with_context(g_ceph_context);
@@ -1838,6 +1938,11 @@ static int do_map(int argc, const char *argv[], Config *cfg, bool reconnect)
   if (!cfg->notrim) {
     flags |= NBD_FLAG_SEND_TRIM;
   }
+  if (cfg->num_connections > 1) {
+    // all connections are served by the same image, so a flush on any
+    // of them covers writes completed on the others
+    flags |= NBD_FLAG_CAN_MULTI_CONN;
+  }
   if (!cfg->snapname.empty() || cfg->readonly) {
     flags |= NBD_FLAG_READ_ONLY;
     read_only = 1;
@@ -1856,7 +1961,7 @@ static int do_map(int argc, const char *argv[], Config *cfg, bool reconnect)
   if (r < 0)
     goto close_fd;
 
-  server = start_server(fd[1], image, cfg);
+  server = start_server(server_fds, image, cfg);
 
   // generate when the cookie is not supplied at CLI
   if (!reconnect && cfg->cookie.empty()) {
@@ -1864,7 +1969,7 @@ static int do_map(int argc, const char *argv[], Config *cfg, bool reconnect)
     uuid_gen.generate_random();
     cfg->cookie = uuid_gen.to_string();
   }
-  r = try_netlink_setup(cfg, fd[0], size, flags, reconnect);
+  r = try_netlink_setup(cfg, client_fds, size, flags, reconnect);
   if (r < 0) {
     goto free_server;
   } else if (r == 1) {
@@ -1872,7 +1977,7 @@ static int do_map(int argc, const char *argv[], Config *cfg, bool reconnect)
   }
 
   if (!use_netlink) {
-    r = try_ioctl_setup(cfg, fd[0], size, blksize, flags);
+    r = try_ioctl_setup(cfg, client_fds, size, blksize, flags);
     if (r < 0)
       goto free_server;
   }
@@ -1941,9 +2046,12 @@ close_nbd:
 free_server:
   delete server;
 close_fd:
-  close(fd[0]);
-  close(fd[1]);
-close_ret:
+  for (auto fd : client_fds) {
+    close(fd);
+  }
+  for (auto fd : server_fds) {
+    close(fd);
+  }
   image.close();
   io_ctx.close();
   rados.shutdown();
@@ -2196,6 +2304,18 @@ static int parse_args(vector<const char*>& args, std::ostream *err_msg,
       cfg->exclusive = true;
     } else if (ceph_argparse_flag(args, i, "--notrim", (char *)NULL)) {
       cfg->notrim = true;
+    } else if (ceph_argparse_witharg(args, i, &cfg->num_connections, err,
+                                     "--num-connections", (char *)NULL)) {
+      if (!err.str().empty()) {
+        *err_msg << "rbd-nbd: " << err.str();
+        return -EINVAL;
+      }
+      if (cfg->num_connections < 1 ||
+          cfg->num_connections > RBD_NBD_MAX_CONNECTIONS) {
+        *err_msg << "rbd-nbd: Invalid argument for num-connections (1~"
+                 << RBD_NBD_MAX_CONNECTIONS << ")!";
+        return -EINVAL;
+      }
     } else if (ceph_argparse_witharg(args, i, &cfg->io_timeout, err,
                                      "--timeout", (char *)NULL)) {
       if (!err.str().empty()) {